@@ -1,21 +1,51 @@
 #include "additive_heuristic.h"
 
+#include "globals.h"
 #include "operator.h"
 #include "option_parser.h"
 #include "plugin.h"
 #include "state.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 using namespace std;
 
+struct AddCostCombination {
+    int max_cost;
+    bool overflow;
+
+    explicit AddCostCombination(int max_cost_)
+        : max_cost(max_cost_), overflow(false) {
+    }
+
+    int operator()(int op_cost, int /*base_cost*/, int prop_cost) {
+        assert(op_cost >= 0);
+        assert(prop_cost >= 0);
+        int cost = op_cost + prop_cost;
+        if (cost > max_cost) {
+            overflow = true;
+            cost = max_cost;
+        }
+        return cost;
+    }
+};
+
 // construction and destruction
 AdditiveHeuristic::AdditiveHeuristic(const Options &opts)
     : RelaxationHeuristic(opts),
-      did_write_overflow_warning(false) {
+      queue_type(HEAP_QUEUE),
+      did_write_overflow_warning(false),
+      incremental(opts.get<bool>("incremental")),
+      repairs(0), failed_repairs(0),
+      cache(0) {
+    int cache_size = opts.get<int>("cache_size");
+    if (cache_size > 0)
+        cache = new HeuristicCache(cache_size);
 }
 
 AdditiveHeuristic::~AdditiveHeuristic() {
+    delete cache;
 }
 
 void AdditiveHeuristic::write_overflow_warning() {
@@ -30,100 +60,274 @@ void AdditiveHeuristic::write_overflow_warning() {
     }
 }
 
+Heuristic *AdditiveHeuristic::clone() const {
+    return new AdditiveHeuristic(get_options());
+}
+
 // initialization
 void AdditiveHeuristic::initialize() {
     cout << "Initializing additive heuristic..." << endl;
     RelaxationHeuristic::initialize();
+    queue_type = choose_queue_type(true);
+
+    if (cache) {
+        vector<int> vars;
+        for (int level = 0; level < unary_operators.size(); level++) {
+            get_relevant_variables(level, vars);
+            cache->set_relevant_variables(level, vars);
+        }
+    }
+}
+
+const Operator &AdditiveHeuristic::get_operator(int operator_no) const {
+    if (exploration_level == 1)
+        return g_abstract_operators[operator_no];
+    return g_operators[operator_no];
+}
+
+void AdditiveHeuristic::set_preferred_if_applicable(const Operator *op,
+                                                    const State &state) {
+    if (cache)
+        preferred_candidates.push_back(op);
+    if (op->is_applicable(state))
+        set_preferred(op);
 }
 
 // heuristic computation
-void AdditiveHeuristic::setup_exploration_queue() {
+template<typename Queue>
+void AdditiveHeuristic::explore(Queue &queue, const State &state, int level) {
+    if (!incremental || !repair_exploration(queue, state, level)) {
+        setup_exploration_queue(queue, level);
+        setup_exploration_queue_state(queue, state);
+        AddCostCombination combine(MAX_COST_VALUE);
+        // The incremental mode needs the costs of all propositions.
+        dijkstra_exploration(queue, combine, exploration_level,
+                             exploration_level, !incremental);
+        if (combine.overflow)
+            write_overflow_warning();
+    }
+}
+
+template<typename Queue>
+void AdditiveHeuristic::setup_exploration_queue(Queue &queue, int level) {
     queue.clear();
 
-    for (int var = 0; var < propositions.size(); var++) {
-        for (int value = 0; value < propositions[var].size(); value++) {
-            Proposition &prop = propositions[var][value];
-            prop.cost = -1;
-            prop.marked = false;
+    fill(proposition_cost.begin(), proposition_cost.end(), -1);
+    unmark_all();
+
+    exploration_level = level;
+    const UnaryOperators &ops = *unary_operators[exploration_level];
+    reset_operators(exploration_level);
+
+    // Deal with operators and axioms without preconditions.
+    for (int i = 0; i < ops.without_preconditions.size(); i++) {
+        int op = ops.without_preconditions[i];
+        enqueue_if_necessary(queue, ops.effect[op], ops.base_cost[op], op);
+    }
+}
+
+template<typename Queue>
+void AdditiveHeuristic::setup_exploration_queue_state(Queue &queue,
+                                                      const State &state) {
+    for (int var = 0; var < g_variable_domain.size(); var++)
+        enqueue_if_necessary(queue, get_proposition(var, state[var]), 0,
+                             NO_OPERATOR);
+
+    if (incremental) {
+        explored_state.resize(g_variable_domain.size());
+        for (int var = 0; var < explored_state.size(); var++)
+            explored_state[var] = state[var];
+    }
+}
+
+template<typename Queue>
+bool AdditiveHeuristic::repair_exploration(Queue &queue, const State &state,
+                                           int level) {
+    /*
+      Turns the complete exploration of explored_state into that of
+      the given state, or returns false if a new exploration is
+      cheaper.
+
+      The cost of a proposition can only increase if it was true in
+      explored_state but is not true now, or if it was reached by a
+      unary operator with such a precondition. We forget the costs of
+      all these propositions and give them the cheapest cost they can
+      still get from unary operators whose preconditions all kept
+      their costs. The propositions that hold now get cost 0. From
+      there, we propagate decreases as in a normal exploration, except
+      that unsatisfied preconditions cannot be counted since the costs
+      of the other preconditions are already known.
+    */
+    if (explored_state.empty() || exploration_level != level)
+        return false;
+    const UnaryOperators &ops = *unary_operators[exploration_level];
+
+    affected.resize(num_propositions, false);
+    affected_propositions.clear();
+    for (int var = 0; var < explored_state.size(); var++) {
+        if (state[var] != explored_state[var]) {
+            int prop = get_proposition(var, explored_state[var]);
+            affected[prop] = true;
+            affected_propositions.push_back(prop);
         }
     }
+    for (int i = 0; i < affected_propositions.size(); i++) {
+        int prop = affected_propositions[i];
+        for (int j = ops.triggered_begin[prop];
+             j < ops.triggered_begin[prop + 1]; j++) {
+            int op = ops.triggered[j];
+            int effect = ops.effect[op];
+            if (reached_by[effect] == op && !affected[effect]) {
+                affected[effect] = true;
+                affected_propositions.push_back(effect);
+            }
+        }
+        if (affected_propositions.size() > num_propositions / 4) {
+            // Too many changes; a new exploration is faster.
+            for (int j = 0; j < affected_propositions.size(); j++)
+                affected[affected_propositions[j]] = false;
+            ++failed_repairs;
+            if (failed_repairs == 1000 && repairs < 100) {
+                // In some domains (e.g. Blocksworld, where everything
+                // depends on the hand being empty), nearly all
+                // changes spread too far. Then the complete
+                // explorations only cost time.
+                cout << "Incremental h^add computation does not pay off "
+                     << "for this task; switching it off." << endl;
+                incremental = false;
+            }
+            return false;
+        }
+    }
+    ++repairs;
 
-    // Deal with operators and axioms without preconditions.
-	for (int i = 0; i < unary_operators[operator_level].size(); i++) { //MMM
-		UnaryOperator &op = unary_operators[operator_level][i];
-		op.unsatisfied_preconditions = op.precondition.size();
-		op.cost = op.base_cost; // will be increased by precondition costs
-		
-		if (op.unsatisfied_preconditions == 0) 
-			enqueue_if_necessary(op.effect, op.base_cost, &op);
-	}
+    queue.clear();
+    unmark_all();
+
+    for (int i = 0; i < affected_propositions.size(); i++) {
+        int prop = affected_propositions[i];
+        affected[prop] = false;
+        proposition_cost[prop] = -1;
+        reached_by[prop] = NO_OPERATOR;
+    }
+    for (int i = 0; i < affected_propositions.size(); i++) {
+        int prop = affected_propositions[i];
+        for (int j = ops.achievers_begin[prop];
+             j < ops.achievers_begin[prop + 1]; j++) {
+            int op = ops.achievers[j];
+            bool cheaper_preconditions;
+            if (compute_operator_cost(op, cheaper_preconditions))
+                enqueue_if_necessary(queue, prop,
+                                     operator_cost[exploration_level][op], op,
+                                     cheaper_preconditions);
+        }
+    }
+    for (int var = 0; var < explored_state.size(); var++) {
+        if (state[var] != explored_state[var]) {
+            enqueue_if_necessary(queue, get_proposition(var, state[var]), 0,
+                                 NO_OPERATOR);
+            explored_state[var] = state[var];
+        }
+    }
+
+    incremental_exploration(queue);
+    return true;
 }
 
-void AdditiveHeuristic::setup_exploration_queue_state(const State &state) {  
-	for (int var = 0; var < propositions.size(); var++) {
-        Proposition *init_prop = &propositions[var][state[var]];
-        enqueue_if_necessary(init_prop, 0, 0);
+bool AdditiveHeuristic::compute_operator_cost(int op,
+                                              bool &cheaper_preconditions) {
+    // Returns false if some precondition has not been reached.
+    const UnaryOperators &ops = *unary_operators[exploration_level];
+    int cost = ops.base_cost[op];
+    int max_pre_cost = -1;
+    for (int i = ops.precondition_begin[op];
+         i < ops.precondition_begin[op + 1]; i++) {
+        int pre_cost = proposition_cost[ops.preconditions[i]];
+        if (pre_cost == -1)
+            return false;
+        increase_cost(cost, pre_cost);
+        max_pre_cost = max(max_pre_cost, pre_cost);
     }
+    operator_cost[exploration_level][op] = cost;
+    cheaper_preconditions = max_pre_cost < cost;
+    return true;
 }
 
-void AdditiveHeuristic::relaxed_exploration() {
-    int unsolved_goals = goal_propositions.size();
+template<typename Queue>
+void AdditiveHeuristic::incremental_exploration(Queue &queue) {
+    const UnaryOperators &ops = *unary_operators[exploration_level];
+    const vector<int> &op_cost = operator_cost[exploration_level];
     while (!queue.empty()) {
-        pair<int, Proposition *> top_pair = queue.pop();
+        pair<int, int> top_pair = queue.pop();
         int distance = top_pair.first;
-        Proposition *prop = top_pair.second;
-        int prop_cost = prop->cost;
+        int prop = top_pair.second;
+        int prop_cost = proposition_cost[prop];
         assert(prop_cost >= 0);
         assert(prop_cost <= distance);
         if (prop_cost < distance)
             continue;
-        if (prop->is_goal && --unsolved_goals == 0)
-            return;
-        const vector<UnaryOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (int i = 0; i < triggered_operators.size(); i++) {
-            UnaryOperator *unary_op = triggered_operators[i];
-            increase_cost(unary_op->cost, prop_cost);
-            unary_op->unsatisfied_preconditions--;
-            assert(unary_op->unsatisfied_preconditions >= 0);
-            if (unary_op->unsatisfied_preconditions == 0)
-                enqueue_if_necessary(unary_op->effect,
-                                     unary_op->cost, unary_op);
+        for (int i = ops.triggered_begin[prop];
+             i < ops.triggered_begin[prop + 1]; i++) {
+            int op = ops.triggered[i];
+            bool cheaper_preconditions;
+            if (compute_operator_cost(op, cheaper_preconditions))
+                enqueue_if_necessary(queue, ops.effect[op], op_cost[op], op,
+                                     cheaper_preconditions);
         }
     }
 }
 
-void AdditiveHeuristic::mark_preferred_operators(
-    const State &state, Proposition *goal) {
-    if (!goal->marked) { // Only consider each subgoal once.
-        goal->marked = true;
-        UnaryOperator *unary_op = goal->reached_by;
-        if (unary_op) { // We have not yet chained back to a start node.
-            for (int i = 0; i < unary_op->precondition.size(); i++)
-                mark_preferred_operators(state, unary_op->precondition[i]);
-            int operator_no = unary_op->operator_no;
-            if (unary_op->cost == unary_op->base_cost && operator_no != -1) {
-                // Necessary condition for this being a preferred
-                // operator, which we use as a quick test before the
-                // more expensive applicability test.
-                // If we had no 0-cost operators and axioms to worry
-                // about, this would also be a sufficient condition.
-                const Operator *op = &g_operators[operator_no];
-                if (op->is_applicable(state))
-                    set_preferred(op);
+void AdditiveHeuristic::push_plan_stack(int prop) {
+    int op = reached_by[prop];
+    int next = 0;
+    if (op != NO_OPERATOR)
+        next = unary_operators[exploration_level]->precondition_begin[op];
+    plan_stack.push_back(make_pair(prop, next));
+}
+
+void AdditiveHeuristic::collect_relaxed_plan(int goal, vector<int> &result) {
+    if (is_marked(goal)) // Only consider each subgoal once.
+        return;
+    mark(goal);
+    const UnaryOperators &ops = *unary_operators[exploration_level];
+    assert(plan_stack.empty());
+    push_plan_stack(goal);
+    while (!plan_stack.empty()) {
+        int prop = plan_stack.back().first;
+        int op = reached_by[prop];
+        if (op == NO_OPERATOR) {
+            // We have chained back to a start node.
+            plan_stack.pop_back();
+        } else if (plan_stack.back().second < ops.precondition_begin[op + 1]) {
+            int pre = ops.preconditions[plan_stack.back().second++];
+            if (!is_marked(pre)) {
+                mark(pre);
+                push_plan_stack(pre);
             }
+        } else {
+            // All preconditions are done.
+            plan_stack.pop_back();
+            result.push_back(op);
         }
     }
 }
 
-int AdditiveHeuristic::compute_add_and_ff(const State &state) {
-    setup_exploration_queue();
-    setup_exploration_queue_state(state);
-    relaxed_exploration();
+const vector<int> &AdditiveHeuristic::collect_relaxed_plan() {
+    plan_operators.clear();
+    for (int i = 0; i < goal_propositions.size(); i++)
+        collect_relaxed_plan(goal_propositions[i], plan_operators);
+    return plan_operators;
+}
+
+int AdditiveHeuristic::compute_add_and_ff(const State &state, int level) {
+    if (queue_type == HEAP_QUEUE)
+        explore(heap_queue, state, level);
+    else
+        explore(bucket_queue, state, level);
 
     int total_cost = 0;
     for (int i = 0; i < goal_propositions.size(); i++) {
-        int prop_cost = goal_propositions[i]->cost;
+        int prop_cost = proposition_cost[goal_propositions[i]];
         if (prop_cost == -1)
             return DEAD_END;
         increase_cost(total_cost, prop_cost);
@@ -131,17 +335,94 @@ int AdditiveHeuristic::compute_add_and_ff(const State &state) {
     return total_cost;
 }
 
+int AdditiveHeuristic::compute_heuristic_value(const State &state, int level,
+                                               bool mark_preferred) {
+    int h = compute_add_and_ff(state, level);
+    if (h != DEAD_END && mark_preferred) {
+        const UnaryOperators &ops = *unary_operators[exploration_level];
+        const vector<int> &plan = collect_relaxed_plan();
+        for (int i = 0; i < plan.size(); i++) {
+            int op = plan[i];
+            int operator_no = ops.operator_no[op];
+            if (operator_cost[exploration_level][op] == ops.base_cost[op] &&
+                operator_no != -1) {
+                // Necessary condition for this being a preferred
+                // operator, which we use as a quick test before the
+                // more expensive applicability test.
+                // If we had no 0-cost operators and axioms to worry
+                // about, this would also be a sufficient condition.
+                set_preferred_if_applicable(&get_operator(operator_no), state);
+            }
+        }
+    }
+    return h;
+}
+
 int AdditiveHeuristic::compute_heuristic(const State &state) {
-    int h = compute_add_and_ff(state);
-    if (h != DEAD_END) {
-        for (int i = 0; i < goal_propositions.size(); i++)
-            mark_preferred_operators(state, goal_propositions[i]);
+    int level = get_context().get_operator_level();
+    if (!cache)
+        return compute_heuristic_value(state, level, true);
+
+    const HeuristicCache::Entry *cached = cache->lookup(level, state, true);
+    if (cached) {
+        // The entry may come from a state in which other operators are
+        // applicable.
+        for (int i = 0; i < cached->preferred_operators.size(); i++) {
+            const Operator *op = cached->preferred_operators[i];
+            if (op->is_applicable(state))
+                set_preferred(op);
+        }
+        return cached->value;
     }
+    preferred_candidates.clear();
+    int h = compute_heuristic_value(state, level, true);
+    HeuristicCache::Entry &entry = cache->store(level, state);
+    entry.value = h;
+    entry.has_preferred_operators = true;
+    entry.preferred_operators = preferred_candidates;
     return h;
 }
 
-static ScalarEvaluator *_parse(OptionParser &parser) {
+void AdditiveHeuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &contexts,
+    vector<int> &values) {
+    for (int i = 0; i < states.size(); i++) {
+        const State &state = states[i];
+        int level = contexts[i].get_operator_level();
+        const HeuristicCache::Entry *cached = 0;
+        if (cache)
+            cached = cache->lookup(level, state, false);
+        if (cached) {
+            values[i] = cached->value;
+        } else {
+            values[i] = compute_heuristic_value(state, level, false);
+            if (cache)
+                cache->store(level, state).value = values[i];
+        }
+    }
+}
+
+void AdditiveHeuristic::print_statistics() const {
+    if (cache)
+        cache->print_statistics();
+}
+
+void AdditiveHeuristic::add_options_to_parser(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
+    parser.add_option<bool>(
+        "incremental", false,
+        "compute the costs of each state by repairing those of the "
+        "previously evaluated state (same values and relaxed plans, except "
+        "where operators of cost 0, such as axioms, reach a fact equally "
+        "cheaply; then preferred operators may differ)");
+    parser.add_option<int>(
+        "cache_size", 0,
+        "maximum number of heuristic values to cache, keyed by the operator "
+        "level and the variables relevant on that level (0: no caching)");
+}
+
+static ScalarEvaluator *_parse(OptionParser &parser) {
+    AdditiveHeuristic::add_options_to_parser(parser);
     Options opts = parser.parse();
     if (parser.dry_run())
         return 0;
@@ -1,10 +1,13 @@
 #ifndef ADDITIVE_HEURISTIC_H
 #define ADDITIVE_HEURISTIC_H
 
+#include "heuristic_cache.h"
 #include "priority_queue.h"
 #include "relaxation_heuristic.h"
 #include <cassert>
 
+class OptionParser;
+
 class AdditiveHeuristic : public RelaxationHeuristic {
     /* Costs larger than MAX_COST_VALUE are clamped to max_value. The
        precise value (100M) is a bit of a hack, since other parts of
@@ -15,23 +18,49 @@ class AdditiveHeuristic : public RelaxationHeuristic {
      */
     static const int MAX_COST_VALUE = 100000000;
 
-    AdaptiveQueue<Proposition *> queue;
+    // Only the queue of queue_type is used.
+    QueueType queue_type;
+    CappedBucketQueue<int> bucket_queue;
+    HeapQueue<int> heap_queue;
     bool did_write_overflow_warning;
 
-    void setup_exploration_queue();
-    void setup_exploration_queue_state(const State &state);
-    void relaxed_exploration();
-    void mark_preferred_operators(const State &state, Proposition *goal);
-
-    void enqueue_if_necessary(Proposition *prop, int cost, UnaryOperator *op) {
-		assert(cost >= 0);
-        if (prop->cost == -1 || prop->cost > cost) {
-            prop->cost = cost;
-            prop->reached_by = op;
-            queue.push(cost, prop);
-        }
-        assert(prop->cost != -1 && prop->cost <= cost);
-    }
+    /*
+      In incremental mode, every exploration is run to completion, and
+      the next evaluation only repairs the costs that differ for its
+      state instead of starting from scratch. explored_state holds the
+      state of the last exploration (empty if there is none).
+    */
+    bool incremental;
+    std::vector<int> explored_state;
+    std::vector<int> affected_propositions;
+    std::vector<char> affected;
+    int repairs;
+    int failed_repairs;
+
+    HeuristicCache *cache; // 0 if caching is switched off
+    // The candidates for preferred operators of the current evaluation
+    // (see set_preferred_if_applicable), collected for the cache.
+    std::vector<const Operator *> preferred_candidates;
+
+    // Scratch space for collect_relaxed_plan: propositions whose
+    // achievers are being collected, each with the position of the
+    // next precondition to visit.
+    std::vector<std::pair<int, int> > plan_stack;
+    // Scratch space for the unary operators of a relaxed plan.
+    std::vector<int> plan_operators;
+
+    template<typename Queue>
+    void explore(Queue &queue, const State &state, int level);
+    template<typename Queue>
+    void setup_exploration_queue(Queue &queue, int level);
+    template<typename Queue>
+    void setup_exploration_queue_state(Queue &queue, const State &state);
+    template<typename Queue>
+    bool repair_exploration(Queue &queue, const State &state, int level);
+    bool compute_operator_cost(int op, bool &cheaper_preconditions);
+    template<typename Queue>
+    void incremental_exploration(Queue &queue);
+    void push_plan_stack(int prop);
 
     void increase_cost(int &cost, int amount) {
         assert(cost >= 0);
@@ -45,14 +74,48 @@ class AdditiveHeuristic : public RelaxationHeuristic {
 
     void write_overflow_warning();
 protected:
+    // The operator level of the last exploration. The reached_by
+    // entries refer to its unary operators.
+    int exploration_level;
+
+    const Operator &get_operator(int operator_no) const;
+    // Sets op as preferred if it is applicable in state. Use this
+    // instead of set_preferred in compute_heuristic_value, so that the
+    // preferred operators of cached values are tested against the state
+    // they are looked up for.
+    void set_preferred_if_applicable(const Operator *op, const State &state);
+
     virtual void initialize();
     virtual int compute_heuristic(const State &state);
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
+    // Computes the heuristic value of a state that is not cached, over
+    // the unary operators of the given operator level. Derived classes
+    // change the value computed from the exploration.
+    virtual int compute_heuristic_value(const State &state, int level,
+                                        bool mark_preferred);
 
     // Common part of h^add and h^ff computation.
-    int compute_add_and_ff(const State &state);
+    int compute_add_and_ff(const State &state, int level);
+    // Appends to result the unary operators that reach goal or (via
+    // reached_by) one of its preconditions, skipping marked
+    // propositions and marking the others. The achiever of each
+    // proposition comes after those of its preconditions. The result
+    // is ordered like a recursive depth-first traversal, but no
+    // recursion is used.
+    void collect_relaxed_plan(int goal, std::vector<int> &result);
+    // The unary operators of the relaxed plan for all goals, collected
+    // into plan_operators.
+    const std::vector<int> &collect_relaxed_plan();
 public:
     AdditiveHeuristic(const Options &options);
     ~AdditiveHeuristic();
+    virtual Heuristic *clone() const;
+    virtual void print_statistics() const;
+
+    static void add_options_to_parser(OptionParser &parser);
 };
 
 #endif
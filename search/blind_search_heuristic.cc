@@ -25,6 +25,10 @@ void BlindSearchHeuristic::initialize() {
     cout << "Initializing blind search heuristic..." << endl;
 }
 
+Heuristic *BlindSearchHeuristic::clone() const {
+    return new BlindSearchHeuristic(get_options());
+}
+
 int BlindSearchHeuristic::compute_heuristic(const State &state) {
     if (test_goal(state))
         return 0;
@@ -3,11 +3,14 @@
 #include "globals.h"
 #include "heuristic.h"
 #include "option_parser.h"
+#include "state_registry.h"
 #include "successor_generator.h"
 #include "g_evaluator.h"
 #include "sum_evaluator.h"
 #include "plugin.h"
+#include "thread_pool.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <set>
@@ -19,14 +22,24 @@ EagerSearch::EagerSearch(
       reopen_closed_nodes(opts.get<bool>("reopen_closed")),
       do_pathmax(opts.get<bool>("pathmax")),
       use_multi_path_dependence(opts.get<bool>("mpd")),
-      open_list(opts.get<OpenList<state_var_t *> *>("open")),
-      f_evaluator(opts.get<ScalarEvaluator *>("f_eval")) {
+      open_list(opts.get<OpenList<StateID> *>("open")),
+      f_evaluator(opts.get<ScalarEvaluator *>("f_eval")),
+      expansion_number(0),
+      num_threads(opts.get<int>("threads")),
+      thread_pool(0) {
     if (opts.contains("preferred")) {
         preferred_operator_heuristics =
             opts.get_list<Heuristic *>("preferred");
     }
 }
 
+EagerSearch::~EagerSearch() {
+    delete thread_pool;
+    for (size_t t = 0; t < heuristic_clones.size(); ++t)
+        for (size_t i = 0; i < heuristic_clones[t].size(); ++i)
+            delete heuristic_clones[t][i];
+}
+
 void EagerSearch::initialize() {
     //TODO children classes should output which kind of search
     cout << "Conducting best first search"
@@ -71,6 +84,30 @@ void EagerSearch::initialize() {
     search_progress.inc_evaluated_states();
     search_progress.inc_evaluations(heuristics.size());
 
+    if (num_threads > 1) {
+        cout << "Evaluating successors with " << num_threads << " threads"
+             << endl;
+        thread_pool = new ThreadPool(num_threads);
+        heuristic_clones.resize(num_threads - 1);
+        for (int t = 1; t < num_threads; ++t) {
+            for (size_t i = 0; i < heuristics.size(); ++i) {
+                Heuristic *clone = heuristics[i]->clone();
+                // Initialize the clone here rather than in its thread.
+                if (clone)
+                    clone->evaluate(*g_initial_state);
+                heuristic_clones[t - 1].push_back(clone);
+            }
+        }
+        for (size_t i = 0; i < heuristics.size(); ++i) {
+            if (!heuristic_clones[0][i])
+                cout << "Warning: heuristic " << i << " cannot be cloned "
+                     << "and is evaluated in the main thread only" << endl;
+        }
+    }
+    batch_states.resize(num_threads);
+    batch_contexts.resize(num_threads);
+    batch_values.resize(num_threads, vector<vector<int> >(heuristics.size()));
+
     if (open_list->is_dead_end()) {
         cout << "Initial state is a dead end." << endl;
     } else {
@@ -83,7 +120,7 @@ void EagerSearch::initialize() {
         SearchNode node = search_space.get_node(*g_initial_state);
         node.open_initial(heuristics[0]->get_value());
 
-        open_list->insert(node.get_state_buffer());
+        open_list->insert(node.get_state_id());
     }
 }
 
@@ -93,6 +130,18 @@ void EagerSearch::statistics() const {
     search_space.statistics();
 }
 
+void EagerSearch::heuristic_statistics() const {
+    for (size_t i = 0; i < heuristics.size(); ++i)
+        heuristics[i]->print_statistics();
+    // The clones used by the other threads keep their own statistics.
+    for (size_t t = 0; t < heuristic_clones.size(); ++t) {
+        for (size_t i = 0; i < heuristic_clones[t].size(); ++i) {
+            if (heuristic_clones[t][i])
+                heuristic_clones[t][i]->print_statistics();
+        }
+    }
+}
+
 int EagerSearch::step() {
     pair<SearchNode, bool> n = fetch_next_node();
     if (!n.second) {
@@ -104,36 +153,54 @@ int EagerSearch::step() {
     if (check_goal_and_set_plan(s))
         return SOLVED;
 
-    vector<const Operator *> applicable_ops;
-    set<const Operator *> preferred_ops;
-  
-    //g_successor_generator->generate_applicable_ops(s, applicable_ops);
-    g_successor_generators[0]->generate_applicable_ops(s, applicable_ops); //Modification MMM
+    applicable_ops.clear();
+    preferred_op_marks.clear();
+
+    EvaluationContext context = EvaluationContext::for_g(node.get_g());
+    context.get_successor_generator()->generate_applicable_ops(
+        s, applicable_ops);
     // This evaluates the expanded state (again) to get preferred ops
     for (int i = 0; i < preferred_operator_heuristics.size(); i++) {
         Heuristic *h = preferred_operator_heuristics[i];
-        h->evaluate(s);
+        h->evaluate(s, context);
         if (!h->is_dead_end()) {
             // In an alternation search with unreliable heuristics, it is
             // possible that this heuristic considers the state a dead end.
-            vector<const Operator *> preferred;
-            h->get_preferred_operators(preferred);
-            preferred_ops.insert(preferred.begin(), preferred.end());
+            preferred_ops.clear();
+            h->get_preferred_operators(preferred_ops);
+            for (int j = 0; j < preferred_ops.size(); j++)
+                preferred_op_marks.insert(preferred_ops[j]);
         }
     }
     search_progress.inc_evaluations(preferred_operator_heuristics.size());
 
 	 //cout << "applicable ops: " << applicable_ops.size() << endl;
 
+    /*
+      We first generate all successors and only then evaluate the new
+      ones, in one batch per heuristic (see Heuristic::evaluate_batch),
+      which is faster than interleaving evaluations with hash lookups
+      and open list operations. The results are then processed in
+      generation order, exactly as if each successor had been
+      evaluated when it was generated.
+    */
+    successor_ids.clear();
+    successor_ops.clear();
+    successor_batch_indices.clear();
+    for (int t = 0; t < num_threads; ++t) {
+        batch_states[t].clear();
+        batch_contexts[t].clear();
+    }
+    batch_ids.clear();
+    ++expansion_number;
     for (int i = 0; i < applicable_ops.size(); i++) {
         const Operator *op = applicable_ops[i];
 
         if ((node.get_real_g() + op->get_cost()) >= bound)
             continue;
 
-        State succ_state(s, *op);
+        State succ_state = g_state_registry->get_successor_state(s, *op);
         search_progress.inc_generated();
-        bool is_preferred = (preferred_ops.find(op) != preferred_ops.end());
 
         SearchNode succ_node = search_space.get_node(succ_state);
 
@@ -141,8 +208,16 @@ int EagerSearch::step() {
         if (succ_node.is_dead_end())
             continue;
 
+        /*
+          A new state that another operator already reached in this
+          expansion will have been opened by the time we process it, so
+          it is not new for the purposes of this successor.
+        */
+        bool is_new = succ_node.is_new() &&
+                      batch_expansion[succ_state.get_id()] != expansion_number;
+
         // update new path
-        if (use_multi_path_dependence || succ_node.is_new()) {
+        if (use_multi_path_dependence || is_new) {
             bool h_is_dirty = false;
             for (size_t i = 0; i < heuristics.size(); ++i) {
                 /*
@@ -151,18 +226,48 @@ int EagerSearch::step() {
                   evaluation here. We must call reach_state for each
                   heuristic for its side effects.
                 */
-                if (heuristics[i]->reach_state(s, *op, succ_node.get_state()))
+                if (heuristics[i]->reach_state(s, *op, succ_state))
                     h_is_dirty = true;
             }
             if (h_is_dirty && use_multi_path_dependence)
                 succ_node.set_h_dirty();
         }
 
+        successor_ids.push_back(succ_state.get_id());
+        successor_ops.push_back(op);
+        if (is_new) {
+            int batch_index = batch_ids.size();
+            successor_batch_indices.push_back(batch_index);
+            int thread = batch_index % num_threads;
+            batch_states[thread].push_back(succ_state);
+            batch_contexts[thread].push_back(EvaluationContext::for_g(
+                node.get_g() + get_adjusted_cost(*op)));
+            batch_ids.push_back(succ_state.get_id());
+            batch_expansion[succ_state.get_id()] = expansion_number;
+        } else {
+            successor_batch_indices.push_back(-1);
+        }
+    }
+
+    if (!batch_ids.empty())
+        evaluate_batch();
+
+    for (int i = 0; i < successor_ids.size(); i++) {
+        const Operator *op = successor_ops[i];
+        bool is_preferred = preferred_op_marks.contains(op);
+        SearchNode succ_node = search_space.get_node(successor_ids[i]);
+
+        // Reached twice in this expansion and found to be a dead end.
+        if (succ_node.is_dead_end())
+            continue;
+
         if (succ_node.is_new()) {
             // We have not seen this state before.
-            // Evaluate and create a new node.
-            for (size_t i = 0; i < heuristics.size(); i++)
-                heuristics[i]->evaluate(succ_state);
+            // Retrieve its evaluation and create a new node.
+            int batch_index = successor_batch_indices[i];
+            assert(batch_index != -1);
+            for (size_t j = 0; j < heuristics.size(); j++)
+                heuristics[j]->select_batch_result(batch_index);
             succ_node.clear_h_dirty();
             search_progress.inc_evaluated_states();
             search_progress.inc_evaluations(heuristics.size());
@@ -180,7 +285,6 @@ int EagerSearch::step() {
                 continue;
             }
 
-            //TODO:CR - add an ID to each state, and then we can use a vector to save per-state information
             int succ_h = heuristics[0]->get_heuristic();
             if (do_pathmax) {
                 if ((node.get_h() - get_adjusted_cost(*op)) > succ_h) {
@@ -193,7 +297,7 @@ int EagerSearch::step() {
             }
             succ_node.open(succ_h, node, op);
 
-            open_list->insert(succ_node.get_state_buffer());
+            open_list->insert(succ_node.get_state_id());
             if (search_progress.check_h_progress(succ_node.get_g())) {
                 reward_progress();
             }
@@ -218,7 +322,7 @@ int EagerSearch::step() {
                 // involved? Is this still feasible in the current version?
                 open_list->evaluate(succ_node.get_g(), is_preferred);
 
-                open_list->insert(succ_node.get_state_buffer());
+                open_list->insert(succ_node.get_state_id());
             } else {
                 // if we do not reopen closed nodes, we just update the parent pointers
                 // Note that this could cause an incompatibility between
@@ -231,6 +335,69 @@ int EagerSearch::step() {
     return IN_PROGRESS;
 }
 
+class EagerSearch::EvaluationJob : public ThreadPool::Job {
+    EagerSearch &search;
+public:
+    explicit EvaluationJob(EagerSearch &search_)
+        : search(search_) {
+    }
+
+    virtual void run(int thread_index) {
+        search.evaluate_batch_part(thread_index);
+    }
+};
+
+void EagerSearch::evaluate_batch() {
+    if (num_threads == 1 || batch_ids.size() == 1) {
+        // Everything is in batch_states[0].
+        for (size_t i = 0; i < heuristics.size(); i++)
+            heuristics[i]->evaluate_batch(batch_states[0],
+                                          batch_contexts[0]);
+        return;
+    }
+
+    EvaluationJob job(*this);
+    thread_pool->run(job);
+
+    /*
+      Heuristics that cannot be cloned are evaluated in this thread
+      once the others are done, because they may share data with the
+      clones. Then we merge the results of all threads back into
+      generation order. Which thread evaluates which state only depends
+      on the generation order, so the search is deterministic for a
+      given number of threads. It is the same for every number of
+      threads if the heuristic values do not depend on the order of
+      evaluations. (This does not hold for heuristics that reuse
+      information from earlier evaluations in a way that changes their
+      values, e.g. lmcut with cut_cache_size > 0.)
+    */
+    for (size_t i = 0; i < heuristics.size(); ++i) {
+        if (!heuristic_clones[0][i]) {
+            for (int t = 0; t < num_threads; ++t)
+                heuristics[i]->evaluate_batch(batch_states[t],
+                                              batch_contexts[t],
+                                              batch_values[t][i]);
+        }
+        merged_batch_values.resize(batch_ids.size());
+        for (size_t j = 0; j < batch_ids.size(); ++j)
+            merged_batch_values[j] =
+                batch_values[j % num_threads][i][j / num_threads];
+        heuristics[i]->set_batch_results(merged_batch_values);
+    }
+}
+
+void EagerSearch::evaluate_batch_part(int thread_index) {
+    for (size_t i = 0; i < heuristics.size(); ++i) {
+        if (heuristic_clones[0][i]) {
+            Heuristic *h = thread_index == 0 ?
+                           heuristics[i] : heuristic_clones[thread_index - 1][i];
+            h->evaluate_batch(batch_states[thread_index],
+                              batch_contexts[thread_index],
+                              batch_values[thread_index][i]);
+        }
+    }
+}
+
 pair<SearchNode, bool> EagerSearch::fetch_next_node() {
     /* TODO: The bulk of this code deals with multi-path dependence,
        which is a bit unfortunate since that is a special case that
@@ -246,9 +413,9 @@ pair<SearchNode, bool> EagerSearch::fetch_next_node() {
             return make_pair(search_space.get_node(*g_initial_state), false);
         }
         vector<int> last_key_removed;
-        State state(open_list->remove_min(
-                        use_multi_path_dependence ? &last_key_removed : 0));
-        SearchNode node = search_space.get_node(state);
+        StateID id = open_list->remove_min(
+            use_multi_path_dependence ? &last_key_removed : 0);
+        SearchNode node = search_space.get_node(id);
 
         if (node.is_closed())
             continue;
@@ -263,8 +430,11 @@ pair<SearchNode, bool> EagerSearch::fetch_next_node() {
             }
             assert(node.get_h() == pushed_h);
             if (!node.is_closed() && node.is_h_dirty()) {
+                State state = node.get_state();
+                EvaluationContext context =
+                    EvaluationContext::for_g(node.get_g());
                 for (size_t i = 0; i < heuristics.size(); i++)
-                    heuristics[i]->evaluate(node.get_state());
+                    heuristics[i]->evaluate(state, context);
                 node.clear_h_dirty();
                 search_progress.inc_evaluations(heuristics.size());
 
@@ -279,7 +449,7 @@ pair<SearchNode, bool> EagerSearch::fetch_next_node() {
                 if (new_h > node.get_h()) {
                     assert(node.is_open());
                     node.increase_h(new_h);
-                    open_list->insert(node.get_state_buffer());
+                    open_list->insert(node.get_state_id());
                     continue;
                 }
             }
@@ -320,13 +490,20 @@ void EagerSearch::print_heuristic_values(const vector<int> &values) const {
     }
 }
 
+static OpenList<StateID> *create_scalar_open_list(
+    ScalarEvaluator *eval, bool preferred_only, bool bucket_array) {
+    if (bucket_array)
+        return new BucketArrayOpenList<StateID>(eval, preferred_only);
+    return new StandardScalarOpenList<StateID>(eval, preferred_only);
+}
+
 static SearchEngine *_parse(OptionParser &parser) {
     //open lists are currently registered with the parser on demand,
     //because for templated classes the usual method of registering
     //does not work:
-    Plugin<OpenList<state_var_t *> >::register_open_lists();
+    Plugin<OpenList<StateID> >::register_open_lists();
 
-    parser.add_option<OpenList<state_var_t *> *>("open");
+    parser.add_option<OpenList<StateID> *>("open");
     parser.add_option<bool>("reopen_closed", false,
                             "reopen closed nodes");
     parser.add_option<bool>("pathmax", false,
@@ -336,8 +513,13 @@ static SearchEngine *_parse(OptionParser &parser) {
     parser.add_list_option<Heuristic *>
         ("preferred", vector<Heuristic *>(),
         "use preferred operators of these heuristics");
+    parser.add_option<int>("threads", 1,
+                           "number of threads for evaluating successor states "
+                           "(only pays off for expensive heuristics)");
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
+    if (!parser.dry_run() && opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
 
     EagerSearch *engine = 0;
     if (!parser.dry_run()) {
@@ -354,8 +536,13 @@ static SearchEngine *_parse_astar(OptionParser &parser) {
                             "use pathmax correction");
     parser.add_option<bool>("mpd", false,
                             "use multi-path dependence (LM-A*)");
+    parser.add_option<int>("threads", 1,
+                           "number of threads for evaluating successor states "
+                           "(only pays off for expensive heuristics)");
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
+    if (!parser.dry_run() && opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
 
     EagerSearch *engine = 0;
     if (!parser.dry_run()) {
@@ -370,8 +557,8 @@ static SearchEngine *_parse_astar(OptionParser &parser) {
         std::vector<ScalarEvaluator *> evals;
         evals.push_back(f_eval);
         evals.push_back(eval);
-        OpenList<state_var_t *> *open = \
-            new TieBreakingOpenList<state_var_t *>(evals, false, false);
+        OpenList<StateID> *open = \
+            new TieBreakingOpenList<StateID>(evals, false, false);
 
         opts.set("open", open);
         opts.set("f_eval", f_eval);
@@ -386,11 +573,18 @@ static SearchEngine *_parse_greedy(OptionParser &parser) {
     parser.add_list_option<ScalarEvaluator *>("evals");
     parser.add_list_option<Heuristic *>("preferred", vector<Heuristic *>(), "use preferred operators of these heuristics");
     parser.add_option<int>("boost", 0, "boost value for preferred operator open lists");
+    parser.add_option<bool>("bucket_array", false,
+                            "use bucket array open lists (see single_bucket_array)");
+    parser.add_option<int>("threads", 1,
+                           "number of threads for evaluating successor states "
+                           "(only pays off for expensive heuristics)");
     SearchEngine::add_options_to_parser(parser);
 
 
     Options opts = parser.parse();
     opts.verify_list_non_empty<ScalarEvaluator *>("evals");
+    if (!parser.dry_run() && opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
 
     EagerSearch *engine = 0;
     if (!parser.dry_run()) {
@@ -398,21 +592,21 @@ static SearchEngine *_parse_greedy(OptionParser &parser) {
             opts.get_list<ScalarEvaluator *>("evals");
         vector<Heuristic *> preferred_list =
             opts.get_list<Heuristic *>("preferred");
-        OpenList<state_var_t *> *open;
+        bool bucket_array = opts.get<bool>("bucket_array");
+        OpenList<StateID> *open;
         if ((evals.size() == 1) && preferred_list.empty()) {
-            open = new StandardScalarOpenList<state_var_t *>(evals[0], false);
+            open = create_scalar_open_list(evals[0], false, bucket_array);
         } else {
-            vector<OpenList<state_var_t *> *> inner_lists;
+            vector<OpenList<StateID> *> inner_lists;
             for (int i = 0; i < evals.size(); i++) {
                 inner_lists.push_back(
-                    new StandardScalarOpenList<state_var_t *>(evals[i], false));
+                    create_scalar_open_list(evals[i], false, bucket_array));
                 if (!preferred_list.empty()) {
                     inner_lists.push_back(
-                        new StandardScalarOpenList<state_var_t *>(evals[i],
-                                                                  true));
+                        create_scalar_open_list(evals[i], true, bucket_array));
                 }
             }
-            open = new AlternationOpenList<state_var_t *>(
+            open = new AlternationOpenList<StateID>(
                 inner_lists, opts.get<int>("boost"));
         }
 
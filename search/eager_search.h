@@ -3,7 +3,10 @@
 
 #include <vector>
 
+#include "evaluation_context.h"
+#include "marked_operators.h"
 #include "open_lists/open_list.h"
+#include "per_state_information.h"
 #include "search_engine.h"
 #include "search_space.h"
 #include "state.h"
@@ -15,6 +18,7 @@ class Heuristic;
 class Operator;
 class ScalarEvaluator;
 class Options;
+class ThreadPool;
 
 class EagerSearch : public SearchEngine {
     // Search Behavior parameters
@@ -22,9 +26,44 @@ class EagerSearch : public SearchEngine {
     bool do_pathmax; // whether to use pathmax correction
     bool use_multi_path_dependence;
 
-    OpenList<state_var_t *> *open_list;
+    OpenList<StateID> *open_list;
     ScalarEvaluator *f_evaluator;
 
+    // Scratch space for step(), reused across expansions.
+    vector<const Operator *> applicable_ops;
+    vector<const Operator *> preferred_ops;
+    MarkedOperators preferred_op_marks;
+    // Successors of the current expansion, and the new ones among them
+    // that are evaluated in one batch. The batch is dealt out to the
+    // threads round-robin: the i-th new successor is evaluated by
+    // thread i % num_threads.
+    vector<StateID> successor_ids;
+    vector<const Operator *> successor_ops;
+    vector<int> successor_batch_indices;
+    vector<vector<State> > batch_states;
+    vector<vector<EvaluationContext> > batch_contexts;
+    vector<StateID> batch_ids;
+    // The number of the expansion in which a state was last added to
+    // the batch, to detect successors reached twice in one expansion.
+    int expansion_number;
+    PerStateInformation<int> batch_expansion;
+
+    // Parallel successor evaluation.
+    int num_threads;
+    ThreadPool *thread_pool;
+    // heuristic_clones[t - 1][i] evaluates heuristics[i] in thread t,
+    // or is 0 if heuristics[i] cannot be cloned.
+    vector<vector<Heuristic *> > heuristic_clones;
+    // batch_values[t][i] holds the values of heuristics[i] for
+    // batch_states[t].
+    vector<vector<vector<int> > > batch_values;
+    vector<int> merged_batch_values;
+
+    class EvaluationJob;
+    friend class EvaluationJob;
+    void evaluate_batch();
+    void evaluate_batch_part(int thread_index);
+
 protected:
     int step();
     pair<SearchNode, bool> fetch_next_node();
@@ -43,7 +82,9 @@ protected:
 
 public:
     EagerSearch(const Options &opts);
+    virtual ~EagerSearch();
     void statistics() const;
+    virtual void heuristic_statistics() const;
 
     void dump_search_space();
 };
@@ -1,4 +1,5 @@
 #include "enforced_hill_climbing_search.h"
+#include "state_registry.h"
 #include "successor_generator.h"
 #include "heuristic.h"
 #include "operator.h"
@@ -10,6 +11,7 @@ EnforcedHillClimbingSearch::EnforcedHillClimbingSearch(
     const Options &opts)
     : SearchEngine(opts),
       heuristic(opts.get<Heuristic *>("h")),
+      preferred_contains_eval(false),
       use_preferred(false),
       preferred_usage(PreferredUsage(opts.get_enum("preferred_usage"))),
       current_state(*g_initial_state),
@@ -24,6 +26,9 @@ EnforcedHillClimbingSearch::EnforcedHillClimbingSearch(
                         heuristic) != preferred_heuristics.end()) {
             use_preferred = true;
             preferred_contains_eval = true;
+        } else {
+            use_preferred = true;
+            preferred_contains_eval = false;
         }
     }
     search_progress.add_heuristic(heuristic);
@@ -34,21 +39,22 @@ EnforcedHillClimbingSearch::~EnforcedHillClimbingSearch() {
     delete g_evaluator;
 }
 
-void EnforcedHillClimbingSearch::evaluate(const State &parent, const Operator *op, const State &state) {
+void EnforcedHillClimbingSearch::evaluate(const State &parent, const Operator *op, const State &state,
+                                          const EvaluationContext &context) {
     search_progress.inc_evaluated_states();
 
     if (!preferred_contains_eval) {
         if (op != NULL) {
             heuristic->reach_state(parent, *op, state);
         }
-        heuristic->evaluate(state);
+        heuristic->evaluate(state, context);
         search_progress.inc_evaluations();
     }
     for (int i = 0; i < preferred_heuristics.size(); i++) {
         if (op != NULL) {
             preferred_heuristics[i]->reach_state(parent, *op, state);
         }
-        preferred_heuristics[i]->evaluate(state);
+        preferred_heuristics[i]->evaluate(state, context);
     }
     search_progress.inc_evaluations(preferred_heuristics.size());
 }
@@ -65,7 +71,7 @@ void EnforcedHillClimbingSearch::initialize() {
     cout << "(real) g-bound = " << bound << endl;
 
     SearchNode node = search_space.get_node(current_state);
-    evaluate(node.get_state(), NULL, node.get_state());
+    evaluate(current_state, NULL, current_state, EvaluationContext::for_g(0));
     if (heuristic->is_dead_end()) {
         cout << "Initial state is a dead end, no solution" << endl;
         if (heuristic->dead_ends_are_reliable())
@@ -89,33 +95,30 @@ void EnforcedHillClimbingSearch::initialize() {
     }
 }
 
-void EnforcedHillClimbingSearch::get_successors(const State &state, vector<const Operator *> &ops) {
+void EnforcedHillClimbingSearch::get_successors(const State &state,
+                                                const EvaluationContext &context,
+                                                vector<const Operator *> &ops) {
+    preferred_op_marks.clear();
     if (!use_preferred || preferred_usage == RANK_PREFERRED_FIRST) {
-        //g_successor_generator->generate_applicable_ops(state, ops);
-		  g_successor_generators[0]->generate_applicable_ops(state, ops); //Modification MMM
+        context.get_successor_generator()->generate_applicable_ops(state, ops);
 
         // mark preferred operators as preferred
         if (use_preferred && (preferred_usage == RANK_PREFERRED_FIRST)) {
-            for (int i = 0; i < ops.size(); i++) {
-                ops[i]->unmark();
-            }
-            vector<const Operator *> preferred_ops;
+            preferred_ops.clear();
             for (int i = 0; i < preferred_heuristics.size(); i++) {
                 preferred_heuristics[i]->get_preferred_operators(preferred_ops);
             }
             for (int i = 0; i < preferred_ops.size(); i++) {
-                preferred_ops[i]->mark();
+                preferred_op_marks.insert(preferred_ops[i]);
             }
         }
     } else {
-        vector<const Operator *> preferred_ops;
         for (int i = 0; i < preferred_heuristics.size(); i++) {
+            preferred_ops.clear();
             preferred_heuristics[i]->get_preferred_operators(preferred_ops);
             for (int j = 0; j < preferred_ops.size(); j++) {
-                if (!preferred_ops[j]->is_marked()) {
-                    preferred_ops[j]->mark();
+                if (preferred_op_marks.insert(preferred_ops[j]))
                     ops.push_back(preferred_ops[j]);
-                }
             }
         }
     }
@@ -139,18 +142,19 @@ int EnforcedHillClimbingSearch::step() {
         return SOLVED;
     }
 
-    vector<const Operator *> ops;
-    get_successors(current_state, ops);
-
     SearchNode current_node = search_space.get_node(current_state);
+    vector<const Operator *> &ops = successor_ops;
+    ops.clear();
+    get_successors(current_state,
+                   EvaluationContext::for_g(current_node.get_g()), ops);
+
     current_node.close();
 
     for (int i = 0; i < ops.size(); i++) {
         int d = get_adjusted_cost(*ops[i]);
-        OpenListEntryEHC entry = make_pair(current_node.get_state_buffer(), make_pair(d, ops[i]));
-        open_list->evaluate(d, ops[i]->is_marked());
+        OpenListEntryEHC entry = make_pair(current_node.get_state_id(), make_pair(d, ops[i]));
+        open_list->evaluate(d, preferred_op_marks.contains(ops[i]));
         open_list->insert(entry);
-        ops[i]->unmark();
     }
     return ehc();
 }
@@ -158,20 +162,22 @@ int EnforcedHillClimbingSearch::step() {
 int EnforcedHillClimbingSearch::ehc() {
     while (!open_list->empty()) {
         OpenListEntryEHC next = open_list->remove_min();
-        State last_parent = search_space.get_node(State(next.first)).get_state();
+        SearchNode parent_node = search_space.get_node(next.first);
+        State last_parent = parent_node.get_state();
         int d = next.second.first;
         const Operator *last_op = next.second.second;
 
-        if (search_space.get_node(last_parent).get_real_g() + last_op->get_cost() >= bound)
+        if (parent_node.get_real_g() + last_op->get_cost() >= bound)
             continue;
 
-        State s(last_parent, *last_op);
+        State s = g_state_registry->get_successor_state(last_parent, *last_op);
         search_progress.inc_generated();
 
         SearchNode node = search_space.get_node(s);
 
         if (node.is_new()) {
-            evaluate(last_parent, last_op, node.get_state());
+            int g = parent_node.get_g() + get_adjusted_cost(*last_op);
+            evaluate(last_parent, last_op, s, EvaluationContext::for_g(g));
 
             if (heuristic->is_dead_end()) {
                 node.mark_as_dead_end();
@@ -180,7 +186,7 @@ int EnforcedHillClimbingSearch::ehc() {
             }
 
             int h = heuristic->get_heuristic();
-            node.open(h, search_space.get_node(last_parent), last_op);
+            node.open(h, parent_node, last_op);
 
             if (h < current_h) {
                 current_g = node.get_g();
@@ -193,21 +199,21 @@ int EnforcedHillClimbingSearch::ehc() {
                 p.second = p.second + search_progress.get_expanded() - last_expanded;
                 d_counts[d] = p;
 
-                current_state = node.get_state();
+                current_state = s;
                 current_h = heuristic->get_heuristic();
                 open_list->clear();
                 return IN_PROGRESS;
             } else {
-                vector<const Operator *> ops;
-                get_successors(s, ops);
+                vector<const Operator *> &ops = successor_ops;
+                ops.clear();
+                get_successors(s, EvaluationContext::for_g(node.get_g()), ops);
 
                 node.close();
                 for (int i = 0; i < ops.size(); i++) {
                     int new_d = d + get_adjusted_cost(*ops[i]);
-                    OpenListEntryEHC entry = make_pair(node.get_state_buffer(), make_pair(new_d, ops[i]));
-                    open_list->evaluate(new_d, ops[i]->is_marked());
+                    OpenListEntryEHC entry = make_pair(node.get_state_id(), make_pair(new_d, ops[i]));
+                    open_list->evaluate(new_d, preferred_op_marks.contains(ops[i]));
                     open_list->insert(entry);
-                    ops[i]->unmark();
                 }
             }
         }
@@ -216,6 +222,14 @@ int EnforcedHillClimbingSearch::ehc() {
     return FAILED;
 }
 
+void EnforcedHillClimbingSearch::heuristic_statistics() const {
+    heuristic->print_statistics();
+    for (size_t i = 0; i < preferred_heuristics.size(); ++i) {
+        if (preferred_heuristics[i] != heuristic)
+            preferred_heuristics[i]->print_statistics();
+    }
+}
+
 void EnforcedHillClimbingSearch::statistics() const {
     search_progress.print_statistics();
 
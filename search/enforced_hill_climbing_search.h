@@ -3,6 +3,8 @@
 
 #include "search_engine.h"
 #include "globals.h"
+#include "evaluation_context.h"
+#include "marked_operators.h"
 #include "search_space.h"
 #include "search_node_info.h"
 #include "operator.h"
@@ -17,7 +19,7 @@ using namespace std;
 
 class Options;
 
-typedef pair<state_var_t *, pair<int, const Operator * > > OpenListEntryEHC;
+typedef pair<StateID, pair<int, const Operator * > > OpenListEntryEHC;
 
 enum PreferredUsage {
     PRUNE_BY_PREFERRED, RANK_PREFERRED_FIRST,
@@ -35,6 +37,11 @@ protected:
     bool use_preferred;
     PreferredUsage preferred_usage;
 
+    // Scratch space for expansions, reused across steps.
+    vector<const Operator *> successor_ops;
+    vector<const Operator *> preferred_ops;
+    MarkedOperators preferred_op_marks;
+
     State current_state;
     int current_h;
     int current_g;
@@ -47,13 +54,16 @@ protected:
     virtual void initialize();
     virtual int step();
     int ehc();
-    void get_successors(const State &state, vector<const Operator *> &ops);
-    void evaluate(const State &parent, const Operator *op, const State &state);
+    void get_successors(const State &state, const EvaluationContext &context,
+                        vector<const Operator *> &ops);
+    void evaluate(const State &parent, const Operator *op, const State &state,
+                  const EvaluationContext &context);
 public:
     EnforcedHillClimbingSearch(const Options &opts);
     virtual ~EnforcedHillClimbingSearch();
 
     virtual void statistics() const;
+    virtual void heuristic_statistics() const;
 };
 
 #endif
@@ -0,0 +1,15 @@
+#include "evaluation_context.h"
+
+#include "globals.h"
+
+#include <cassert>
+using namespace std;
+
+EvaluationContext EvaluationContext::for_g(int g) {
+    return EvaluationContext((g_use_abstractions && g > g_horizon) ? 1 : 0);
+}
+
+SuccessorGenerator *EvaluationContext::get_successor_generator() const {
+    assert(operator_level < g_successor_generators.size());
+    return g_successor_generators[operator_level];
+}
@@ -0,0 +1,33 @@
+#ifndef EVALUATION_CONTEXT_H
+#define EVALUATION_CONTEXT_H
+
+class SuccessorGenerator;
+
+/*
+  The circumstances under which a state is expanded or evaluated. For
+  now, this is the operator level: 0 for the operators of the task, 1
+  for the abstract operators, which the search engines use for states
+  beyond the abstraction horizon (--abstractions). The search engines
+  pass the context to the successor generators and to
+  Heuristic::evaluate, so that states of both levels can be evaluated
+  side by side (e.g. in one batch, or in several threads).
+*/
+
+class EvaluationContext {
+    int operator_level;
+public:
+    explicit EvaluationContext(int operator_level_ = 0)
+        : operator_level(operator_level_) {
+    }
+
+    // The context of a state reached with (adjusted) cost g.
+    static EvaluationContext for_g(int g);
+
+    int get_operator_level() const {
+        return operator_level;
+    }
+
+    SuccessorGenerator *get_successor_generator() const;
+};
+
+#endif
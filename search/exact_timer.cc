@@ -11,6 +11,7 @@
 #include <mach/mach_time.h>
 #elif OPERATING_SYSTEM == CYGWIN
 #define CLOCK_PROCESS_CPUTIME_ID (clockid_t)2
+#define CLOCK_THREAD_CPUTIME_ID (clockid_t)3
 #endif
 
 using namespace std;
@@ -33,7 +34,8 @@ void mach_absolute_difference(uint64_t end, uint64_t start, struct timespec *tp)
 #endif
 
 
-ExactTimer::ExactTimer() {
+ExactTimer::ExactTimer(Clock clock_)
+    : clock(clock_) {
     last_start_clock = current_clock();
     collected_time = 0;
     stopped = false;
@@ -49,7 +51,12 @@ double ExactTimer::current_clock() const {
     uint64_t end = mach_absolute_time();
     mach_absolute_difference(end, start, &tp);
 #else
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp);
+    if (clock == THREAD_CPU_TIME)
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tp);
+    else if (clock == WALL_CLOCK_TIME)
+        clock_gettime(CLOCK_MONOTONIC, &tp);
+    else
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp);
 #endif
     return (tp.tv_sec * 1e9) + tp.tv_nsec;
 }
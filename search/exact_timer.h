@@ -4,13 +4,22 @@
 #include <iosfwd>
 
 class ExactTimer {
+public:
+    // On OS X, all clocks measure wall-clock time.
+    enum Clock {
+        PROCESS_CPU_TIME, // CPU time of all threads of the process
+        THREAD_CPU_TIME, // CPU time of the thread calling current_clock
+        WALL_CLOCK_TIME
+    };
+private:
+    Clock clock;
     double last_start_clock;
     double collected_time;
     bool stopped;
 
     double current_clock() const;
 public:
-    ExactTimer();
+    explicit ExactTimer(Clock clock = PROCESS_CPU_TIME);
     ~ExactTimer();
     double operator()() const;
     double stop();
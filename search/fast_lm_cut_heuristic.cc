@@ -0,0 +1,390 @@
+#include "fast_lm_cut_heuristic.h"
+
+#include "globals.h"
+#include "lm_cut_heuristic.h"
+#include "relaxed_task.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <vector>
+using namespace std;
+
+const int FastLandmarkCutHeuristic::NO_SUPPORTER;
+
+// construction and destruction
+FastLandmarkCutHeuristic::FastLandmarkCutHeuristic(const Options &opts)
+    : Heuristic(opts),
+      num_operators(0), relaxed_task(0), num_propositions(0),
+      artificial_precondition(-1), artificial_goal(-1),
+      current_reached_stamp(0), goal_zone_stamp(0),
+      all_costs_zero_or_one(false) {
+}
+
+FastLandmarkCutHeuristic::~FastLandmarkCutHeuristic() {
+}
+
+Heuristic *FastLandmarkCutHeuristic::clone() const {
+    return new FastLandmarkCutHeuristic(get_options());
+}
+
+// initialization
+void FastLandmarkCutHeuristic::initialize() {
+    cout << "Initializing landmark cut heuristic (fast version)..." << endl;
+
+    ::verify_no_axioms_no_cond_effects();
+
+    // Number propositions like the relaxed task.
+    relaxed_task = &RelaxedTask::get(0, cost_type);
+    const RelaxedTask &task = *relaxed_task;
+    num_propositions = task.get_num_propositions();
+    artificial_precondition = num_propositions++;
+    artificial_goal = num_propositions++;
+
+    // Build relaxed operators, in the same order as LandmarkCutHeuristic.
+    precondition_begin.push_back(0);
+    effect_begin.push_back(0);
+    vector<int> precondition, effect;
+    for (int i = 0; i < task.get_num_operators(); i++) {
+        precondition.assign(task.preconditions_begin(i),
+                            task.preconditions_end(i));
+        effect.assign(task.effects_begin(i), task.effects_end(i));
+        add_relaxed_operator(precondition, effect, task.get_operator_cost(i));
+    }
+
+    // Build artificial goal operator.
+    precondition.clear();
+    effect.clear();
+    precondition = task.get_goal_propositions();
+    effect.push_back(artificial_goal);
+    add_relaxed_operator(precondition, effect, 0);
+
+    // Cross-reference relaxed operators.
+    precondition_of_begin.assign(num_propositions + 1, 0);
+    effect_of_begin.assign(num_propositions + 1, 0);
+    for (int i = 0; i < preconditions.size(); i++)
+        ++precondition_of_begin[preconditions[i] + 1];
+    for (int i = 0; i < effects.size(); i++)
+        ++effect_of_begin[effects[i] + 1];
+    for (int prop = 0; prop < num_propositions; prop++) {
+        precondition_of_begin[prop + 1] += precondition_of_begin[prop];
+        effect_of_begin[prop + 1] += effect_of_begin[prop];
+    }
+    precondition_of.resize(preconditions.size());
+    effect_of.resize(effects.size());
+    vector<int> precondition_of_end(precondition_of_begin.begin(),
+                                    precondition_of_begin.end() - 1);
+    vector<int> effect_of_end(effect_of_begin.begin(),
+                              effect_of_begin.end() - 1);
+    for (int op = 0; op < num_operators; op++) {
+        for (int i = precondition_begin[op]; i < precondition_begin[op + 1]; i++)
+            precondition_of[precondition_of_end[preconditions[i]]++] = op;
+        for (int i = effect_begin[op]; i < effect_begin[op + 1]; i++)
+            effect_of[effect_of_end[effects[i]]++] = op;
+    }
+
+    cost.resize(num_operators);
+    unsatisfied_preconditions.resize(num_operators);
+    h_max_supporter.resize(num_operators);
+    h_max_supporter_cost.resize(num_operators);
+    supported_position.resize(num_operators);
+    h_max_cost.resize(num_propositions);
+    supported.resize(precondition_of.size());
+    supported_end.resize(num_propositions);
+    supported_sorted.resize(num_propositions);
+    reached_stamp.resize(num_propositions, 0);
+    zone_stamp.resize(num_propositions, 0);
+
+    all_costs_zero_or_one =
+        *max_element(base_cost.begin(), base_cost.end()) * COST_MULTIPLIER <= 1;
+}
+
+void FastLandmarkCutHeuristic::add_relaxed_operator(
+    const vector<int> &precondition, const vector<int> &effect,
+    int op_cost) {
+    if (precondition.empty())
+        preconditions.push_back(artificial_precondition);
+    else
+        preconditions.insert(preconditions.end(),
+                             precondition.begin(), precondition.end());
+    effects.insert(effects.end(), effect.begin(), effect.end());
+    precondition_begin.push_back(preconditions.size());
+    effect_begin.push_back(effects.size());
+    num_preconditions.push_back(
+        precondition_begin[num_operators + 1] -
+        precondition_begin[num_operators]);
+    base_cost.push_back(op_cost);
+    ++num_operators;
+}
+
+// heuristic computation
+void FastLandmarkCutHeuristic::start_evaluation() {
+    if (++current_reached_stamp == 0) {
+        fill(reached_stamp.begin(), reached_stamp.end(), 0);
+        current_reached_stamp = 1;
+    }
+    for (int op = 0; op < num_operators; op++)
+        cost[op] = base_cost[op] * COST_MULTIPLIER;
+    unsatisfied_preconditions = num_preconditions;
+    fill(h_max_supporter.begin(), h_max_supporter.end(), NO_SUPPORTER);
+    copy(precondition_of_begin.begin(), precondition_of_begin.end() - 1,
+         supported_end.begin());
+    fill(supported_sorted.begin(), supported_sorted.end(), true);
+}
+
+void FastLandmarkCutHeuristic::start_round() {
+    if (goal_zone_stamp > numeric_limits<unsigned int>::max() - 3) {
+        fill(zone_stamp.begin(), zone_stamp.end(), 0);
+        goal_zone_stamp = 0;
+    }
+    goal_zone_stamp += 2;
+}
+
+void FastLandmarkCutHeuristic::first_exploration(const State &state) {
+    priority_queue.clear();
+    for (int var = 0; var < g_variable_domain.size(); var++)
+        enqueue_if_necessary(get_proposition(var, state[var]), 0);
+    enqueue_if_necessary(artificial_precondition, 0);
+
+    while (!priority_queue.empty()) {
+        pair<int, int> top_pair = priority_queue.pop();
+        int popped_cost = top_pair.first;
+        int prop = top_pair.second;
+        int prop_cost = h_max_cost[prop];
+        assert(prop_cost <= popped_cost);
+        if (prop_cost < popped_cost)
+            continue;
+        for (int i = precondition_of_begin[prop];
+             i < precondition_of_begin[prop + 1]; i++) {
+            int op = precondition_of[i];
+            assert(unsatisfied_preconditions[op] > 0);
+            if (--unsatisfied_preconditions[op] == 0) {
+                h_max_supporter[op] = prop;
+                h_max_supporter_cost[op] = prop_cost;
+                add_supported(prop, op);
+                int target_cost = prop_cost + cost[op];
+                for (int j = effect_begin[op]; j < effect_begin[op + 1]; j++)
+                    enqueue_if_necessary(effects[j], target_cost);
+            }
+        }
+    }
+}
+
+void FastLandmarkCutHeuristic::first_exploration_zero_one_costs(
+    const State &state) {
+    /*
+      Like first_exploration, but for operator costs 0 and 1, where
+      all queued propositions have the current cost or the next one.
+      The buckets are processed last in, first out, like those of the
+      BucketQueue that first_exploration uses in this case.
+    */
+    assert(current_bucket.empty() && next_bucket.empty());
+    priority_queue.clear();
+    int num_pushes = 0;
+    for (int var = 0; var < g_variable_domain.size(); var++) {
+        int prop = get_proposition(var, state[var]);
+        if (improves(prop, 0))
+            current_bucket.push_back(prop);
+    }
+    if (improves(artificial_precondition, 0))
+        current_bucket.push_back(artificial_precondition);
+    num_pushes += current_bucket.size();
+
+    int current_cost = 0;
+    while (true) {
+        if (current_bucket.empty()) {
+            if (next_bucket.empty())
+                break;
+            current_bucket.swap(next_bucket);
+            ++current_cost;
+        }
+        int prop = current_bucket.back();
+        current_bucket.pop_back();
+        int prop_cost = h_max_cost[prop];
+        assert(prop_cost <= current_cost);
+        if (prop_cost < current_cost)
+            continue;
+        for (int i = precondition_of_begin[prop];
+             i < precondition_of_begin[prop + 1]; i++) {
+            int op = precondition_of[i];
+            assert(unsatisfied_preconditions[op] > 0);
+            if (--unsatisfied_preconditions[op] == 0) {
+                h_max_supporter[op] = prop;
+                h_max_supporter_cost[op] = prop_cost;
+                add_supported(prop, op);
+                int target_cost = prop_cost + cost[op];
+                vector<int> &bucket = target_cost == current_cost ?
+                                      current_bucket : next_bucket;
+                for (int j = effect_begin[op]; j < effect_begin[op + 1]; j++) {
+                    if (improves(effects[j], target_cost)) {
+                        bucket.push_back(effects[j]);
+                        ++num_pushes;
+                    }
+                }
+            }
+        }
+    }
+    // Keep the priority queue of the incremental explorations in the
+    // same state as after first_exploration.
+    priority_queue.add_virtual_pushes(num_pushes);
+}
+
+void FastLandmarkCutHeuristic::first_exploration_incremental() {
+    assert(priority_queue.empty());
+    // See LandmarkCutHeuristic::first_exploration_incremental.
+    priority_queue.add_virtual_pushes(num_propositions);
+    for (int i = 0; i < cut.size(); i++) {
+        int op = cut[i];
+        int target_cost = h_max_supporter_cost[op] + cost[op];
+        for (int j = effect_begin[op]; j < effect_begin[op + 1]; j++)
+            enqueue_if_necessary(effects[j], target_cost);
+    }
+    while (!priority_queue.empty()) {
+        pair<int, int> top_pair = priority_queue.pop();
+        int popped_cost = top_pair.first;
+        int prop = top_pair.second;
+        int prop_cost = h_max_cost[prop];
+        assert(prop_cost <= popped_cost);
+        if (prop_cost < popped_cost)
+            continue;
+        for (int i = precondition_of_begin[prop];
+             i < precondition_of_begin[prop + 1]; i++) {
+            int op = precondition_of[i];
+            if (h_max_supporter[op] == prop) {
+                int old_supp_cost = h_max_supporter_cost[op];
+                if (old_supp_cost > prop_cost) {
+                    update_h_max_supporter(op);
+                    int new_supp_cost = h_max_supporter_cost[op];
+                    if (new_supp_cost != old_supp_cost) {
+                        // This operator has become cheaper.
+                        assert(new_supp_cost < old_supp_cost);
+                        int target_cost = new_supp_cost + cost[op];
+                        for (int j = effect_begin[op]; j < effect_begin[op + 1]; j++)
+                            enqueue_if_necessary(effects[j], target_cost);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FastLandmarkCutHeuristic::second_exploration(const State &state) {
+    assert(second_exploration_queue.empty());
+    assert(cut.empty());
+    unsigned int before_goal_zone_stamp = goal_zone_stamp + 1;
+
+    zone_stamp[artificial_precondition] = before_goal_zone_stamp;
+    second_exploration_queue.push_back(artificial_precondition);
+
+    for (int var = 0; var < g_variable_domain.size(); var++) {
+        int init_prop = get_proposition(var, state[var]);
+        zone_stamp[init_prop] = before_goal_zone_stamp;
+        second_exploration_queue.push_back(init_prop);
+    }
+
+    while (!second_exploration_queue.empty()) {
+        int prop = second_exploration_queue.back();
+        second_exploration_queue.pop_back();
+        // Visit the supported operators in the same order as
+        // LandmarkCutHeuristic, i.e., in the order of precondition_of,
+        // which is sorted by operator number.
+        int begin = precondition_of_begin[prop];
+        int end = supported_end[prop];
+        if (!supported_sorted[prop]) {
+            sort(supported.begin() + begin, supported.begin() + end);
+            for (int i = begin; i < end; i++)
+                supported_position[supported[i]] = i;
+            supported_sorted[prop] = true;
+        }
+        for (int i = begin; i < end; i++) {
+            int op = supported[i];
+            assert(h_max_supporter[op] == prop);
+            bool reached_goal_zone = false;
+            for (int j = effect_begin[op]; j < effect_begin[op + 1]; j++) {
+                if (is_in_goal_zone(effects[j])) {
+                    assert(cost[op] > 0);
+                    reached_goal_zone = true;
+                    cut.push_back(op);
+                    break;
+                }
+            }
+            if (!reached_goal_zone) {
+                for (int j = effect_begin[op]; j < effect_begin[op + 1]; j++) {
+                    int effect = effects[j];
+                    if (zone_stamp[effect] != before_goal_zone_stamp) {
+                        assert(is_reached(effect));
+                        zone_stamp[effect] = before_goal_zone_stamp;
+                        second_exploration_queue.push_back(effect);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FastLandmarkCutHeuristic::mark_goal_plateau() {
+    // The artificial goal and everything that reaches it through
+    // zero-cost operators from their h^max supporters. (Unreachable
+    // zero-cost operators have no supporter.)
+    assert(goal_plateau_queue.empty());
+    zone_stamp[artificial_goal] = goal_zone_stamp;
+    goal_plateau_queue.push_back(artificial_goal);
+    while (!goal_plateau_queue.empty()) {
+        int subgoal = goal_plateau_queue.back();
+        goal_plateau_queue.pop_back();
+        for (int i = effect_of_begin[subgoal];
+             i < effect_of_begin[subgoal + 1]; i++) {
+            int op = effect_of[i];
+            if (cost[op] == 0) {
+                int supporter = h_max_supporter[op];
+                if (supporter != NO_SUPPORTER && !is_in_goal_zone(supporter)) {
+                    zone_stamp[supporter] = goal_zone_stamp;
+                    goal_plateau_queue.push_back(supporter);
+                }
+            }
+        }
+    }
+}
+
+int FastLandmarkCutHeuristic::compute_heuristic(const State &state) {
+    start_evaluation();
+    if (all_costs_zero_or_one)
+        first_exploration_zero_one_costs(state);
+    else
+        first_exploration(state);
+    if (!is_reached(artificial_goal))
+        return DEAD_END;
+
+    int total_cost = 0;
+    while (h_max_cost[artificial_goal] != 0) {
+        start_round();
+        mark_goal_plateau();
+        second_exploration(state);
+        assert(!cut.empty());
+        int cut_cost = numeric_limits<int>::max();
+        for (int i = 0; i < cut.size(); i++) {
+            cut_cost = min(cut_cost, cost[cut[i]]);
+            // See LandmarkCutHeuristic::compute_heuristic.
+            if (COST_MULTIPLIER > 1)
+                cut_cost = min(cut_cost, base_cost[cut[i]]);
+        }
+        for (int i = 0; i < cut.size(); i++)
+            cost[cut[i]] -= cut_cost;
+        total_cost += cut_cost;
+
+        first_exploration_incremental();
+        cut.clear();
+    }
+    return (total_cost + COST_MULTIPLIER - 1) / COST_MULTIPLIER;
+}
+
+void FastLandmarkCutHeuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &,
+    vector<int> &values) {
+    // No preferred operators, so there is nothing to clear between
+    // the states.
+    for (int i = 0; i < states.size(); i++)
+        values[i] = compute_heuristic(states[i]);
+}
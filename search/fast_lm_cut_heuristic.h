@@ -0,0 +1,193 @@
+#ifndef FAST_LM_CUT_HEURISTIC_H
+#define FAST_LM_CUT_HEURISTIC_H
+
+#include "heuristic.h"
+#include "priority_queue.h"
+#include "relaxed_task.h"
+
+#include <cassert>
+#include <vector>
+
+class Options;
+class State;
+
+/*
+  The same computation as LandmarkCutHeuristic (lmcut(fast=true)), with
+  a different memory layout and bookkeeping:
+
+  - Relaxed operators and propositions are numbered, and their data is
+    kept in flat arrays (one per attribute). Preconditions, effects and
+    the cross-references between operators and propositions are stored
+    consecutively: the preconditions of operator op are
+    preconditions[precondition_begin[op]] up to (excluding)
+    preconditions[precondition_begin[op + 1]], and likewise for the
+    others.
+
+  - Whether a proposition is reached, and whether it is in the goal
+    zone or before it, is stored as a stamp. Every evaluation and every
+    round of cut finding gets fresh stamps, so statuses are never reset
+    proposition by proposition.
+
+  - Every proposition keeps a list of the operators it is the h^max
+    supporter of, so that finding the cut does not have to scan all
+    operators that have it as a precondition.
+
+  - If all operators cost 0 or 1, the first h^max exploration uses two
+    buckets (the current cost and the next one) instead of a general
+    priority queue.
+
+  Propositions are processed in exactly the same order as by
+  LandmarkCutHeuristic, so both choose the same h^max supporters and
+  compute the same heuristic values.
+*/
+
+class FastLandmarkCutHeuristic : public Heuristic {
+    static const int NO_SUPPORTER = -1;
+
+    // Relaxed operators: those of the task, then the artificial goal
+    // operator.
+    int num_operators;
+    // Adjusted operator costs; 0 for the artificial goal operator.
+    std::vector<int> base_cost;
+    std::vector<int> num_preconditions;
+    std::vector<int> precondition_begin;
+    std::vector<int> preconditions;
+    std::vector<int> effect_begin;
+    std::vector<int> effects;
+
+    // Data of the current evaluation, indexed by operator.
+    std::vector<int> cost;
+    std::vector<int> unsatisfied_preconditions;
+    std::vector<int> h_max_supporter; // proposition or NO_SUPPORTER
+    std::vector<int> h_max_supporter_cost; // h_max_cost of h_max_supporter
+    std::vector<int> supported_position; // index into supported
+
+    // Propositions: those of the relaxed task (numbered like there),
+    // then the artificial precondition and the artificial goal.
+    const RelaxedTask *relaxed_task;
+    int num_propositions;
+    int artificial_precondition;
+    int artificial_goal;
+    std::vector<int> precondition_of_begin;
+    std::vector<int> precondition_of;
+    std::vector<int> effect_of_begin;
+    std::vector<int> effect_of;
+
+    // Data of the current evaluation, indexed by proposition.
+    std::vector<int> h_max_cost; // valid for reached propositions
+    // The operators whose h^max supporter is prop are
+    // supported[precondition_of_begin[prop]] up to (excluding)
+    // supported[supported_end[prop]]. (There is room for all operators
+    // that have prop as a precondition.) The second exploration only
+    // needs to look at these, instead of all operators in
+    // precondition_of. It visits them by increasing number, and
+    // supported_sorted tells if they are sorted like that already.
+    std::vector<int> supported;
+    std::vector<int> supported_end;
+    std::vector<char> supported_sorted;
+    std::vector<unsigned int> reached_stamp;
+    std::vector<unsigned int> zone_stamp;
+    // A proposition is reached if its reached_stamp is
+    // current_reached_stamp. It is in the goal zone if its zone_stamp
+    // is goal_zone_stamp, and before the goal zone if it is
+    // goal_zone_stamp + 1.
+    unsigned int current_reached_stamp;
+    unsigned int goal_zone_stamp;
+
+    bool all_costs_zero_or_one;
+    AdaptiveQueue<int> priority_queue;
+    // Scratch space for compute_heuristic, kept across calls.
+    std::vector<int> current_bucket;
+    std::vector<int> next_bucket;
+    std::vector<int> cut;
+    std::vector<int> second_exploration_queue;
+    std::vector<int> goal_plateau_queue;
+
+    virtual void initialize();
+    virtual int compute_heuristic(const State &state);
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
+    void add_relaxed_operator(const std::vector<int> &precondition,
+                              const std::vector<int> &effect, int cost);
+    void start_evaluation();
+    void start_round();
+    void first_exploration(const State &state);
+    void first_exploration_zero_one_costs(const State &state);
+    void first_exploration_incremental();
+    void second_exploration(const State &state);
+    void mark_goal_plateau();
+
+    int get_proposition(int var, int value) const {
+        return relaxed_task->get_proposition(var, value);
+    }
+
+    bool is_reached(int prop) const {
+        return reached_stamp[prop] == current_reached_stamp;
+    }
+
+    bool is_in_goal_zone(int prop) const {
+        return zone_stamp[prop] == goal_zone_stamp;
+    }
+
+    bool is_before_goal_zone(int prop) const {
+        return zone_stamp[prop] == goal_zone_stamp + 1;
+    }
+
+    bool improves(int prop, int new_cost) {
+        assert(new_cost >= 0);
+        if (!is_reached(prop) || h_max_cost[prop] > new_cost) {
+            reached_stamp[prop] = current_reached_stamp;
+            h_max_cost[prop] = new_cost;
+            return true;
+        }
+        return false;
+    }
+
+    void enqueue_if_necessary(int prop, int new_cost) {
+        if (improves(prop, new_cost))
+            priority_queue.push(new_cost, prop);
+    }
+
+    void add_supported(int prop, int op) {
+        int pos = supported_end[prop]++;
+        if (pos != precondition_of_begin[prop] && supported[pos - 1] > op)
+            supported_sorted[prop] = false;
+        supported[pos] = op;
+        supported_position[op] = pos;
+    }
+
+    void remove_supported(int prop, int op) {
+        int pos = supported_position[op];
+        int last = --supported_end[prop];
+        if (pos != last) {
+            supported[pos] = supported[last];
+            supported_position[supported[pos]] = pos;
+            supported_sorted[prop] = false;
+        }
+    }
+
+    void update_h_max_supporter(int op) {
+        assert(!unsatisfied_preconditions[op]);
+        int old_supporter = h_max_supporter[op];
+        int supporter = old_supporter;
+        for (int i = precondition_begin[op]; i < precondition_begin[op + 1]; i++) {
+            int pre = preconditions[i];
+            if (h_max_cost[pre] > h_max_cost[supporter])
+                supporter = pre;
+        }
+        if (supporter != old_supporter) {
+            remove_supported(old_supporter, op);
+            add_supported(supporter, op);
+            h_max_supporter[op] = supporter;
+        }
+        h_max_supporter_cost[op] = h_max_cost[supporter];
+    }
+public:
+    FastLandmarkCutHeuristic(const Options &opts);
+    virtual ~FastLandmarkCutHeuristic();
+    virtual Heuristic *clone() const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define FF_HEURISTIC_H
 
 #include "additive_heuristic.h"
+#include "marked_operators.h"
 
 #include <vector>
 
@@ -16,20 +17,16 @@
 
 
 class FFHeuristic : public AdditiveHeuristic {
-    // Relaxed plans are represented as a set of operators implemented
-    // as a bit vector.
-    typedef std::vector<bool> RelaxedPlan;
-
-    RelaxedPlan relaxed_plan;
-
-    void mark_preferred_operators_and_relaxed_plan(
-        const State &state, Proposition *goal);
+    // The operators of the current relaxed plan.
+    MarkedOperators relaxed_plan;
 protected:
     virtual void initialize();
-    virtual int compute_heuristic(const State &state);
+    virtual int compute_heuristic_value(const State &state, int level,
+                                        bool mark_preferred);
 public:
     FFHeuristic(const Options &options);
     ~FFHeuristic();
+    virtual Heuristic *clone() const;
 };
 
 #endif
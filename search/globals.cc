@@ -8,6 +8,7 @@
 #include "operator.h"
 #include "rng.h"
 #include "state.h"
+#include "state_registry.h"
 #include "successor_generator.h"
 #include "timer.h"
 #include "utilities.h"
@@ -149,12 +150,6 @@ void read_variables(istream &in) {
         in >> range;
 
         g_variable_domain.push_back(range);
-        if (range > numeric_limits<state_var_t>::max()) {
-            cerr << "This should not have happened!" << endl;
-            cerr << "Are you using the downward script, or are you using "
-                 << "downward-1 directly?" << endl;
-            exit_with(EXIT_INPUT_ERROR);
-        }
 
         in >> ws;
         vector<string> fact_names(range);
@@ -289,6 +284,7 @@ void read_everything(istream &in) {
     read_abstractions(in);  
     read_metric(in);
     read_variables(in);
+    State::initialize_zobrist_keys();
     read_mutexes(in);
     g_initial_state = new State(in);
     read_goal(in);
@@ -532,6 +528,8 @@ vector<vector<string> > g_fact_names;
 vector<int> g_axiom_layers;
 vector<int> g_default_axiom_values;
 State *g_initial_state;
+StateRegistry *g_state_registry;
+StateHashTableType g_state_hash_table_type = OPEN_ADDRESSING_STATE_HASH_TABLE;
 vector<pair<int, int> > g_goal;
 vector<Operator> g_operators;
 vector<Operator> g_axioms;
@@ -541,7 +539,6 @@ vector<DomainTransitionGraph *> g_transition_graphs;
 CausalGraph *g_causal_graph;
 LegacyCausalGraph *g_legacy_causal_graph;
 
-int operator_level;
 vector<SuccessorGenerator *> g_successor_generators; //Modification MMM
 LandmarkGraph *g_lm_graph; //Modification MMM
 bool g_generate_abstractions; //Modification MMM
@@ -554,4 +551,5 @@ string g_abstraction_filename;
 
 Timer g_timer;
 string g_plan_filename = "sas_plan";
+string g_pdb_directory;
 RandomNumberGenerator g_rng(2011); // Use an arbitrary default seed.
@@ -15,6 +15,7 @@ class LegacyCausalGraph;
 class Operator;
 class RandomNumberGenerator;
 class State;
+class StateRegistry;
 class SuccessorGenerator;
 class Timer;
 class AbstractVariable; //Modification MMM
@@ -50,6 +51,13 @@ extern std::vector<int> g_axiom_layers;
 extern std::vector<int> g_default_axiom_values;
 
 extern State *g_initial_state;
+extern StateRegistry *g_state_registry;
+enum StateHashTableType {
+    OPEN_ADDRESSING_STATE_HASH_TABLE,
+    CHAINED_STATE_HASH_TABLE
+};
+// Set by --state-hash-table before g_state_registry is created.
+extern StateHashTableType g_state_hash_table_type;
 extern std::vector<std::pair<int, int> > g_goal;
 
 extern std::vector<Operator> g_operators;
@@ -61,9 +69,10 @@ extern CausalGraph *g_causal_graph;
 extern LegacyCausalGraph *g_legacy_causal_graph;
 extern Timer g_timer;
 extern std::string g_plan_filename;
+// Set by --pdb-dir; empty if PDBs are not saved to files.
+extern std::string g_pdb_directory;
 extern RandomNumberGenerator g_rng;
 
-extern int operator_level;
 extern std::vector<SuccessorGenerator *> g_successor_generators; //Modification MMM
 extern LandmarkGraph *g_lm_graph; //Modification MMM
 extern bool g_generate_abstractions; //Modification MMM
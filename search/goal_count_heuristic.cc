@@ -19,6 +19,10 @@ void GoalCountHeuristic::initialize() {
     cout << "Initializing goal count heuristic..." << endl;
 }
 
+Heuristic *GoalCountHeuristic::clone() const {
+    return new GoalCountHeuristic(get_options());
+}
+
 int GoalCountHeuristic::compute_heuristic(const State &state) {
     int unsatisfied_goal_count = 0;
     for (int i = 0; i < g_goal.size(); i++) {
@@ -10,6 +10,7 @@ protected:
 public:
     GoalCountHeuristic(const Options &options);
     ~GoalCountHeuristic();
+    virtual Heuristic *clone() const;
 };
 
 #endif
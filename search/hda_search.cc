@@ -0,0 +1,354 @@
+#include "hda_search.h"
+
+#include "evaluation_context.h"
+#include "globals.h"
+#include "g_evaluator.h"
+#include "heuristic.h"
+#include "option_parser.h"
+#include "plugin.h"
+#include "state_registry.h"
+#include "successor_generator.h"
+#include "sum_evaluator.h"
+#include "thread_pool.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <sched.h>
+using namespace std;
+
+HDASearch::Worker::Worker(int index_, Heuristic *heuristic_,
+                          OperatorCost cost_type)
+    : index(index_),
+      registry(new StateRegistry(g_state_hash_table_type)),
+      search_space(*registry, cost_type),
+      heuristic(heuristic_),
+      expanded_states(0), evaluated_states(0), generated_states(0),
+      reopened_states(0), dead_end_states(0), sent_messages(0) {
+    // Same open list as astar(), but for this thread's heuristic.
+    vector<ScalarEvaluator *> sum_evals;
+    sum_evals.push_back(new GEvaluator());
+    sum_evals.push_back(heuristic);
+    vector<ScalarEvaluator *> evals;
+    evals.push_back(new SumEvaluator(sum_evals));
+    evals.push_back(heuristic);
+    open_list = new TieBreakingOpenList<StateID>(evals, false, false);
+}
+
+HDASearch::Worker::~Worker() {
+    delete open_list;
+    delete registry;
+}
+
+class HDASearch::SearchJob : public ThreadPool::Job {
+    HDASearch &search;
+public:
+    explicit SearchJob(HDASearch &search_)
+        : search(search_) {
+    }
+
+    virtual void run(int thread_index) {
+        search.search_thread(thread_index);
+    }
+};
+
+HDASearch::HDASearch(const Options &opts)
+    : SearchEngine(opts),
+      num_threads(opts.get<int>("threads")),
+      heuristic(opts.get<Heuristic *>("eval")),
+      work_counter(0),
+      incumbent_cost(numeric_limits<int>::max()),
+      goal_thread(-1),
+      goal_state_id(StateID::no_state) {
+    pthread_mutex_init(&goal_mutex, 0);
+}
+
+HDASearch::~HDASearch() {
+    for (size_t i = 0; i < workers.size(); ++i) {
+        // Thread 0 uses the heuristic we were given.
+        if (i != 0)
+            delete workers[i]->heuristic;
+        delete workers[i];
+    }
+    pthread_mutex_destroy(&goal_mutex);
+}
+
+void HDASearch::initialize() {
+    cout << "Conducting hash-distributed A* search with " << num_threads
+         << " threads, (real) bound = " << bound << endl;
+    if (!g_axioms.empty()) {
+        cout << "HDA* does not support axioms." << endl;
+        exit_with(EXIT_UNSUPPORTED);
+    }
+    if (heuristic->depends_on_reach_state()) {
+        // The threads do not report transitions, and their states are
+        // not registered in g_state_registry.
+        cout << "HDA* does not support heuristics that depend on "
+             << "reach_state." << endl;
+        exit_with(EXIT_UNSUPPORTED);
+    }
+
+    search_progress.add_heuristic(heuristic);
+    heuristic->evaluate(*g_initial_state);
+    search_progress.inc_evaluated_states();
+    search_progress.inc_evaluations();
+
+    for (int i = 0; i < num_threads; ++i) {
+        Heuristic *h = heuristic;
+        if (i != 0) {
+            h = heuristic->clone();
+            if (!h) {
+                cout << "HDA* with more than one thread needs a heuristic "
+                     << "that can be cloned." << endl;
+                exit_with(EXIT_INPUT_ERROR);
+            }
+            // Initialize the clone here rather than in its thread.
+            h->evaluate(*g_initial_state);
+        }
+        workers.push_back(new Worker(i, h, cost_type));
+    }
+    work_counter = num_threads;
+
+    if (heuristic->is_dead_end()) {
+        cout << "Initial state is a dead end." << endl;
+    } else {
+        search_progress.get_initial_h_values();
+        Message *message = new Message(*g_initial_state, 0, 0, -1,
+                                       StateID::no_state, 0);
+        ++work_counter;
+        workers[get_owner(*g_initial_state)]->inbox.push(message);
+    }
+}
+
+int HDASearch::get_owner(const State &state) const {
+    /*
+      The state registries index their hash tables with the low bits of
+      the hash value, so we must not partition by those bits: all states
+      of a thread would then fall into the same part of its table. The
+      high bits of a multiplicative scramble depend on all bits.
+    */
+    unsigned int scrambled = static_cast<unsigned int>(state.hash()) * 2654435761U;
+    return (scrambled >> 16) % num_threads;
+}
+
+int HDASearch::step() {
+    {
+        ThreadPool thread_pool(num_threads);
+        SearchJob job(*this);
+        thread_pool.run(job);
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        const Worker &worker = *workers[i];
+        search_progress.inc_expanded(worker.expanded_states);
+        search_progress.inc_evaluated_states(worker.evaluated_states);
+        search_progress.inc_evaluations(worker.evaluated_states);
+        search_progress.inc_generated(worker.generated_states);
+        search_progress.inc_reopened(worker.reopened_states);
+        search_progress.inc_dead_ends(worker.dead_end_states);
+    }
+
+    if (goal_thread == -1) {
+        cout << "Completely explored state space -- no solution!" << endl;
+        return FAILED;
+    }
+    Plan plan;
+    trace_path(plan);
+    set_plan(plan);
+    return SOLVED;
+}
+
+void HDASearch::search_thread(int thread_index) {
+    Worker &worker = *workers[thread_index];
+    // Every thread counts as working at the start (see initialize).
+    bool working = true;
+    while (true) {
+        Message *messages = worker.inbox.pop_all();
+        if (messages) {
+            if (!working) {
+                __sync_fetch_and_add(&work_counter, 1);
+                working = true;
+            }
+            int num_messages = 0;
+            while (messages) {
+                Message *message = messages;
+                messages = message->next;
+                receive(worker, message->state, message->g, message->real_g,
+                        message->parent_thread, message->parent_state_id,
+                        message->creating_operator);
+                delete message;
+                ++num_messages;
+            }
+            __sync_fetch_and_sub(&work_counter, num_messages);
+        }
+
+        if (!expand_next(worker)) {
+            if (working) {
+                __sync_fetch_and_sub(&work_counter, 1);
+                working = false;
+            }
+            /*
+              Threads only send messages while working, and only
+              start working again when they receive one, so once the
+              counter is 0 it stays 0.
+            */
+            if (work_counter == 0)
+                break;
+            sched_yield();
+        }
+    }
+}
+
+void HDASearch::send(Worker &worker, const State &state, int g, int real_g,
+                     StateID parent_state_id, const Operator *op) {
+    int owner = get_owner(state);
+    if (owner == worker.index) {
+        receive(worker, state, g, real_g, worker.index, parent_state_id, op);
+        return;
+    }
+    // Count the message before the receiver can see (and uncount) it.
+    __sync_fetch_and_add(&work_counter, 1);
+    workers[owner]->inbox.push(
+        new Message(state, g, real_g, worker.index, parent_state_id, op));
+    ++worker.sent_messages;
+}
+
+void HDASearch::receive(Worker &worker, const State &state, int g, int real_g,
+                        int parent_thread, StateID parent_state_id,
+                        const Operator *op) {
+    if (g >= incumbent_cost)
+        return;
+    State registered_state = worker.registry->import_state(state);
+    StateID state_id = registered_state.get_id();
+    SearchNode node = worker.search_space.get_node(state_id);
+    if (node.is_new()) {
+        worker.heuristic->evaluate(registered_state,
+                                   EvaluationContext::for_g(g));
+        ++worker.evaluated_states;
+        if (worker.heuristic->is_dead_end()) {
+            node.mark_as_dead_end();
+            ++worker.dead_end_states;
+            return;
+        }
+        node.open(worker.heuristic->get_heuristic(), g, real_g,
+                  parent_state_id, op);
+    } else if (node.is_dead_end() || node.get_g() <= g) {
+        return;
+    } else {
+        // We found a cheaper path to an open or closed state.
+        if (node.is_closed())
+            ++worker.reopened_states;
+        worker.heuristic->set_evaluator_value(node.get_h());
+        node.reopen(g, real_g, parent_state_id, op);
+    }
+    worker.parent_threads[state_id] = parent_thread;
+    worker.open_list->evaluate(g, false);
+    worker.open_list->insert(state_id);
+}
+
+bool HDASearch::expand_next(Worker &worker) {
+    while (!worker.open_list->empty()) {
+        StateID state_id = worker.open_list->remove_min();
+        SearchNode node = worker.search_space.get_node(state_id);
+        // Skip entries of states that have been expanded with a lower g
+        // since they were inserted.
+        if (!node.is_open())
+            continue;
+        // With an admissible heuristic, this cannot lead to a cheaper plan.
+        if (node.get_g() + node.get_h() >= incumbent_cost)
+            continue;
+        node.close();
+        ++worker.expanded_states;
+
+        State state = worker.registry->lookup_state(state_id);
+        if (test_goal(state)) {
+            report_goal(worker, state_id, node.get_g());
+            return true;
+        }
+
+        worker.applicable_ops.clear();
+        // Beyond the abstraction horizon, expand with the abstract
+        // operators, as the heuristic was evaluated on that level.
+        EvaluationContext context = EvaluationContext::for_g(node.get_g());
+        context.get_successor_generator()->generate_applicable_ops(
+            state, worker.applicable_ops, worker.successor_generator_scratch);
+        for (size_t i = 0; i < worker.applicable_ops.size(); ++i) {
+            const Operator *op = worker.applicable_ops[i];
+            if (node.get_real_g() + op->get_cost() >= bound)
+                continue;
+            int succ_g = node.get_g() + get_adjusted_cost(*op);
+            if (succ_g >= incumbent_cost)
+                continue;
+            State succ_state(state, *op);
+            ++worker.generated_states;
+            send(worker, succ_state, succ_g, node.get_real_g() + op->get_cost(),
+                 state_id, op);
+        }
+        return true;
+    }
+    return false;
+}
+
+void HDASearch::report_goal(Worker &worker, StateID state_id, int g) {
+    pthread_mutex_lock(&goal_mutex);
+    if (g < incumbent_cost) {
+        cout << "Solution found with cost " << g << " by thread "
+             << worker.index << " [t=" << g_timer << "]" << endl;
+        incumbent_cost = g;
+        goal_thread = worker.index;
+        goal_state_id = state_id;
+    }
+    pthread_mutex_unlock(&goal_mutex);
+}
+
+void HDASearch::trace_path(vector<const Operator *> &path) const {
+    /*
+      Like SearchSpace::trace_path, but the parent of a node may be in
+      the search space of another thread, so we switch threads as we go.
+    */
+    assert(path.empty());
+    int thread = goal_thread;
+    StateID state_id = goal_state_id;
+    for (;;) {
+        Worker &worker = *workers[thread];
+        SearchNode node = worker.search_space.get_node(state_id);
+        assert(!node.is_new());
+        const Operator *op = node.get_creating_operator();
+        if (op == 0)
+            break;
+        path.push_back(op);
+        thread = worker.parent_threads[state_id];
+        state_id = node.get_parent_state_id();
+    }
+    reverse(path.begin(), path.end());
+}
+
+void HDASearch::statistics() const {
+    search_progress.print_statistics();
+    int registered_states = 0;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        const Worker &worker = *workers[i];
+        cout << "Thread " << i << ": expanded " << worker.expanded_states
+             << ", evaluated " << worker.evaluated_states
+             << ", sent " << worker.sent_messages << " state(s)" << endl;
+        registered_states += worker.registry->size();
+    }
+    cout << "Registered states: " << registered_states << endl;
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.add_option<Heuristic *>("eval");
+    parser.add_option<int>("threads", 1, "number of threads");
+    SearchEngine::add_options_to_parser(parser);
+    Options opts = parser.parse();
+    if (!parser.dry_run() && opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
+
+    HDASearch *engine = 0;
+    if (!parser.dry_run())
+        engine = new HDASearch(opts);
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("hdastar", _parse);
@@ -0,0 +1,123 @@
+#ifndef HDA_SEARCH_H
+#define HDA_SEARCH_H
+
+#include <pthread.h>
+#include <vector>
+
+#include "mpsc_queue.h"
+#include "open_lists/open_list.h"
+#include "per_state_information.h"
+#include "search_engine.h"
+#include "search_space.h"
+#include "state.h"
+#include "state_id.h"
+
+class Heuristic;
+class Operator;
+class Options;
+class StateRegistry;
+
+/*
+  Hash-distributed A* (Kishimoto, Fukunaga and Botea, 2009).
+
+  Every thread owns the states whose hash values map to it (see
+  get_owner), and has its own state registry, search space, open list
+  and clone of the heuristic. A thread expands the best state of its
+  open list and sends each successor to its owner, which evaluates it
+  and inserts it into its open list (or reopens it if it was reached
+  more cheaply than before). Messages go through lock-free inboxes
+  (see MPSCQueue).
+
+  Since the threads do not expand states in global f order, the first
+  goal found is not necessarily optimal. Instead, the cost of the best
+  plan found so far is shared by all threads, which discard states
+  that cannot lead to a cheaper plan. The search ends when no thread
+  has anything left to do and no message is underway. With an
+  admissible heuristic, the plan is then optimal.
+*/
+
+class HDASearch : public SearchEngine {
+    // A state sent to its owner, together with the path it was reached by.
+    struct Message {
+        Message *next;
+        State state;
+        int g;
+        int real_g;
+        int parent_thread;
+        StateID parent_state_id;
+        const Operator *creating_operator;
+
+        Message(const State &state_, int g_, int real_g_, int parent_thread_,
+                StateID parent_state_id_, const Operator *creating_operator_)
+            : next(0), state(state_), g(g_), real_g(real_g_),
+              parent_thread(parent_thread_),
+              parent_state_id(parent_state_id_),
+              creating_operator(creating_operator_) {
+        }
+    };
+
+    struct Worker {
+        int index;
+        StateRegistry *registry;
+        // The nodes of the states of this thread, whose parents may
+        // belong to another thread (given by parent_threads).
+        SearchSpace search_space;
+        PerStateInformation<int> parent_threads;
+        Heuristic *heuristic;
+        OpenList<StateID> *open_list;
+        MPSCQueue<Message> inbox;
+        // Scratch space for expand_next.
+        std::vector<const Operator *> applicable_ops;
+        std::vector<int> successor_generator_scratch;
+
+        int expanded_states;
+        int evaluated_states;
+        int generated_states;
+        int reopened_states;
+        int dead_end_states;
+        int sent_messages;
+
+        Worker(int index_, Heuristic *heuristic_, OperatorCost cost_type);
+        ~Worker();
+    };
+
+    int num_threads;
+    Heuristic *heuristic;
+    std::vector<Worker *> workers;
+
+    /*
+      The number of threads that are working plus the number of
+      messages that have been sent but not processed yet. Once it
+      drops to 0, nothing can happen anymore and the search is over.
+    */
+    volatile int work_counter;
+
+    // Cost of the best plan found so far (changed under goal_mutex).
+    volatile int incumbent_cost;
+    int goal_thread;
+    StateID goal_state_id;
+    pthread_mutex_t goal_mutex;
+
+    class SearchJob;
+    friend class SearchJob;
+
+    int get_owner(const State &state) const;
+    void send(Worker &worker, const State &state, int g, int real_g,
+              StateID parent_state_id, const Operator *op);
+    void receive(Worker &worker, const State &state, int g, int real_g,
+                 int parent_thread, StateID parent_state_id,
+                 const Operator *op);
+    bool expand_next(Worker &worker);
+    void report_goal(Worker &worker, StateID state_id, int g);
+    void search_thread(int thread_index);
+    void trace_path(std::vector<const Operator *> &path) const;
+protected:
+    virtual void initialize();
+    virtual int step();
+public:
+    HDASearch(const Options &opts);
+    virtual ~HDASearch();
+    virtual void statistics() const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "operator.h"
 #include "option_parser.h"
 #include "operator_cost.h"
+#include "state.h"
 
 #include <cassert>
 #include <cstdlib>
@@ -10,8 +11,10 @@
 using namespace std;
 
 Heuristic::Heuristic(const Options &opts)
-    : cost_type(OperatorCost(opts.get_enum("cost_type"))) {
+    : options(new Options(opts)),
+      cost_type(OperatorCost(opts.get_enum("cost_type"))) {
     heuristic = NOT_INITIALIZED;
+    initialized = false;
 
     is_unit_cost = true;
     for (size_t i = 0; i < g_operators.size(); ++i) {
@@ -23,24 +26,30 @@ Heuristic::Heuristic(const Options &opts)
 }
 
 Heuristic::~Heuristic() {
+    delete options;
 }
 
 void Heuristic::set_preferred(const Operator *op) {
-    if (!op->is_marked()) {
-        op->mark();
+    if (preferred_operator_marks.insert(op))
         preferred_operators.push_back(op);
-    }
 }
 
-void Heuristic::evaluate(const State &state) {   
-	if (heuristic == NOT_INITIALIZED)
+void Heuristic::clear_preferred() {
+    preferred_operators.clear();
+    preferred_operator_marks.clear();
+}
+
+void Heuristic::evaluate(const State &state,
+                         const EvaluationContext &context_) {
+    if (!initialized) {
         initialize();
-    
-	preferred_operators.clear();
+        initialized = true;
+    }
+
+    context = context_;
+    clear_preferred();
     heuristic = compute_heuristic(state);
 
-    for (int i = 0; i < preferred_operators.size(); i++)
-        preferred_operators[i]->unmark();
     assert(heuristic == DEAD_END || heuristic >= 0);
 
     if (heuristic == DEAD_END) {
@@ -60,6 +69,50 @@ void Heuristic::evaluate(const State &state) {
     evaluator_value = heuristic;
 }
 
+void Heuristic::evaluate_batch(const vector<State> &states,
+                               const vector<EvaluationContext> &contexts) {
+    evaluate_batch(states, contexts, batch_values);
+}
+
+void Heuristic::evaluate_batch(const vector<State> &states,
+                               const vector<EvaluationContext> &contexts,
+                               vector<int> &values) {
+    if (!initialized) {
+        initialize();
+        initialized = true;
+    }
+
+    assert(contexts.size() == states.size());
+    values.resize(states.size());
+    compute_heuristic_batch(states, contexts, values);
+    clear_preferred();
+
+#ifndef NDEBUG
+    for (int i = 0; i < values.size(); i++)
+        assert(values[i] == DEAD_END || values[i] >= 0);
+#endif
+}
+
+void Heuristic::set_batch_results(vector<int> &values) {
+    batch_values.swap(values);
+}
+
+void Heuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &contexts,
+    vector<int> &values) {
+    for (int i = 0; i < states.size(); i++) {
+        context = contexts[i];
+        clear_preferred();
+        values[i] = compute_heuristic(states[i]);
+    }
+}
+
+void Heuristic::select_batch_result(int index) {
+    assert(index >= 0 && index < batch_values.size());
+    heuristic = batch_values[index];
+    evaluator_value = heuristic;
+}
+
 bool Heuristic::is_dead_end() const {
     return evaluator_value == DEAD_END;
 }
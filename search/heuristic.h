@@ -1,6 +1,8 @@
 #ifndef HEURISTIC_H
 #define HEURISTIC_H
 
+#include "evaluation_context.h"
+#include "marked_operators.h"
 #include "scalar_evaluator.h"
 #include "operator_cost.h"
 
@@ -22,16 +24,48 @@ class Heuristic : public ScalarEvaluator {
     // estimates, eg. when re-opening a search node
 
     std::vector<const Operator *> preferred_operators;
+    // The operators in preferred_operators, for duplicate elimination.
+    MarkedOperators preferred_operator_marks;
     bool is_unit_cost;
+    bool initialized;
+    // The context of the current evaluation.
+    EvaluationContext context;
+    // Results of the last call to evaluate_batch.
+    std::vector<int> batch_values;
+    // The options this heuristic was created with, for clone().
+    Options *options;
+
+    // not implemented
+    Heuristic(const Heuristic &);
+    Heuristic &operator=(const Heuristic &);
 protected:
     OperatorCost cost_type;
     enum {DEAD_END = -1};
     virtual void initialize() {}
     virtual int compute_heuristic(const State &state) = 0;
+    // Computes the heuristic values of all states, writing them to
+    // values (which has the right size already). contexts[i] is the
+    // context of states[i]. Preferred operators are not needed for
+    // batches, so implementations may skip marking them. The default
+    // implementation calls compute_heuristic for each state.
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
+    // The context of the state passed to compute_heuristic.
+    const EvaluationContext &get_context() const {
+        return context;
+    }
+    void clear_preferred();
+    const Options &get_options() const {return *options; }
     // Usage note: It's OK to set the same operator as preferred
     // multiple times -- it will still only appear in the list of
     // preferred operators for this heuristic once.
     void set_preferred(const Operator *op);
+    // The operators set as preferred so far in this evaluation.
+    const std::vector<const Operator *> &get_current_preferred() const {
+        return preferred_operators;
+    }
     int get_adjusted_cost(const Operator &op) const;
     bool is_unit_cost_problem() const {
         return is_unit_cost;
@@ -40,7 +74,31 @@ public:
     Heuristic(const Options &options);
     virtual ~Heuristic();
 
-    void evaluate(const State &state);
+    void evaluate(const State &state,
+                  const EvaluationContext &context = EvaluationContext());
+    // Evaluates a number of states at once (states[i] in contexts[i]),
+    // without preferred operators. The value of each state then has to
+    // be selected with select_batch_result before it can be queried;
+    // this leaves the heuristic in the same condition as evaluate on
+    // that state, except that there are no preferred operators.
+    void evaluate_batch(const std::vector<State> &states,
+                        const std::vector<EvaluationContext> &contexts);
+    void select_batch_result(int index);
+    // Like evaluate_batch, but returns the values to the caller instead
+    // of keeping them. They can be handed back with set_batch_results,
+    // which leaves values with unspecified contents.
+    void evaluate_batch(const std::vector<State> &states,
+                        const std::vector<EvaluationContext> &contexts,
+                        std::vector<int> &values);
+    void set_batch_results(std::vector<int> &values);
+    /*
+      Returns a new instance of this heuristic that computes the same
+      values and shares no mutable data with this one, so that the two
+      can be evaluated in parallel on different states, or 0 if the
+      heuristic does not support this. (Heuristics that depend on
+      reach_state or on the order of evaluations cannot be cloned.)
+    */
+    virtual Heuristic *clone() const {return 0; }
     bool is_dead_end() const;
     int get_heuristic();
     // changed to virtual, so HeuristicProxy can delegate this:
@@ -48,6 +106,10 @@ public:
     virtual bool dead_ends_are_reliable() const {return true; }
     virtual bool reach_state(const State &parent_state, const Operator &op,
                              const State &state);
+    // Whether the heuristic needs reach_state to be called for every
+    // transition, with states of g_state_registry. Search engines that
+    // do not do this (e.g. HDA*) must not use such heuristics.
+    virtual bool depends_on_reach_state() const {return false; }
 
     // for abstract parent ScalarEvaluator
     int get_value() const;
@@ -56,6 +118,8 @@ public:
     void set_evaluator_value(int val);
     void get_involved_heuristics(std::set<Heuristic *> &hset) {hset.insert(this); }
     virtual void reset() {}
+    // Prints statistics on the heuristic computation, if there are any.
+    virtual void print_statistics() const {}
     OperatorCost get_cost_type() const {return cost_type; }
 
     static void add_options_to_parser(OptionParser &parser);
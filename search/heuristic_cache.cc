@@ -0,0 +1,85 @@
+#include "heuristic_cache.h"
+
+#include "state.h"
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+size_t HeuristicCache::hash_key::operator()(const Key &key) const {
+    unsigned long hash_value = 0;
+    for (int i = 0; i < key.size(); i++)
+        hash_value = 17 * hash_value + key[i];
+    return size_t(hash_value);
+}
+
+HeuristicCache::HeuristicCache(int capacity_)
+    : capacity(capacity_), lookups(0), hits(0) {
+    assert(capacity > 0);
+    entry_map.resize(capacity * 2);
+}
+
+void HeuristicCache::set_relevant_variables(int level,
+                                            const vector<int> &vars) {
+    assert(entry_map.empty());
+    if (relevant_variables.size() <= level)
+        relevant_variables.resize(level + 1);
+    relevant_variables[level] = vars;
+}
+
+void HeuristicCache::compute_key(int level, const State &state) {
+    assert(level < relevant_variables.size());
+    const vector<int> &vars = relevant_variables[level];
+    key.resize(vars.size() + 1);
+    key[0] = level;
+    for (int i = 0; i < vars.size(); i++)
+        key[i + 1] = state[vars[i]];
+}
+
+HeuristicCache::Entry *HeuristicCache::lookup(
+    int level, const State &state, bool need_preferred_operators) {
+    ++lookups;
+    compute_key(level, state);
+    EntryMap::iterator found = entry_map.find(key);
+    if (found == entry_map.end())
+        return 0;
+    EntryList::iterator entry = found->second;
+    if (need_preferred_operators && !entry->second.has_preferred_operators)
+        return 0;
+    ++hits;
+    entries.splice(entries.begin(), entries, entry);
+    return &entry->second;
+}
+
+HeuristicCache::Entry &HeuristicCache::store(int level, const State &state) {
+    compute_key(level, state);
+    EntryMap::iterator found = entry_map.find(key);
+    if (found != entry_map.end()) {
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->second;
+    }
+
+    if (entry_map.size() < capacity) {
+        entries.push_front(make_pair(key, Entry()));
+    } else {
+        // Reuse the least recently used entry.
+        EntryList::iterator last = entries.end();
+        --last;
+        entry_map.erase(last->first);
+        entries.splice(entries.begin(), entries, last);
+        entries.front().first = key;
+    }
+    entry_map[key] = entries.begin();
+    Entry &entry = entries.front().second;
+    entry.has_preferred_operators = false;
+    entry.preferred_operators.clear();
+    return entry;
+}
+
+void HeuristicCache::print_statistics() const {
+    cout << "Heuristic cache: " << hits << " hits in " << lookups
+         << " lookups";
+    if (lookups)
+        cout << " (" << hits * 100.0 / lookups << "%)";
+    cout << ", " << entry_map.size() << " entries" << endl;
+}
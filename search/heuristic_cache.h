@@ -0,0 +1,75 @@
+#ifndef HEURISTIC_CACHE_H
+#define HEURISTIC_CACHE_H
+
+#include <list>
+#include <utility>
+#include <vector>
+#include <ext/hash_map>
+
+class Operator;
+class State;
+
+/*
+  A bounded cache of heuristic values and preferred operators for
+  heuristics whose value only depends on some of the variables. For
+  example, a relaxation heuristic over the abstract operators ignores
+  all variables the abstract operators do not mention, so many states
+  share the same value.
+
+  Entries are keyed by the operator level and the values of the
+  variables that are relevant on that level (see
+  set_relevant_variables). When the cache is full, the least recently
+  used entry is replaced.
+*/
+
+class HeuristicCache {
+public:
+    struct Entry {
+        int value;
+        // Batch evaluations do not compute preferred operators.
+        bool has_preferred_operators;
+        // The operators that are preferred in the states of this entry
+        // if they are applicable. Applicability is not part of the
+        // entry since it may depend on variables outside the key.
+        std::vector<const Operator *> preferred_operators;
+    };
+private:
+    typedef std::vector<int> Key;
+    struct hash_key {
+        size_t operator()(const Key &key) const;
+    };
+    // Most recently used entries first.
+    typedef std::list<std::pair<Key, Entry> > EntryList;
+    typedef __gnu_cxx::hash_map<Key, EntryList::iterator, hash_key> EntryMap;
+
+    int capacity;
+    std::vector<std::vector<int> > relevant_variables;
+    EntryList entries;
+    EntryMap entry_map;
+    Key key; // scratch space for computing keys
+
+    int lookups;
+    int hits;
+
+    void compute_key(int level, const State &state);
+
+    // not implemented
+    HeuristicCache(const HeuristicCache &);
+    HeuristicCache &operator=(const HeuristicCache &);
+public:
+    explicit HeuristicCache(int capacity);
+
+    void set_relevant_variables(int level, const std::vector<int> &vars);
+
+    // Returns the entry for state (and makes it the most recently used
+    // one), or 0 if there is none or if it lacks preferred operators
+    // that are needed.
+    Entry *lookup(int level, const State &state,
+                  bool need_preferred_operators);
+    // Returns the entry for state, creating it if necessary.
+    Entry &store(int level, const State &state);
+
+    void print_statistics() const;
+};
+
+#endif
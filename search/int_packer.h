@@ -0,0 +1,41 @@
+#ifndef INT_PACKER_H
+#define INT_PACKER_H
+
+#include <vector>
+
+/*
+  Utility class to efficiently pack many integer values with small
+  ranges into a compact array of bins. Each value occupies
+  ceil(log2(range)) bits, and no value straddles two bins, so getting
+  and setting a value is a single shift-and-mask operation.
+
+  This is used by the StateRegistry to store the variable values of
+  all registered states in a single contiguous pool.
+*/
+
+class IntPacker {
+    class VariableInfo;
+
+    std::vector<VariableInfo> var_infos;
+    int num_bins;
+
+    int pack_one_bin(const std::vector<int> &ranges,
+                     std::vector<std::vector<int> > &bits_to_vars);
+    void pack_bins(const std::vector<int> &ranges);
+public:
+    typedef unsigned int Bin;
+
+    /*
+      The constructor takes the range for each variable. The domain of
+      variable i is {0, ..., ranges[i] - 1}.
+    */
+    explicit IntPacker(const std::vector<int> &ranges);
+    ~IntPacker();
+
+    int get(const Bin *buffer, int var) const;
+    void set(Bin *buffer, int var, int value) const;
+
+    int get_num_bins() const {return num_bins; }
+};
+
+#endif
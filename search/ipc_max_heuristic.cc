@@ -22,7 +22,7 @@ int IPCMaxHeuristic::compute_heuristic(const State &state) {
     dead_end_reliable = false;
     value = 0;
     for (unsigned int i = 0; i < evaluators.size(); i++) {
-        evaluators[i]->evaluate(state);
+        evaluators[i]->evaluate(state, get_context());
 
         if (evaluators[i]->is_dead_end()) {
             value = numeric_limits<int>::max();
@@ -51,6 +51,13 @@ bool IPCMaxHeuristic::reach_state(const State &parent_state, const Operator &op,
     return result;
 }
 
+bool IPCMaxHeuristic::depends_on_reach_state() const {
+    for (int i = 0; i < evaluators.size(); i++)
+        if (evaluators[i]->depends_on_reach_state())
+            return true;
+    return false;
+}
+
 static ScalarEvaluator *_parse(OptionParser &parser) {
     parser.add_list_option<Heuristic *>("heuristics");
     Heuristic::add_options_to_parser(parser);
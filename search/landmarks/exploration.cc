@@ -1,8 +1,10 @@
 #include "exploration.h"
 #include "../globals.h"
 #include "../operator.h"
+#include "../relaxed_task.h"
 #include "../state.h"
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -29,39 +31,31 @@ using namespace __gnu_cxx;
 // Construction and destruction
 Exploration::Exploration(const Options &opts)
     : Heuristic(opts),
+      relaxed_task(RelaxedTask::get(0, cost_type)),
+      unary_operators(relaxed_task.get_unary_operators(false)),
       did_write_overflow_warning(false) {
     cout << "Initializing Exploration..." << endl;
 
-    // Build propositions.
-    for (int var = 0; var < g_variable_domain.size(); var++) {
-        propositions.push_back(vector<ExProposition>(g_variable_domain[var]));
-        for (int val = 0; val < g_variable_domain[var]; val++) {
-            propositions[var][val].var = var;
-            propositions[var][val].val = val;
-        }
-    }
+    int num_propositions = relaxed_task.get_num_propositions();
+    is_termination_condition.resize(num_propositions, false);
+    prop_h_add_cost.resize(num_propositions, -1);
+    prop_h_max_cost.resize(num_propositions, -1);
+    prop_depth.resize(num_propositions, -1);
+    marked.resize(num_propositions, false);
+    reached_by.resize(num_propositions, NO_OPERATOR);
+
+    int num_unary_operators = unary_operators.size();
+    unsatisfied_preconditions.resize(num_unary_operators, 0);
+    op_h_add_cost.resize(num_unary_operators, 0);
+    op_h_max_cost.resize(num_unary_operators, 0);
+    op_depth.resize(num_unary_operators, -1);
 
     // Build goal propositions.
-    for (int i = 0; i < g_goal.size(); i++) {
-        int var = g_goal[i].first, val = g_goal[i].second;
-        propositions[var][val].is_goal_condition = true;
-        propositions[var][val].is_termination_condition = true;
-        goal_propositions.push_back(&propositions[var][val]);
-        termination_propositions.push_back(&propositions[var][val]);
-    }
+    goal_propositions = relaxed_task.get_goal_propositions();
+    termination_propositions = goal_propositions;
+    for (int i = 0; i < goal_propositions.size(); i++)
+        is_termination_condition[goal_propositions[i]] = true;
 
-    // Build unary operators for operators and axioms.
-    for (int i = 0; i < g_operators.size(); i++)
-        build_unary_operators(g_operators[i]);
-    for (int i = 0; i < g_axioms.size(); i++)
-        build_unary_operators(g_axioms[i]);
-
-    // Cross-reference unary operators.
-    for (int i = 0; i < unary_operators.size(); i++) {
-        ExUnaryOperator *op = &unary_operators[i];
-        for (int j = 0; j < op->precondition.size(); j++)
-            op->precondition[j]->precondition_of.push_back(op);
-    }
     // Set flag that before heuristic values can be used, computation
     // (relaxed exploration) needs to be done
     heuristic_recomputation_needed = true;
@@ -94,86 +88,26 @@ void Exploration::write_overflow_warning() {
 
 void Exploration::set_additional_goals(const std::vector<pair<int, int> > &add_goals) {
     //Clear previous additional goals.
-    for (int i = 0; i < termination_propositions.size(); i++) {
-        int var = termination_propositions[i]->var, val = termination_propositions[i]->val;
-        propositions[var][val].is_termination_condition = false;
-    }
+    for (int i = 0; i < termination_propositions.size(); i++)
+        is_termination_condition[termination_propositions[i]] = false;
     termination_propositions.clear();
-    for (int i = 0; i < g_goal.size(); i++) {
-        int var = g_goal[i].first, val = g_goal[i].second;
-        propositions[var][val].is_termination_condition = true;
-        termination_propositions.push_back(&propositions[var][val]);
+    for (int i = 0; i < goal_propositions.size(); i++) {
+        int prop = goal_propositions[i];
+        is_termination_condition[prop] = true;
+        termination_propositions.push_back(prop);
     }
     // Build new additional goal propositions.
     for (int i = 0; i < add_goals.size(); i++) {
-        int var = add_goals[i].first, val = add_goals[i].second;
-        if (!propositions[var][val].is_goal_condition) {
-            propositions[var][val].is_termination_condition = true;
-            termination_propositions.push_back(&propositions[var][val]);
+        int prop = relaxed_task.get_proposition(add_goals[i].first,
+                                                add_goals[i].second);
+        if (!relaxed_task.is_goal_proposition(prop)) {
+            is_termination_condition[prop] = true;
+            termination_propositions.push_back(prop);
         }
     }
     heuristic_recomputation_needed = true;
 }
 
-void Exploration::build_unary_operators(const Operator &op) {
-    // Note: changed from the original to allow sorting of operator conditions
-    int base_cost = get_adjusted_cost(op);
-    const vector<Prevail> &prevail = op.get_prevail();
-    const vector<PrePost> &pre_post = op.get_pre_post();
-    vector<ExProposition *> precondition;
-    vector<pair<int, int> > precondition_var_vals1;
-
-    for (int i = 0; i < prevail.size(); i++) {
-        assert(prevail[i].var >= 0 && prevail[i].var < g_variable_domain.size());
-        assert(prevail[i].prev >= 0 && prevail[i].prev < g_variable_domain[prevail[i].var]);
-        // precondition.push_back(&propositions[prevail[i].var][prevail[i].prev]);
-        precondition_var_vals1.push_back(make_pair(prevail[i].var, prevail[i].prev));
-    }
-    for (int i = 0; i < pre_post.size(); i++) {
-        if (pre_post[i].pre != -1) {
-            assert(pre_post[i].var >= 0 && pre_post[i].var < g_variable_domain.size());
-            assert(pre_post[i].pre >= 0 && pre_post[i].pre < g_variable_domain[pre_post[i].var]);
-            // precondition.push_back(&propositions[pre_post[i].var][pre_post[i].pre]);
-            precondition_var_vals1.push_back(make_pair(pre_post[i].var, pre_post[i].pre));
-        }
-    }
-    for (int i = 0; i < pre_post.size(); i++) {
-        vector<pair<int, int> > precondition_var_vals2(precondition_var_vals1);
-        assert(pre_post[i].var >= 0 && pre_post[i].var < g_variable_domain.size());
-        assert(pre_post[i].post >= 0 && pre_post[i].post < g_variable_domain[pre_post[i].var]);
-        ExProposition *effect = &propositions[pre_post[i].var][pre_post[i].post];
-        const vector<Prevail> &eff_cond = pre_post[i].cond;
-        for (int j = 0; j < eff_cond.size(); j++) {
-            assert(eff_cond[j].var >= 0 && eff_cond[j].var < g_variable_domain.size());
-            assert(eff_cond[j].prev >= 0 && eff_cond[j].prev < g_variable_domain[eff_cond[j].var]);
-            // precondition.push_back(&propositions[eff_cond[j].var][eff_cond[j].prev]);
-            precondition_var_vals2.push_back(make_pair(eff_cond[j].var, eff_cond[j].prev));
-        }
-
-        sort(precondition_var_vals2.begin(), precondition_var_vals2.end());
-
-        for (int j = 0; j < precondition_var_vals2.size(); j++)
-            precondition.push_back(&propositions[precondition_var_vals2[j].first]
-                                   [precondition_var_vals2[j].second]);
-
-        unary_operators.push_back(ExUnaryOperator(precondition, effect, &op, base_cost));
-        // precondition.erase(precondition.end() - eff_cond.size(), precondition.end());
-        precondition.clear();
-        precondition_var_vals2.clear();
-    }
-}
-
-class hash_unary_operator {
-public:
-    size_t operator()(const pair<vector<ExProposition *>, ExProposition *> &key) const {
-        unsigned long hash_value = reinterpret_cast<unsigned long>(key.second);
-        const vector<ExProposition *> &vec = key.first;
-        for (int i = 0; i < vec.size(); i++)
-            hash_value = 17 * hash_value + reinterpret_cast<unsigned long>(vec[i]);
-        return size_t(hash_value);
-    }
-};
-
 // heuristic computation
 void Exploration::setup_exploration_queue(const State &state,
                                           const vector<pair<int, int> > &excluded_props,
@@ -182,118 +116,116 @@ void Exploration::setup_exploration_queue(const State &state,
                                           bool use_h_max = false) {
     prop_queue.clear();
 
-    for (int var = 0; var < propositions.size(); var++) {
-        for (int value = 0; value < propositions[var].size(); value++) {
-            ExProposition &prop = propositions[var][value];
-            prop.h_add_cost = -1;
-            prop.h_max_cost = -1;
-            prop.depth = -1;
-            prop.marked = false;
-        }
-    }
+    fill(prop_h_add_cost.begin(), prop_h_add_cost.end(), -1);
+    fill(prop_h_max_cost.begin(), prop_h_max_cost.end(), -1);
+    fill(prop_depth.begin(), prop_depth.end(), -1);
+    fill(marked.begin(), marked.end(), false);
     if (excluded_props.size() > 0) {
         for (unsigned i = 0; i < excluded_props.size(); i++) {
-            ExProposition &prop = propositions[excluded_props[i].first][excluded_props[i].second];
-            prop.h_add_cost = -2;
+            int prop = relaxed_task.get_proposition(excluded_props[i].first,
+                                                    excluded_props[i].second);
+            prop_h_add_cost[prop] = EXCLUDED;
         }
     }
 
     // Deal with current state.
-    for (int var = 0; var < propositions.size(); var++) {
-        ExProposition *init_prop = &propositions[var][state[var]];
-        enqueue_if_necessary(init_prop, 0, 0, 0, use_h_max);
+    for (int var = 0; var < g_variable_domain.size(); var++) {
+        int init_prop = relaxed_task.get_proposition(var, state[var]);
+        enqueue_if_necessary(init_prop, 0, 0, NO_OPERATOR, use_h_max);
     }
 
     // Initialize operator data, deal with precondition-free operators/axioms.
-    for (int i = 0; i < unary_operators.size(); i++) {
-        ExUnaryOperator &op = unary_operators[i];
-        op.unsatisfied_preconditions = op.precondition.size();
-        if (excluded_ops.size() > 0 && (op.effect->h_add_cost == -2 ||
-                                        excluded_ops.find(op.op) != excluded_ops.end())) {
-            op.h_add_cost = -2; // operator will not be applied during relaxed exploration
+    const UnaryOperators &ops = unary_operators;
+    for (int op = 0; op < ops.size(); op++) {
+        unsatisfied_preconditions[op] = ops.num_preconditions[op];
+        if (excluded_ops.size() > 0 &&
+            (prop_h_add_cost[ops.effect[op]] == EXCLUDED ||
+             excluded_ops.find(ops.op[op]) != excluded_ops.end())) {
+            // operator will not be applied during relaxed exploration
+            op_h_add_cost[op] = EXCLUDED;
             continue;
         }
-        op.h_add_cost = op.base_cost; // will be increased by precondition costs
-        op.h_max_cost = op.base_cost;
-        op.depth = -1;
-
-        if (op.unsatisfied_preconditions == 0) {
-            op.depth = 0;
-            int depth = op.op->is_axiom() ? 0 : 1;
-            enqueue_if_necessary(op.effect, op.base_cost, depth, &op, use_h_max);
+        op_h_add_cost[op] = ops.base_cost[op]; // will be increased by precondition costs
+        op_h_max_cost[op] = ops.base_cost[op];
+        op_depth[op] = -1;
+
+        if (unsatisfied_preconditions[op] == 0) {
+            op_depth[op] = 0;
+            int depth = ops.op[op]->is_axiom() ? 0 : 1;
+            enqueue_if_necessary(ops.effect[op], ops.base_cost[op], depth, op,
+                                 use_h_max);
         }
     }
 }
 
 void Exploration::relaxed_exploration(bool use_h_max = false, bool level_out = false) {
+    const UnaryOperators &ops = unary_operators;
     int unsolved_goals = termination_propositions.size();
     while (!prop_queue.empty()) {
-        pair<int, ExProposition *> top_pair = prop_queue.pop();
+        pair<int, int> top_pair = prop_queue.pop();
         int distance = top_pair.first;
-        ExProposition *prop = top_pair.second;
+        int prop = top_pair.second;
 
         int prop_cost;
         if (use_h_max)
-            prop_cost = prop->h_max_cost;
+            prop_cost = prop_h_max_cost[prop];
         else
-            prop_cost = prop->h_add_cost;
+            prop_cost = prop_h_add_cost[prop];
         assert(prop_cost <= distance);
         if (prop_cost < distance)
             continue;
-        if (!level_out && prop->is_termination_condition && --unsolved_goals == 0)
+        if (!level_out && is_termination_condition[prop] && --unsolved_goals == 0)
             return;
-        const vector<ExUnaryOperator *> &triggered_operators = prop->precondition_of;
-        for (int i = 0; i < triggered_operators.size(); i++) {
-            ExUnaryOperator *unary_op = triggered_operators[i];
-            if (unary_op->h_add_cost == -2) // operator is not applied
+        for (int i = ops.triggered_begin[prop]; i < ops.triggered_begin[prop + 1]; i++) {
+            int op = ops.triggered[i];
+            if (op_h_add_cost[op] == EXCLUDED) // operator is not applied
                 continue;
-            unary_op->unsatisfied_preconditions--;
-            increase_cost(unary_op->h_add_cost, prop_cost);
-            unary_op->h_max_cost = max(prop_cost + unary_op->base_cost,
-                                       unary_op->h_max_cost);
-            unary_op->depth = max(unary_op->depth, prop->depth);
-            assert(unary_op->unsatisfied_preconditions >= 0);
-            if (unary_op->unsatisfied_preconditions == 0) {
-                int depth = unary_op->op->is_axiom() ? unary_op->depth : unary_op->depth + 1;
+            unsatisfied_preconditions[op]--;
+            increase_cost(op_h_add_cost[op], prop_cost);
+            op_h_max_cost[op] = max(prop_cost + ops.base_cost[op],
+                                    op_h_max_cost[op]);
+            op_depth[op] = max(op_depth[op], prop_depth[prop]);
+            assert(unsatisfied_preconditions[op] >= 0);
+            if (unsatisfied_preconditions[op] == 0) {
+                int depth = ops.op[op]->is_axiom() ? op_depth[op] : op_depth[op] + 1;
                 if (use_h_max)
-                    enqueue_if_necessary(unary_op->effect, unary_op->h_max_cost,
-                                         depth, unary_op, use_h_max);
+                    enqueue_if_necessary(ops.effect[op], op_h_max_cost[op],
+                                         depth, op, use_h_max);
                 else
-                    enqueue_if_necessary(unary_op->effect, unary_op->h_add_cost,
-                                         depth, unary_op, use_h_max);
+                    enqueue_if_necessary(ops.effect[op], op_h_add_cost[op],
+                                         depth, op, use_h_max);
             }
         }
     }
 }
 
-void Exploration::enqueue_if_necessary(ExProposition *prop, int cost, int depth,
-                                       ExUnaryOperator *op,
+void Exploration::enqueue_if_necessary(int prop, int cost, int depth, int op,
                                        bool use_h_max) {
     assert(cost >= 0);
-    if (use_h_max && (prop->h_max_cost == -1 || prop->h_max_cost > cost)) {
-        prop->h_max_cost = cost;
-        prop->depth = depth;
-        prop->reached_by = op;
+    if (use_h_max && (prop_h_max_cost[prop] == -1 || prop_h_max_cost[prop] > cost)) {
+        prop_h_max_cost[prop] = cost;
+        prop_depth[prop] = depth;
+        reached_by[prop] = op;
         prop_queue.push(cost, prop);
-    } else if (!use_h_max && (prop->h_add_cost == -1 || prop->h_add_cost > cost)) {
-        prop->h_add_cost = cost;
-        prop->depth = depth;
-        prop->reached_by = op;
+    } else if (!use_h_max && (prop_h_add_cost[prop] == -1 || prop_h_add_cost[prop] > cost)) {
+        prop_h_add_cost[prop] = cost;
+        prop_depth[prop] = depth;
+        reached_by[prop] = op;
         prop_queue.push(cost, prop);
     }
     if (use_h_max)
-        assert(prop->h_max_cost != -1 &&
-               prop->h_max_cost <= cost);
+        assert(prop_h_max_cost[prop] != -1 &&
+               prop_h_max_cost[prop] <= cost);
     else
-        assert(prop->h_add_cost != -1 &&
-               prop->h_add_cost <= cost);
+        assert(prop_h_add_cost[prop] != -1 &&
+               prop_h_add_cost[prop] <= cost);
 }
 
 
 int Exploration::compute_hsp_add_heuristic() {
     int total_cost = 0;
     for (int i = 0; i < goal_propositions.size(); i++) {
-        int prop_cost = goal_propositions[i]->h_add_cost;
+        int prop_cost = prop_h_add_cost[goal_propositions[i]];
         if (prop_cost == -1)
             return DEAD_END;
         increase_cost(total_cost, prop_cost);
@@ -305,7 +237,7 @@ int Exploration::compute_hsp_max_heuristic() {
 /* Note: this function is currently not used */
     int maximal_cost = 0;
     for (int i = 0; i < goal_propositions.size(); i++) {
-        int prop_cost = goal_propositions[i]->h_max_cost;
+        int prop_cost = prop_h_max_cost[goal_propositions[i]];
         if (prop_cost == -1)
             return DEAD_END;
         maximal_cost = max(maximal_cost, prop_cost);
@@ -339,24 +271,26 @@ int Exploration::compute_ff_heuristic(const State &state) {
     }
 }
 
-void Exploration::collect_relaxed_plan(ExProposition *goal,
+void Exploration::collect_relaxed_plan(int goal,
                                        RelaxedPlan &relaxed_plan, const State &state) {
-    if (!goal->marked) { // Only consider each subgoal once.
-        goal->marked = true;
-        ExUnaryOperator *unary_op = goal->reached_by;
-        if (unary_op) { // We have not yet chained back to a start node.
-            for (int i = 0; i < unary_op->precondition.size(); i++)
-                collect_relaxed_plan(unary_op->precondition[i], relaxed_plan, state);
-            const Operator *op = unary_op->op;
+    if (!marked[goal]) { // Only consider each subgoal once.
+        marked[goal] = true;
+        int unary_op = reached_by[goal];
+        if (unary_op != NO_OPERATOR) { // We have not yet chained back to a start node.
+            const UnaryOperators &ops = unary_operators;
+            for (int i = ops.precondition_begin[unary_op];
+                 i < ops.precondition_begin[unary_op + 1]; i++)
+                collect_relaxed_plan(ops.preconditions[i], relaxed_plan, state);
+            const Operator *op = ops.op[unary_op];
             bool added_to_relaxed_plan = false;
             //if(!op->is_axiom()) // Using axioms in the relaxed plan actually
             //improves performance in many domains... We need to look into this.
             added_to_relaxed_plan = relaxed_plan.insert(op).second;
 
-            assert(unary_op->depth != -1);
+            assert(op_depth[unary_op] != -1);
             if (added_to_relaxed_plan
-                && unary_op->h_add_cost == unary_op->base_cost
-                && unary_op->depth == 0
+                && op_h_add_cost[unary_op] == ops.base_cost[unary_op]
+                && op_depth[unary_op] == 0
                 && !op->is_axiom()) {
                 set_preferred(op);
                 assert(op->is_applicable(state));
@@ -376,45 +310,41 @@ void Exploration::compute_reachability_with_excludes(vector<vector<int> > &lvl_v
     relaxed_exploration(true, level_out);
 
     // Copy reachability information into lvl_var and lvl_op
-    for (int var = 0; var < propositions.size(); var++) {
-        for (int value = 0; value < propositions[var].size(); value++) {
-            ExProposition &prop = propositions[var][value];
-            if (prop.h_max_cost >= 0)
-                lvl_var[var][value] = prop.h_max_cost;
-        }
+    for (int prop = 0; prop < relaxed_task.get_num_propositions(); prop++) {
+        if (prop_h_max_cost[prop] >= 0)
+            lvl_var[relaxed_task.get_var(prop)][relaxed_task.get_value(prop)] =
+                prop_h_max_cost[prop];
     }
     if (compute_lvl_ops) {
-        hash_map< const Operator *, int, ex_hash_operator_ptr> operator_index;
-        for (int i = 0; i < g_operators.size(); i++) {
-            operator_index.insert(make_pair(&g_operators[i], i));
-        }
-        int offset = g_operators.size();
-        for (int i = 0; i < g_axioms.size(); i++) {
-            operator_index.insert(make_pair(&g_axioms[i], i + offset));
-        }
-        for (int i = 0; i < unary_operators.size(); i++) {
-            ExUnaryOperator &op = unary_operators[i];
+        const UnaryOperators &ops = unary_operators;
+        for (int op = 0; op < ops.size(); op++) {
             // H_max_cost of operator might be wrongly 0 or 1, if the operator
             // did not get applied during relaxed exploration. Look through
             // preconditions and adjust.
-            for (int i = 0; i < op.precondition.size(); i++) {
-                ExProposition *prop = op.precondition[i];
-                if (prop->h_max_cost == -1) {
+            for (int i = ops.precondition_begin[op];
+                 i < ops.precondition_begin[op + 1]; i++) {
+                int prop = ops.preconditions[i];
+                if (prop_h_max_cost[prop] == -1) {
                     // Operator cannot be applied due to unreached precondition
-                    op.h_max_cost = numeric_limits<int>::max();
+                    op_h_max_cost[op] = numeric_limits<int>::max();
                     break;
-                } else if (op.h_max_cost < prop->h_max_cost + op.base_cost)
-                    op.h_max_cost = prop->h_max_cost + op.base_cost;
+                } else if (op_h_max_cost[op] < prop_h_max_cost[prop] + ops.base_cost[op])
+                    op_h_max_cost[op] = prop_h_max_cost[prop] + ops.base_cost[op];
             }
-            if (op.h_max_cost == numeric_limits<int>::max())
+            if (op_h_max_cost[op] == numeric_limits<int>::max())
                 break;
-            int op_index = operator_index[op.op];
+            // Operators are followed by axioms in lvl_op.
+            int op_index = ops.operator_no[op];
+            if (op_index == -1)
+                op_index = g_operators.size() + (ops.op[op] - &g_axioms[0]);
             // We subtract 1 to keep semantics for landmark code:
             // if op can achieve prop at time step i+1,
             // its index (for prop) is i, where the initial state is time step 0.
-            pair<int, int> effect = make_pair(op.effect->var, op.effect->val);
+            int effect_prop = ops.effect[op];
+            pair<int, int> effect = make_pair(relaxed_task.get_var(effect_prop),
+                                              relaxed_task.get_value(effect_prop));
             assert(lvl_op[op_index].find(effect) != lvl_op[op_index].end());
-            int new_lvl = op.h_max_cost - 1;
+            int new_lvl = op_h_max_cost[op] - 1;
             // If we have found a cheaper achieving operator, adjust h_max cost of proposition.
             if (lvl_op[op_index].find(effect)->second > new_lvl)
                 lvl_op[op_index].find(effect)->second = new_lvl;
@@ -437,22 +367,24 @@ int Exploration::compute_heuristic(const State &state) {
 }
 
 
-void Exploration::collect_ha(ExProposition *goal,
+void Exploration::collect_ha(int goal,
                              RelaxedPlan &relaxed_plan, const State &state) {
     // This is the same as collect_relaxed_plan, except that preferred operators
     // are saved in exported_ops rather than preferred_operators
 
-    ExUnaryOperator *unary_op = goal->reached_by;
-    if (unary_op) { // We have not yet chained back to a start node.
-        for (int i = 0; i < unary_op->precondition.size(); i++)
-            collect_ha(unary_op->precondition[i], relaxed_plan, state);
-        const Operator *op = unary_op->op;
+    int unary_op = reached_by[goal];
+    if (unary_op != NO_OPERATOR) { // We have not yet chained back to a start node.
+        const UnaryOperators &ops = unary_operators;
+        for (int i = ops.precondition_begin[unary_op];
+             i < ops.precondition_begin[unary_op + 1]; i++)
+            collect_ha(ops.preconditions[i], relaxed_plan, state);
+        const Operator *op = ops.op[unary_op];
         bool added_to_relaxed_plan = false;
         if (!op->is_axiom())
             added_to_relaxed_plan = relaxed_plan.insert(op).second;
         if (added_to_relaxed_plan
-            && unary_op->h_add_cost == unary_op->base_cost
-            && unary_op->depth == 0
+            && op_h_add_cost[unary_op] == ops.base_cost[unary_op]
+            && op_depth[unary_op] == 0
             && !op->is_axiom()) {
             exported_ops.push_back(op); // This is a helpful action.
             assert(op->is_applicable(state));
@@ -478,20 +410,21 @@ bool Exploration::plan_for_disj(vector<pair<int, int> > &landmarks,
             prepare_heuristic_computation(state);
         }
         int min_cost = numeric_limits<int>::max();
-        ExProposition *target = NULL;
+        int target = -1;
         for (int i = 0; i < termination_propositions.size(); i++) {
-            const int prop_cost = termination_propositions[i]->h_add_cost;
-            if (prop_cost == -1 && is_landmark(landmarks, termination_propositions[i]->var,
-                                               termination_propositions[i]->val)) {
+            int prop = termination_propositions[i];
+            const int prop_cost = prop_h_add_cost[prop];
+            int var = relaxed_task.get_var(prop);
+            int val = relaxed_task.get_value(prop);
+            if (prop_cost == -1 && is_landmark(landmarks, var, val)) {
                 return false; // dead end
             }
-            if (prop_cost < min_cost && is_landmark(landmarks, termination_propositions[i]->var,
-                                                    termination_propositions[i]->val)) {
-                target = termination_propositions[i];
+            if (prop_cost < min_cost && is_landmark(landmarks, var, val)) {
+                target = prop;
                 min_cost = prop_cost;
             }
         }
-        assert(target != NULL);
+        assert(target != -1);
         assert(exported_ops.empty());
         collect_ha(target, relaxed_plan, state);
     } else {
@@ -500,7 +433,7 @@ bool Exploration::plan_for_disj(vector<pair<int, int> > &landmarks,
             prepare_heuristic_computation(state);
         }
         for (int i = 0; i < goal_propositions.size(); i++) {
-            if (goal_propositions[i]->h_add_cost == -1)
+            if (prop_h_add_cost[goal_propositions[i]] == -1)
                 return false;  // dead end
             collect_ha(goal_propositions[i], relaxed_plan, state);
         }
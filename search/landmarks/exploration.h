@@ -12,72 +12,9 @@
 #include <cassert>
 
 class Operator;
+class RelaxedTask;
 class State;
-
-class ExProposition;
-class ExUnaryOperator;
-
-struct ExProposition {
-    int var;
-    int val;
-    bool is_goal_condition;
-    bool is_termination_condition;
-    std::vector<ExUnaryOperator *> precondition_of;
-
-    int h_add_cost;
-    int h_max_cost;
-    int depth;
-    bool marked; // used when computing preferred operators
-    ExUnaryOperator *reached_by;
-
-    ExProposition() {
-        is_goal_condition = false;
-        is_termination_condition = false;
-        h_add_cost = -1;
-        h_max_cost = -1;
-        reached_by = 0;
-        marked = false;
-    }
-
-    bool operator<(const ExProposition &other) const {
-        return var < other.var || (var == other.var && val < other.val);
-    }
-};
-
-struct ExUnaryOperator {
-    const Operator *op;
-    std::vector<ExProposition *> precondition;
-    ExProposition *effect;
-    int base_cost; // 0 for axioms, 1 for regular operators
-
-    int unsatisfied_preconditions;
-    int h_add_cost;
-    int h_max_cost;
-    int depth;
-    ExUnaryOperator(const std::vector<ExProposition *> &pre, ExProposition *eff,
-                    const Operator *the_op, int base)
-        : op(the_op), precondition(pre), effect(eff), base_cost(base) {}
-
-
-    bool operator<(const ExUnaryOperator &other) const {
-        if (*(other.effect) < *effect)
-            return false;
-        else if (*effect < *(other.effect))
-            return true;
-
-        else {
-            int i = 0;
-            while (i != precondition.size()) {
-                if (i == other.precondition.size() || *(other.precondition[i]) < *(precondition[i]))
-                    return false;
-                else if (*(precondition[i]) < *(other.precondition[i]))
-                    return true;
-                i++;
-            }
-            return true;
-        }
-    }
-};
+struct UnaryOperators;
 
 struct ex_hash_operator_ptr {
     size_t operator()(const Operator *key) const {
@@ -85,24 +22,44 @@ struct ex_hash_operator_ptr {
     }
 };
 
+/*
+  The explorations run on the unary operators of the shared relaxed
+  task (see relaxed_task.h), without simplification. All data of the
+  current exploration is kept in the arrays below, indexed by
+  proposition or unary operator.
+*/
 class Exploration : public Heuristic {
     static const int MAX_COST_VALUE = 100000000; // See additive_heuristic.h.
+    static const int NO_OPERATOR = -1;
+    // h_add_cost of excluded propositions and unary operators.
+    static const int EXCLUDED = -2;
 
     typedef __gnu_cxx::hash_set<const Operator *, ex_hash_operator_ptr> RelaxedPlan;
     RelaxedPlan relaxed_plan;
-    std::vector<ExUnaryOperator> unary_operators;
-    std::vector<std::vector<ExProposition> > propositions;
-    std::vector<ExProposition *> goal_propositions;
-    std::vector<ExProposition *> termination_propositions;
-
-    AdaptiveQueue<ExProposition *> prop_queue;
+    const RelaxedTask &relaxed_task;
+    const UnaryOperators &unary_operators;
+    std::vector<int> goal_propositions;
+    std::vector<int> termination_propositions;
+
+    // Data of the current exploration, indexed by proposition.
+    std::vector<char> is_termination_condition;
+    std::vector<int> prop_h_add_cost;
+    std::vector<int> prop_h_max_cost;
+    std::vector<int> prop_depth;
+    std::vector<char> marked; // used when computing preferred operators
+    std::vector<int> reached_by; // unary operator or NO_OPERATOR
+
+    // Data of the current exploration, indexed by unary operator.
+    std::vector<int> unsatisfied_preconditions;
+    std::vector<int> op_h_add_cost;
+    std::vector<int> op_h_max_cost;
+    std::vector<int> op_depth;
+
+    AdaptiveQueue<int> prop_queue;
     bool did_write_overflow_warning;
 
     bool heuristic_recomputation_needed;
 
-    void build_unary_operators(const Operator &op);
-    void simplify();
-
     void setup_exploration_queue(const State &state,
                                  const std::vector<std::pair<int, int> > &excluded_props,
                                  const __gnu_cxx::hash_set<const Operator *,
@@ -115,15 +72,15 @@ class Exploration : public Heuristic {
     }
     void relaxed_exploration(bool use_h_max, bool level_out);
     void prepare_heuristic_computation(const State &state, bool h_max);
-    void collect_relaxed_plan(ExProposition *goal, RelaxedPlan &relaxed_plan, const State &state);
+    void collect_relaxed_plan(int goal, RelaxedPlan &relaxed_plan, const State &state);
 
     int compute_hsp_add_heuristic();
     int compute_hsp_max_heuristic();
     int compute_ff_heuristic(const State &state);
 
-    void collect_ha(ExProposition *goal, RelaxedPlan &relaxed_plan, const State &state);
+    void collect_ha(int goal, RelaxedPlan &relaxed_plan, const State &state);
 
-    void enqueue_if_necessary(ExProposition *prop, int cost, int depth, ExUnaryOperator *op,
+    void enqueue_if_necessary(int prop, int cost, int depth, int op,
                               bool use_h_max);
     void increase_cost(int &cost, int amount);
     void write_overflow_warning();
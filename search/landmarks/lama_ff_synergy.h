@@ -49,6 +49,7 @@ public:
                                  const State &state) {
             return synergy->lama_reach_state(parent_state, op, state);
         }
+        virtual bool depends_on_reach_state() const {return true; }
     };
 
     friend class HeuristicProxy;
@@ -1,5 +1,8 @@
 #include "landmark_status_manager.h"
 
+#include "../globals.h"
+#include "../state_registry.h"
+
 using namespace __gnu_cxx;
 
 LandmarkStatusManager::LandmarkStatusManager(LandmarkGraph &graph)
@@ -16,10 +19,7 @@ void LandmarkStatusManager::clear_reached() {
 }
 
 vector<bool> &LandmarkStatusManager::get_reached_landmarks(const State &state) {
-    StateProxy proxy = StateProxy(&state);
-
-    //assert(reached_lms.find(proxy) != reached_lms.end());
-    return reached_lms[proxy];
+    return reached_lms[g_state_registry->get_id(state)];
 }
 
 
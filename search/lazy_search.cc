@@ -2,6 +2,7 @@
 
 #include "g_evaluator.h"
 #include "heuristic.h"
+#include "state_registry.h"
 #include "successor_generator.h"
 #include "sum_evaluator.h"
 #include "weighted_evaluator.h"
@@ -22,7 +23,7 @@ LazySearch::LazySearch(const Options &opts)
       reopen_closed_nodes(opts.get<bool>("reopen_closed")),
       succ_mode(pref_first),
       current_state(*g_initial_state),
-      current_predecessor_buffer(NULL),
+      current_predecessor_id(StateID::no_state),
       current_operator(NULL),
       current_g(0),
       current_real_g(0),
@@ -60,14 +61,14 @@ void LazySearch::initialize() {
     assert(!heuristics.empty());
 }
 
-void LazySearch::get_successor_operators(vector<const Operator *> &ops) {
-    vector<const Operator *> all_operators;
-    vector<const Operator *> preferred_operators;
+void LazySearch::get_successor_operators(const EvaluationContext &context,
+                                         vector<const Operator *> &ops) {
+    all_operators.clear();
+    preferred_operators.clear();
+    preferred_operator_marks.clear();
 
-	/*BEGIN MOISES*/
-	operator_level = ((g_use_abstractions) && (current_g > g_horizon)) ? 1:0;
-	g_successor_generators[operator_level]->generate_applicable_ops(current_state, all_operators);
-	/*END MOISES*/
+    context.get_successor_generator()->generate_applicable_ops(
+        current_state, all_operators);
 
    for (int i = 0; i < preferred_operator_heuristics.size(); i++) {
         Heuristic *heur = preferred_operator_heuristics[i];
@@ -77,44 +78,40 @@ void LazySearch::get_successor_operators(vector<const Operator *> &ops) {
 
    if (succ_mode == pref_first) {
 	for (int i = 0; i < preferred_operators.size(); i++) {
-            if (!preferred_operators[i]->is_marked()) {
+            if (preferred_operator_marks.insert(preferred_operators[i]))
                 ops.push_back(preferred_operators[i]);
-                preferred_operators[i]->mark();
-            }
         }
 
         for (int i = 0; i < all_operators.size(); i++)
-            if (!all_operators[i]->is_marked())
+            if (!preferred_operator_marks.contains(all_operators[i]))
                 ops.push_back(all_operators[i]);
 	} else {
         for (int i = 0; i < preferred_operators.size(); i++)
-            if (!preferred_operators[i]->is_marked())
-                preferred_operators[i]->mark();
+            preferred_operator_marks.insert(preferred_operators[i]);
         ops.swap(all_operators);
         if (succ_mode == shuffled)
             random_shuffle(ops.begin(), ops.end());
     }
 }
 
-void LazySearch::generate_successors() {
-    vector<const Operator *> operators;
-    get_successor_operators(operators);
+void LazySearch::generate_successors(const EvaluationContext &context) {
+    vector<const Operator *> &operators = successor_operators;
+    operators.clear();
+    get_successor_operators(context, operators);
 
     search_progress.inc_generated(operators.size());
-    state_var_t *current_state_buffer =
-        search_space.get_node(current_state).get_state_buffer();
+    StateID current_state_id =
+        search_space.get_node(current_state).get_state_id();
 
     for (int i = 0; i < operators.size(); i++) {
     
         int new_g = current_g + get_adjusted_cost(*operators[i]);
         int new_real_g = current_real_g + operators[i]->get_cost();
 
-        bool is_preferred = operators[i]->is_marked();
-        if (is_preferred)
-            operators[i]->unmark();
+        bool is_preferred = preferred_operator_marks.contains(operators[i]);
         if (new_real_g < bound) {
             open_list->evaluate(new_g, is_preferred);
-            open_list->insert(make_pair(current_state_buffer, operators[i]));
+            open_list->insert(make_pair(current_state_id, operators[i]));
         }
     }
 }
@@ -127,14 +124,15 @@ int LazySearch::fetch_next_state() {
 
     OpenListEntryLazy next = open_list->remove_min();
 
-    current_predecessor_buffer = next.first;
+    current_predecessor_id = next.first;
     current_operator = next.second;
 
-    State current_predecessor(current_predecessor_buffer);
+    SearchNode pred_node = search_space.get_node(current_predecessor_id);
+    State current_predecessor = pred_node.get_state();
     assert(current_operator->is_applicable(current_predecessor));
-    current_state = State(current_predecessor, *current_operator);
+    current_state = g_state_registry->get_successor_state(current_predecessor,
+                                                          *current_operator);
 
-    SearchNode pred_node = search_space.get_node(current_predecessor);
     current_g = pred_node.get_g() + get_adjusted_cost(*current_operator);
     current_real_g = pred_node.get_real_g() + current_operator->get_cost();
 
@@ -154,22 +152,23 @@ int LazySearch::step() {
     bool reopen = reopen_closed_nodes && (current_g < node.get_g()) && !node.is_dead_end() && !node.is_new();
 
     if (node.is_new() || reopen) {
-        state_var_t *dummy_address = current_predecessor_buffer;
+        StateID parent_id = current_predecessor_id;
         // HACK! HACK! we do this because SearchNode has no default/copy constructor
-        if (dummy_address == NULL) {
-            dummy_address = const_cast<state_var_t *>(g_initial_state->get_buffer());
+        if (parent_id == StateID::no_state) {
+            parent_id = search_space.get_node(*g_initial_state).get_state_id();
         }
 
-        SearchNode parent_node = search_space.get_node(State(dummy_address));
-        const State perm_state = node.get_state();
+        SearchNode parent_node = search_space.get_node(parent_id);
+        const State parent_state = parent_node.get_state();
+        EvaluationContext context = EvaluationContext::for_g(current_g);
 
         for (int i = 0; i < heuristics.size(); i++) {           
 								
 				if (current_operator != NULL) {
-                heuristics[i]->reach_state(parent_node.get_state(), *current_operator, perm_state);
+                heuristics[i]->reach_state(parent_state, *current_operator, current_state);
             }	
             
-				heuristics[i]->evaluate(current_state);
+				heuristics[i]->evaluate(current_state, context);
 		  }
 
         search_progress.inc_evaluated_states();
@@ -193,7 +192,7 @@ int LazySearch::step() {
 				//cout << "reopen" << endl;
                 node.reopen(parent_node, current_operator);
                 search_progress.inc_reopened();
-            } else if (current_predecessor_buffer == NULL) {
+            } else if (current_predecessor_id == StateID::no_state) {
 				//cout << "open inicial" << endl;                
 				node.open_initial(h);
                 search_progress.get_initial_h_values();
@@ -209,7 +208,7 @@ int LazySearch::step() {
                 reward_progress();
             }
 
-            generate_successors();
+            generate_successors(context);
 
             search_progress.inc_expanded();
         } else {
@@ -229,6 +228,11 @@ void LazySearch::statistics() const {
     search_progress.print_statistics();
 }
 
+void LazySearch::heuristic_statistics() const {
+    for (size_t i = 0; i < heuristics.size(); ++i)
+        heuristics[i]->print_statistics();
+}
+
 static SearchEngine *_parse(OptionParser &parser) {
     Plugin<OpenList<OpenListEntryLazy > >::register_open_lists();
     parser.add_option<OpenList<OpenListEntryLazy> *>("open");
@@ -252,6 +256,13 @@ static SearchEngine *_parse(OptionParser &parser) {
 }
 
 
+static OpenList<OpenListEntryLazy> *create_scalar_open_list(
+    ScalarEvaluator *eval, bool preferred_only, bool bucket_array) {
+    if (bucket_array)
+        return new BucketArrayOpenList<OpenListEntryLazy>(eval, preferred_only);
+    return new StandardScalarOpenList<OpenListEntryLazy>(eval, preferred_only);
+}
+
 static SearchEngine *_parse_greedy(OptionParser &parser) {
     parser.add_list_option<ScalarEvaluator *>("evals");
     parser.add_list_option<Heuristic *>(
@@ -261,6 +272,8 @@ static SearchEngine *_parse_greedy(OptionParser &parser) {
                             "reopen closed nodes");
     parser.add_option<int>("boost", DEFAULT_LAZY_BOOST,
                            "boost value for preferred operator open lists");
+    parser.add_option<bool>("bucket_array", false,
+                            "use bucket array open lists (see single_bucket_array)");
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
 
@@ -270,20 +283,18 @@ static SearchEngine *_parse_greedy(OptionParser &parser) {
             opts.get_list<ScalarEvaluator *>("evals");
         vector<Heuristic *> preferred_list =
             opts.get_list<Heuristic *>("preferred");
+        bool bucket_array = opts.get<bool>("bucket_array");
         OpenList<OpenListEntryLazy> *open;
         if ((evals.size() == 1) && preferred_list.empty()) {
-            open = new StandardScalarOpenList<OpenListEntryLazy>(evals[0],
-                                                                 false);
+            open = create_scalar_open_list(evals[0], false, bucket_array);
         } else {
             vector<OpenList<OpenListEntryLazy> *> inner_lists;
             for (int i = 0; i < evals.size(); i++) {
                 inner_lists.push_back(
-                    new StandardScalarOpenList<OpenListEntryLazy>(evals[i],
-                                                                  false));
+                    create_scalar_open_list(evals[i], false, bucket_array));
                 if (!preferred_list.empty()) {
                     inner_lists.push_back(
-                        new StandardScalarOpenList<OpenListEntryLazy>(evals[i],
-                                                                      true));
+                        create_scalar_open_list(evals[i], true, bucket_array));
                 }
             }
             open = new AlternationOpenList<OpenListEntryLazy>(
@@ -304,6 +315,8 @@ static SearchEngine *_parse_weighted_astar(OptionParser &parser) {
     parser.add_option<bool>("reopen_closed", true, "reopen closed nodes");
     parser.add_option<int>("boost", DEFAULT_LAZY_BOOST,
                            "boost value for preferred operator open lists");
+    parser.add_option<bool>("bucket_array", false,
+                            "use bucket array open lists (see single_bucket_array)");
     parser.add_option<int>("w", 1, "heuristic weight");
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
@@ -315,6 +328,7 @@ static SearchEngine *_parse_weighted_astar(OptionParser &parser) {
         vector<ScalarEvaluator *> evals = opts.get_list<ScalarEvaluator *>("evals");
         vector<Heuristic *> preferred_list =
             opts.get_list<Heuristic *>("preferred");
+        bool bucket_array = opts.get<bool>("bucket_array");
         vector<OpenList<OpenListEntryLazy> *> inner_lists;
         for (int i = 0; i < evals.size(); i++) {
             GEvaluator *g = new GEvaluator();
@@ -331,12 +345,11 @@ static SearchEngine *_parse_weighted_astar(OptionParser &parser) {
             SumEvaluator *f_eval = new SumEvaluator(sum_evals);
 
             inner_lists.push_back(
-                new StandardScalarOpenList<OpenListEntryLazy>(f_eval, false));
+                create_scalar_open_list(f_eval, false, bucket_array));
 
             if (!preferred_list.empty()) {
                 inner_lists.push_back(
-                    new StandardScalarOpenList<OpenListEntryLazy>(f_eval,
-                                                                  true));
+                    create_scalar_open_list(f_eval, true, bucket_array));
             }
         }
         OpenList<OpenListEntryLazy> *open;
@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "evaluation_context.h"
+#include "marked_operators.h"
 #include "open_lists/open_list.h"
 #include "search_engine.h"
 #include "state.h"
@@ -14,7 +16,7 @@ class Heuristic;
 class Operator;
 class Options;
 
-typedef pair<state_var_t *, const Operator *> OpenListEntryLazy;
+typedef pair<StateID, const Operator *> OpenListEntryLazy;
 
 class LazySearch : public SearchEngine {
 protected:
@@ -29,21 +31,28 @@ protected:
     vector<Heuristic *> estimate_heuristics;
 
     State current_state;
-    state_var_t *current_predecessor_buffer;
+    StateID current_predecessor_id;
     const Operator *current_operator;
     int current_g;
     int current_real_g;
     int current_k;
 
+    // Scratch space for expansions, reused across steps.
+    vector<const Operator *> successor_operators;
+    vector<const Operator *> all_operators;
+    vector<const Operator *> preferred_operators;
+    MarkedOperators preferred_operator_marks;
+
     virtual void initialize();
     virtual int step();
 
-    void generate_successors();
+    void generate_successors(const EvaluationContext &context);
     int fetch_next_state();
 
     void reward_progress();
 
-    void get_successor_operators(vector<const Operator *> &ops);
+    void get_successor_operators(const EvaluationContext &context,
+                                 vector<const Operator *> &ops);
 public:
 
     LazySearch(const Options &opts);
@@ -51,6 +60,7 @@ public:
     void set_pref_operator_heuristics(vector<Heuristic *> &heur);
 
     virtual void statistics() const;
+    virtual void heuristic_statistics() const;
 };
 
 #endif
@@ -61,7 +61,7 @@ int MaxHeuristic::compute_heuristic(const State &state) {
 
     for (int i = 0; i < heuristics.size(); i++) {
         //cout << "h[" << i << "] = ";
-        heuristics[i]->evaluate(state);
+        heuristics[i]->evaluate(state, get_context());
         if (heuristics[i]->is_dead_end()) {
             if (heuristics[i]->dead_ends_are_reliable()) {
                 return DEAD_END;
@@ -134,3 +134,10 @@ bool MaxHeuristic::reach_state(const State &parent_state, const Operator &op,
     }
     return ret;
 }
+
+bool MaxHeuristic::depends_on_reach_state() const {
+    for (int i = 0; i < heuristics.size(); i++)
+        if (heuristics[i]->depends_on_reach_state())
+            return true;
+    return false;
+}
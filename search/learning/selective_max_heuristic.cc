@@ -305,7 +305,7 @@ int SelectiveMaxHeuristic::eval_heuristic(const State &state, int index, bool co
         num_evaluated[index]++;
     computed[index] = true;
 
-    heuristics[index]->evaluate(state);
+    heuristics[index]->evaluate(state, get_context());
 
     if (heuristics[index]->is_dead_end()) {
         if (heuristics[index]->dead_ends_are_reliable()) {
@@ -521,6 +521,13 @@ bool SelectiveMaxHeuristic::reach_state(const State &parent_state, const Operato
     return ret;
 }
 
+bool SelectiveMaxHeuristic::depends_on_reach_state() const {
+    for (int i = 0; i < num_heuristics; i++)
+        if (heuristics[i]->depends_on_reach_state())
+            return true;
+    return false;
+}
+
 void SelectiveMaxHeuristic::print_statistics() const {
     cout << "Selective Max Statistics" << endl;
     cout << "Num evals: " << num_evals << endl;
@@ -1,9 +1,11 @@
 #include "lm_cut_heuristic.h"
 
+#include "fast_lm_cut_heuristic.h"
 #include "globals.h"
 #include "operator.h"
 #include "option_parser.h"
 #include "plugin.h"
+#include "relaxed_task.h"
 #include "state.h"
 
 #include <cassert>
@@ -17,7 +19,10 @@ using namespace std;
 
 // construction and destruction
 LandmarkCutHeuristic::LandmarkCutHeuristic(const Options &opts)
-    : Heuristic(opts) {
+    : Heuristic(opts),
+      cut_cache_size(opts.get<int>("cut_cache_size")),
+      reached_parent(StateID::no_state),
+      warm_starts(0), reused_cuts(0), invalidated_cuts(0), fallbacks(0) {
     num_propositions = 2; // artifical goal and artificical precondition
 }
 
@@ -40,8 +45,9 @@ void LandmarkCutHeuristic::initialize() {
     }
 
     // Build relaxed operators for operators and axioms.
-    for (int i = 0; i < g_operators.size(); i++)
-        build_relaxed_operator(g_operators[i]);
+    const RelaxedTask &task = RelaxedTask::get(0, cost_type);
+    for (int i = 0; i < task.get_num_operators(); i++)
+        build_relaxed_operator(task, i);
 
     // Simplify relaxed operators.
     // simplify();
@@ -69,20 +75,27 @@ void LandmarkCutHeuristic::initialize() {
     }
 }
 
-void LandmarkCutHeuristic::build_relaxed_operator(const Operator &op) {
-    const vector<Prevail> &prevail = op.get_prevail();
-    const vector<PrePost> &pre_post = op.get_pre_post();
+Heuristic *LandmarkCutHeuristic::clone() const {
+    // Cut caching depends on reach_state.
+    if (cut_cache_size > 0)
+        return 0;
+    return new LandmarkCutHeuristic(get_options());
+}
+
+void LandmarkCutHeuristic::build_relaxed_operator(const RelaxedTask &task,
+                                                  int op_no) {
     vector<RelaxedProposition *> precondition;
     vector<RelaxedProposition *> effects;
-    for (int i = 0; i < prevail.size(); i++)
-        precondition.push_back(&propositions[prevail[i].var][prevail[i].prev]);
-    for (int i = 0; i < pre_post.size(); i++) {
-        if (pre_post[i].pre != -1)
-            precondition.push_back(&propositions[pre_post[i].var][
-                                       pre_post[i].pre]);
-        effects.push_back(&propositions[pre_post[i].var][pre_post[i].post]);
-    }
-    add_relaxed_operator(precondition, effects, &op, get_adjusted_cost(op));
+    for (vector<int>::const_iterator it = task.preconditions_begin(op_no);
+         it != task.preconditions_end(op_no); ++it)
+        precondition.push_back(&propositions[task.get_var(*it)][
+                                   task.get_value(*it)]);
+    for (vector<int>::const_iterator it = task.effects_begin(op_no);
+         it != task.effects_end(op_no); ++it)
+        effects.push_back(&propositions[task.get_var(*it)][
+                              task.get_value(*it)]);
+    add_relaxed_operator(precondition, effects, &task.get_operator(op_no),
+                         task.get_operator_cost(op_no));
 }
 
 void LandmarkCutHeuristic::add_relaxed_operator(
@@ -266,6 +279,109 @@ void LandmarkCutHeuristic::mark_goal_plateau(RelaxedProposition *subgoal) {
     }
 }
 
+bool LandmarkCutHeuristic::reach_state(const State &parent_state,
+                                       const Operator &op,
+                                       const State &state) {
+    if (cut_cache_size > 0) {
+        if (parent_state.get_id() != reached_parent) {
+            reached_parent = parent_state.get_id();
+            reached_children.clear();
+        }
+        reached_children.push_back(make_pair(state.get_id(), &op));
+    }
+    return false;
+}
+
+int LandmarkCutHeuristic::reuse_parent_cuts(const State &state) {
+    /*
+      Applies the landmarks of the parent of state that are still
+      landmarks of state (see the comment on cut caching in the
+      header) and returns their total cost. Returns 0 if the parent or
+      its landmarks are unknown.
+    */
+    current_landmarks.clear();
+    StateID id = state.get_id();
+    const Operator *generating_op = 0;
+    if (id != StateID::no_state) {
+        for (int i = 0; i < reached_children.size(); i++) {
+            if (reached_children[i].first == id) {
+                generating_op = reached_children[i].second;
+                break;
+            }
+        }
+    }
+    CutCache::const_iterator parent_entry = cut_cache.end();
+    if (generating_op)
+        parent_entry = cut_cache.find(reached_parent);
+    // The generating operator must be one of the task; abstract
+    // operators have no relaxed operators here.
+    int op_no = generating_op - &*g_operators.begin();
+    if (parent_entry == cut_cache.end() ||
+        op_no < 0 || op_no >= g_operators.size() ||
+        relaxed_operators[op_no].op != generating_op) {
+        ++fallbacks;
+        return 0;
+    }
+
+    ++warm_starts;
+    const vector<int> &parent_landmarks = parent_entry->second;
+    int total_cost = 0;
+    for (int i = 0; i < parent_landmarks.size(); ) {
+        int cost = parent_landmarks[i];
+        int size = parent_landmarks[i + 1];
+        const int *ops = &parent_landmarks[i + 2];
+        i += 2 + size;
+        if (find(ops, ops + size, op_no) != ops + size) {
+            ++invalidated_cuts;
+            continue;
+        }
+        ++reused_cuts;
+        current_landmarks.push_back(cost);
+        current_landmarks.push_back(size);
+        for (int j = 0; j < size; j++) {
+            RelaxedOperator &relaxed_op = relaxed_operators[ops[j]];
+            relaxed_op.cost -= cost;
+            assert(relaxed_op.cost >= 0);
+            current_landmarks.push_back(ops[j]);
+        }
+        total_cost += cost;
+    }
+    return total_cost;
+}
+
+void LandmarkCutHeuristic::add_landmark(
+    const vector<RelaxedOperator *> &landmark, int cost) {
+    current_landmarks.push_back(cost);
+    current_landmarks.push_back(landmark.size());
+    for (int i = 0; i < landmark.size(); i++)
+        current_landmarks.push_back(landmark[i] - &relaxed_operators[0]);
+}
+
+void LandmarkCutHeuristic::store_landmarks(const State &state) {
+    StateID id = state.get_id();
+    if (id == StateID::no_state)
+        return;
+    pair<CutCache::iterator, bool> result =
+        cut_cache.insert(make_pair(id, vector<int>()));
+    result.first->second.swap(current_landmarks);
+    if (result.second) {
+        cut_cache_order.push_back(id);
+        if (cut_cache_order.size() > cut_cache_size) {
+            cut_cache.erase(cut_cache_order.front());
+            cut_cache_order.pop_front();
+        }
+    }
+}
+
+void LandmarkCutHeuristic::print_statistics() const {
+    if (cut_cache_size > 0) {
+        cout << "LM-cut cut cache: " << warm_starts << " warm starts, "
+             << reused_cuts << " cut rounds saved, "
+             << invalidated_cuts << " parent cuts invalidated, "
+             << fallbacks << " fallbacks" << endl;
+    }
+}
+
 void LandmarkCutHeuristic::validate_h_max() const {
 #ifndef NDEBUG
     // Using conditional compilation to avoid complaints about unused
@@ -306,13 +422,13 @@ int LandmarkCutHeuristic::compute_heuristic(const State &state) {
 
     //cout << "*" << flush;
     int total_cost = 0;
+    if (cut_cache_size > 0)
+        total_cost = reuse_parent_cuts(state);
 
-    // The following two variables could be declared inside the loop
-    // ("second_exploration_queue" even inside second_exploration),
-    // but having them here saves reallocations and hence provides a
-    // measurable speed boost.
-    vector<RelaxedOperator *> cut;
-    vector<RelaxedProposition *> second_exploration_queue;
+    // "cut" and "second_exploration_queue" are members rather than
+    // local variables because this saves reallocations and hence
+    // provides a measurable speed boost.
+    assert(cut.empty());
     first_exploration(state);
     // validate_h_max();  // too expensive to use even in regular debug mode
     if (artificial_goal.status == UNREACHED)
@@ -359,6 +475,8 @@ int LandmarkCutHeuristic::compute_heuristic(const State &state) {
             cut[i]->cost -= cut_cost;
         //cout << "{" << cut_cost << "}" << flush;
         total_cost += cut_cost;
+        if (cut_cache_size > 0)
+            add_landmark(cut, cut_cost);
 
         first_exploration_incremental(cut);
         // validate_h_max();  // too expensive to use even in regular debug mode
@@ -370,7 +488,8 @@ int LandmarkCutHeuristic::compute_heuristic(const State &state) {
         // TODO: Make this more efficient. For example, we can use
         //       a round-dependent counter for GOAL_ZONE and BEFORE_GOAL_ZONE,
         //       or something based on total_cost, in which case we don't
-        //       need a per-round reinitialization.
+        //       need a per-round reinitialization. (FastLandmarkCutHeuristic
+        //       uses such counters.)
         for (int var = 0; var < propositions.size(); var++) {
             for (int value = 0; value < propositions[var].size(); value++) {
                 RelaxedProposition &prop = propositions[var][value];
@@ -383,9 +502,20 @@ int LandmarkCutHeuristic::compute_heuristic(const State &state) {
     }
     //cout << "[" << total_cost << "]" << flush;
     //cout << "**************************" << endl;
+    if (cut_cache_size > 0)
+        store_landmarks(state);
     return (total_cost + COST_MULTIPLIER - 1) / COST_MULTIPLIER;
 }
 
+void LandmarkCutHeuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &,
+    vector<int> &values) {
+    // LM-cut computes no preferred operators, so there is nothing to
+    // clear between the states.
+    for (int i = 0; i < states.size(); i++)
+        values[i] = compute_heuristic(states[i]);
+}
+
 /* TODO:
    It looks like the change in r3638 reduced the quality of the heuristic
    a bit (at least a preliminary glance at Elevators-03 suggests that).
@@ -398,9 +528,26 @@ int LandmarkCutHeuristic::compute_heuristic(const State &state) {
 
 static ScalarEvaluator *_parse(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
+    parser.add_option<bool>(
+        "fast", false,
+        "use the implementation with flat arrays and status stamps "
+        "(same heuristic values)");
+    parser.add_option<int>(
+        "cut_cache_size", 0,
+        "number of states whose landmarks are kept to warm-start the "
+        "evaluation of their successors (0: no caching). The values stay "
+        "admissible, but may differ from those without caching");
     Options opts = parser.parse();
+    if (!parser.dry_run()) {
+        if (opts.get<int>("cut_cache_size") < 0)
+            parser.error("cut_cache_size must not be negative");
+        if (opts.get<bool>("fast") && opts.get<int>("cut_cache_size") > 0)
+            parser.error("cut caching is not supported with fast=true");
+    }
     if (parser.dry_run())
         return 0;
+    else if (opts.get<bool>("fast"))
+        return new FastLandmarkCutHeuristic(opts);
     else
         return new LandmarkCutHeuristic(opts);
 }
@@ -3,14 +3,19 @@
 
 #include "heuristic.h"
 #include "priority_queue.h"
+#include "state_id.h"
 
 #include <algorithm>
 #include <cassert>
+#include <deque>
+#include <utility>
 #include <vector>
+#include <ext/hash_map>
 
 // TODO: Fix duplication with the other relaxation heuristics.
 
 class Operator;
+class RelaxedTask;
 class State;
 
 class RelaxedProposition;
@@ -111,10 +116,50 @@ class LandmarkCutHeuristic : public Heuristic {
     RelaxedProposition artificial_goal;
     int num_propositions;
     AdaptiveQueue<RelaxedProposition *> priority_queue;
+    // Scratch space for compute_heuristic, kept across calls (and
+    // across the states of a batch) to save reallocations.
+    std::vector<RelaxedOperator *> cut;
+    std::vector<RelaxedProposition *> second_exploration_queue;
+
+    /*
+      Cut caching (cut_cache_size > 0): we keep the landmarks (cuts)
+      found for the most recently evaluated states, together with the
+      costs they were given. A landmark of the parent that does not
+      contain the operator leading to the child is also a landmark of
+      the child (prepending that operator to a relaxed plan of the
+      child gives one of the parent). So we give these landmarks the
+      same costs in the child, which keeps the cost partitioning
+      admissible, and only look for further cuts under the remaining
+      costs.
+
+      The landmarks of a state are stored as a flat list of entries
+      (cost, number of operators, indices into relaxed_operators...).
+    */
+    typedef __gnu_cxx::hash_map<StateID, std::vector<int> > CutCache;
+    int cut_cache_size;
+    CutCache cut_cache;
+    std::deque<StateID> cut_cache_order; // oldest first
+    std::vector<int> current_landmarks;
+    // The successors reported by reach_state since the last change of
+    // parent, with the operators that generated them.
+    StateID reached_parent;
+    std::vector<std::pair<StateID, const Operator *> > reached_children;
+    int warm_starts;
+    int reused_cuts;
+    int invalidated_cuts;
+    int fallbacks;
+
+    int reuse_parent_cuts(const State &state);
+    void add_landmark(const std::vector<RelaxedOperator *> &landmark, int cost);
+    void store_landmarks(const State &state);
 
     virtual void initialize();
     virtual int compute_heuristic(const State &state);
-    void build_relaxed_operator(const Operator &op);
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
+    void build_relaxed_operator(const RelaxedTask &task, int op_no);
     void add_relaxed_operator(const std::vector<RelaxedProposition *> &precondition,
                               const std::vector<RelaxedProposition *> &effects,
                               const Operator *op, int base_cost);
@@ -139,6 +184,11 @@ class LandmarkCutHeuristic : public Heuristic {
 public:
     LandmarkCutHeuristic(const Options &opts);
     virtual ~LandmarkCutHeuristic();
+    virtual Heuristic *clone() const;
+    virtual bool reach_state(const State &parent_state, const Operator &op,
+                             const State &state);
+    virtual bool depends_on_reach_state() const {return cut_cache_size > 0; }
+    virtual void print_statistics() const;
 };
 
 inline void RelaxedOperator::update_h_max_supporter() {
@@ -0,0 +1,48 @@
+#include "marked_operators.h"
+
+#include "globals.h"
+#include "operator.h"
+
+#include <cassert>
+using namespace std;
+
+MarkedOperators::MarkedOperators()
+    : epoch(1),
+      concrete_begin(g_operators.empty() ? 0 : &g_operators[0]),
+      concrete_end(concrete_begin + g_operators.size()),
+      abstract_begin(g_abstract_operators.empty() ? 0 :
+                     &g_abstract_operators[0]) {
+}
+
+int MarkedOperators::get_op_number(const Operator *op) const {
+    if (op >= concrete_begin && op < concrete_end)
+        return op - concrete_begin;
+    assert(abstract_begin && op >= abstract_begin &&
+           op < abstract_begin + g_abstract_operators.size());
+    return (concrete_end - concrete_begin) + (op - abstract_begin);
+}
+
+void MarkedOperators::clear() {
+    ++epoch;
+    if (epoch == 0) {
+        // The epoch counter wrapped around: forget all old stamps.
+        stamps.assign(stamps.size(), 0);
+        epoch = 1;
+    }
+}
+
+bool MarkedOperators::insert(const Operator *op) {
+    if (stamps.empty())
+        stamps.resize(g_operators.size() + g_abstract_operators.size(), 0);
+    unsigned int &stamp = stamps[get_op_number(op)];
+    if (stamp == epoch)
+        return false;
+    stamp = epoch;
+    return true;
+}
+
+bool MarkedOperators::contains(const Operator *op) const {
+    if (stamps.empty())
+        return false;
+    return stamps[get_op_number(op)] == epoch;
+}
@@ -0,0 +1,40 @@
+#ifndef MARKED_OPERATORS_H
+#define MARKED_OPERATORS_H
+
+#include <vector>
+
+class Operator;
+
+/*
+  MarkedOperators is a set of operators (concrete or abstract) used for
+  short-term marking, e.g. of the preferred operators of one expansion.
+  Inserting, testing and clearing all take constant time: we keep one
+  stamp per operator number, and an operator is in the set iff its
+  stamp equals the current epoch, so clear() only has to start a new
+  epoch. The stamps are only allocated by the first insert, so sets
+  that are never used (e.g. the preferred operators of heuristics that
+  do not compute any) cost no memory.
+
+  Operators are numbered by their position in g_operators, followed by
+  the operators in g_abstract_operators. The set must therefore be
+  created after the operators have been read.
+*/
+
+class MarkedOperators {
+    std::vector<unsigned int> stamps;
+    unsigned int epoch;
+    const Operator *concrete_begin;
+    const Operator *concrete_end;
+    const Operator *abstract_begin;
+
+    int get_op_number(const Operator *op) const;
+public:
+    MarkedOperators();
+
+    void clear();
+    // Returns true iff op was not in the set before.
+    bool insert(const Operator *op);
+    bool contains(const Operator *op) const;
+};
+
+#endif
@@ -1,32 +1,31 @@
 #include "max_heuristic.h"
 
+#include "globals.h"
 #include "operator.h"
 #include "option_parser.h"
 #include "plugin.h"
 #include "state.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 using namespace std;
 
-
-
-
 /*
-  TODO: At the time of this writing, this shares huge amounts of code
-        with h^add, and the two should be refactored so that the
-        common code is only included once, in so far as this is
-        possible without sacrificing run-time. We may want to avoid
-        virtual calls in the inner-most loops; maybe a templated
-        strategy pattern is an option. Right now, the only differences
-        to the h^add code are the use of max() instead of add() and
-        the lack of preferred operator support (but we might actually
-        reintroduce that if it doesn't hurt performance too much).
+  TODO: This shares the exploration with h^add (see
+        RelaxationHeuristic::dijkstra_exploration), but not the setup
+        and the preferred operator support.
  */
 
+struct MaxCostCombination {
+    int operator()(int op_cost, int base_cost, int prop_cost) const {
+        return max(op_cost, base_cost + prop_cost);
+    }
+};
+
 // construction and destruction
 HSPMaxHeuristic::HSPMaxHeuristic(const Options &opts)
-    : RelaxationHeuristic(opts) {
+    : RelaxationHeuristic(opts), queue_type(HEAP_QUEUE) {
 }
 
 HSPMaxHeuristic::~HSPMaxHeuristic() {
@@ -36,73 +35,40 @@ HSPMaxHeuristic::~HSPMaxHeuristic() {
 void HSPMaxHeuristic::initialize() {
     cout << "Initializing HSP max heuristic..." << endl;
     RelaxationHeuristic::initialize();
+    queue_type = choose_queue_type(false);
+}
+
+Heuristic *HSPMaxHeuristic::clone() const {
+    return new HSPMaxHeuristic(get_options());
 }
 
 // heuristic computation
-void HSPMaxHeuristic::setup_exploration_queue() {
+template<typename Queue>
+int HSPMaxHeuristic::compute_h_max(Queue &queue, const State &state) {
     queue.clear();
-
-    for (int var = 0; var < propositions.size(); var++) {
-        for (int value = 0; value < propositions[var].size(); value++) {
-            Proposition &prop = propositions[var][value];
-            prop.cost = -1;
-        }
-    }
+    fill(proposition_cost.begin(), proposition_cost.end(), -1);
 
     // Deal with operators and axioms without preconditions.
-	for (int k = 0; k < unary_operators.size(); k++) {  
-		for (int i = 0; i < unary_operators[k].size(); i++) {
-		    UnaryOperator &op = unary_operators[k][i];
-		    op.unsatisfied_preconditions = op.precondition.size();
-		    op.cost = op.base_cost; // will be increased by precondition costs
-
-		    if (op.unsatisfied_preconditions == 0)
-		        enqueue_if_necessary(op.effect, op.base_cost);
-		}
-	}
-}
-
-void HSPMaxHeuristic::setup_exploration_queue_state(const State &state) {
-    for (int var = 0; var < propositions.size(); var++) {
-        Proposition *init_prop = &propositions[var][state[var]];
-        enqueue_if_necessary(init_prop, 0);
-    }
-}
-
-void HSPMaxHeuristic::relaxed_exploration() {
-    int unsolved_goals = goal_propositions.size();
-    while (!queue.empty()) {
-        pair<int, Proposition *> top_pair = queue.pop();
-        int distance = top_pair.first;
-        Proposition *prop = top_pair.second;
-        int prop_cost = prop->cost;
-        assert(prop_cost <= distance);
-        if (prop_cost < distance)
-            continue;
-        if (prop->is_goal && --unsolved_goals == 0)
-            return;
-        const vector<UnaryOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (int i = 0; i < triggered_operators.size(); i++) {
-            UnaryOperator *unary_op = triggered_operators[i];
-            unary_op->unsatisfied_preconditions--;
-            unary_op->cost = max(unary_op->cost,
-                                 unary_op->base_cost + prop_cost);
-            assert(unary_op->unsatisfied_preconditions >= 0);
-            if (unary_op->unsatisfied_preconditions == 0)
-                enqueue_if_necessary(unary_op->effect, unary_op->cost);
+    for (int k = 0; k < unary_operators.size(); k++) {
+        const UnaryOperators &ops = *unary_operators[k];
+        reset_operators(k);
+        for (int i = 0; i < ops.without_preconditions.size(); i++) {
+            int op = ops.without_preconditions[i];
+            enqueue_if_necessary(queue, ops.effect[op], ops.base_cost[op], op);
         }
     }
-}
 
-int HSPMaxHeuristic::compute_heuristic(const State &state) {
-    setup_exploration_queue();
-    setup_exploration_queue_state(state);
-    relaxed_exploration();
+    for (int var = 0; var < g_variable_domain.size(); var++)
+        enqueue_if_necessary(queue, get_proposition(var, state[var]), 0,
+                             NO_OPERATOR);
+
+    // Unlike h^add, we explore the operators of all levels at once.
+    MaxCostCombination combine;
+    dijkstra_exploration(queue, combine, 0, unary_operators.size() - 1, true);
 
     int total_cost = 0;
     for (int i = 0; i < goal_propositions.size(); i++) {
-        int prop_cost = goal_propositions[i]->cost;
+        int prop_cost = proposition_cost[goal_propositions[i]];
         if (prop_cost == -1)
             return DEAD_END;
         total_cost = max(total_cost, prop_cost);
@@ -111,6 +77,17 @@ int HSPMaxHeuristic::compute_heuristic(const State &state) {
     return total_cost;
 }
 
+int HSPMaxHeuristic::compute_heuristic(const State &state) {
+    switch (queue_type) {
+    case TWO_BUCKET_QUEUE:
+        return compute_h_max(two_bucket_queue, state);
+    case BUCKET_QUEUE:
+        return compute_h_max(bucket_queue, state);
+    default:
+        return compute_h_max(heap_queue, state);
+    }
+}
+
 static ScalarEvaluator *_parse(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
     Options opts = parser.parse();
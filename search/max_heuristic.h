@@ -3,29 +3,23 @@
 
 #include "priority_queue.h"
 #include "relaxation_heuristic.h"
-#include <cassert>
 
 class HSPMaxHeuristic : public RelaxationHeuristic {
-    AdaptiveQueue<Proposition *> queue;
+    // Only the queue of queue_type is used.
+    QueueType queue_type;
+    TwoBucketQueue<int> two_bucket_queue;
+    CappedBucketQueue<int> bucket_queue;
+    HeapQueue<int> heap_queue;
 
-    void setup_exploration_queue();
-    void setup_exploration_queue_state(const State &state);
-    void relaxed_exploration();
-
-    void enqueue_if_necessary(Proposition *prop, int cost) {
-        assert(cost >= 0);
-        if (prop->cost == -1 || prop->cost > cost) {
-            prop->cost = cost;
-            queue.push(cost, prop);
-        }
-        assert(prop->cost != -1 && prop->cost <= cost);
-    }
+    template<typename Queue>
+    int compute_h_max(Queue &queue, const State &state);
 protected:
     virtual void initialize();
     virtual int compute_heuristic(const State &state);
 public:
     HSPMaxHeuristic(const Options &options);
     ~HSPMaxHeuristic();
+    virtual Heuristic *clone() const;
 };
 
 #endif
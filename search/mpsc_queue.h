@@ -0,0 +1,58 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+/*
+  A lock-free queue for many producer threads and one consumer thread.
+  Nodes are linked intrusively through their "next" member and are
+  owned by the queue between push() and pop_all().
+
+  Producers push onto a stack with compare-and-swap. The consumer takes
+  the whole stack at once with an atomic exchange and reverses it, so
+  nodes come out in the order in which they were pushed (per producer;
+  pushes from different producers are ordered by the time of their
+  compare-and-swap). Since the consumer never takes single nodes off
+  the stack, the usual ABA problem of lock-free stacks cannot arise.
+
+  We use the GCC __sync builtins, which are full memory barriers (apart
+  from __sync_lock_test_and_set, which is an acquire barrier and hence
+  enough for the consumer).
+*/
+
+template<class Node>
+class MPSCQueue {
+    Node *volatile head; // the most recently pushed node
+
+    // not implemented
+    MPSCQueue(const MPSCQueue<Node> &);
+    MPSCQueue &operator=(const MPSCQueue<Node> &);
+public:
+    MPSCQueue() : head(0) {
+    }
+
+    // May be called by any thread.
+    void push(Node *node) {
+        Node *old_head;
+        do {
+            old_head = head;
+            node->next = old_head;
+        } while (!__sync_bool_compare_and_swap(&head, old_head, node));
+    }
+
+    // Removes all nodes and returns them as a list in push order, or 0
+    // if the queue is empty. Only the consumer thread may call this.
+    Node *pop_all() {
+        if (!head)
+            return 0;
+        Node *node = __sync_lock_test_and_set(&head, static_cast<Node *>(0));
+        Node *result = 0;
+        while (node) {
+            Node *next = node->next;
+            node->next = result;
+            result = node;
+            node = next;
+        }
+        return result;
+    }
+};
+
+#endif
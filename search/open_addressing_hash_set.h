@@ -0,0 +1,146 @@
+#ifndef OPEN_ADDRESSING_HASH_SET_H
+#define OPEN_ADDRESSING_HASH_SET_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*
+  OpenAddressingHashSet is a hash set with linear probing that stores
+  its keys in one flat array of slots instead of in separately
+  allocated bucket chains (as __gnu_cxx::hash_set does).
+
+  Next to each key, we store a 32-bit fingerprint of its hash value.
+  Probing compares fingerprints first and only calls the (potentially
+  expensive) equality function if the fingerprints match, so most
+  mismatches are rejected without looking at the data the key refers
+  to. Growing the table reuses the stored fingerprints, so the hash
+  function is called exactly once per inserted key.
+
+  Keys must be cheap to copy (e.g. StateIDs). The key passed as
+  empty_key to the constructor marks unused slots and must never be
+  inserted. Erasing keys is not supported since no user needs it.
+*/
+
+template<class Key, class HashFunction, class EqualFunction>
+class OpenAddressingHashSet {
+    struct Slot {
+        unsigned int fingerprint;
+        Key key;
+        Slot(unsigned int fingerprint_, const Key &key_)
+            : fingerprint(fingerprint_), key(key_) {
+        }
+    };
+
+    static const size_t MIN_CAPACITY = 1024;
+    // Maximal load factor is MAX_LOAD_NUMERATOR / MAX_LOAD_DENOMINATOR.
+    static const size_t MAX_LOAD_NUMERATOR = 3;
+    static const size_t MAX_LOAD_DENOMINATOR = 4;
+
+    std::vector<Slot> slots;
+    size_t mask;
+    size_t num_entries;
+    Key empty_key;
+    HashFunction hash_function;
+    EqualFunction equal_function;
+
+    static unsigned int get_fingerprint(size_t hash) {
+        /*
+          Fold the upper half of 64-bit hash values into the fingerprint.
+          (Shifting twice keeps this well-defined for 32-bit size_t.)
+        */
+        return static_cast<unsigned int>(hash ^ ((hash >> 16) >> 16));
+    }
+
+    bool is_empty(const Slot &slot) const {
+        return slot.key == empty_key;
+    }
+
+    size_t find_slot(unsigned int fingerprint, const Key &key) const {
+        // Returns the slot holding key, or the empty slot where key
+        // should be inserted.
+        size_t index = fingerprint & mask;
+        while (true) {
+            const Slot &slot = slots[index];
+            if (is_empty(slot))
+                return index;
+            if (slot.fingerprint == fingerprint &&
+                equal_function(slot.key, key))
+                return index;
+            index = (index + 1) & mask;
+        }
+    }
+
+    void grow() {
+        std::vector<Slot> old_slots(slots.size() * 2,
+                                    Slot(0, empty_key));
+        old_slots.swap(slots);
+        mask = slots.size() - 1;
+        for (size_t i = 0; i < old_slots.size(); ++i) {
+            const Slot &slot = old_slots[i];
+            if (is_empty(slot))
+                continue;
+            // All keys are distinct, so we only need to find a free slot.
+            size_t index = slot.fingerprint & mask;
+            while (!is_empty(slots[index]))
+                index = (index + 1) & mask;
+            slots[index] = slot;
+        }
+    }
+public:
+    OpenAddressingHashSet(const Key &empty_key_,
+                          const HashFunction &hash_function_,
+                          const EqualFunction &equal_function_)
+        : slots(MIN_CAPACITY, Slot(0, empty_key_)),
+          mask(MIN_CAPACITY - 1),
+          num_entries(0),
+          empty_key(empty_key_),
+          hash_function(hash_function_),
+          equal_function(equal_function_) {
+    }
+
+    /*
+      Inserts key unless an equal key is already present. Returns the
+      key stored in the set and whether it was newly inserted, like
+      the insert method of the standard containers.
+    */
+    std::pair<Key, bool> insert(const Key &key) {
+        return insert(key, hash_function(key));
+    }
+
+    /*
+      Like insert(key), but uses the given hash value instead of
+      calling the hash function. The caller must pass the value the
+      hash function would return for key.
+    */
+    std::pair<Key, bool> insert(const Key &key, size_t hash) {
+        assert(!(key == empty_key));
+        assert(hash == hash_function(key));
+        if ((num_entries + 1) * MAX_LOAD_DENOMINATOR >
+            slots.size() * MAX_LOAD_NUMERATOR)
+            grow();
+        unsigned int fingerprint = get_fingerprint(hash);
+        size_t index = find_slot(fingerprint, key);
+        Slot &slot = slots[index];
+        if (!is_empty(slot))
+            return std::make_pair(slot.key, false);
+        slot = Slot(fingerprint, key);
+        ++num_entries;
+        return std::make_pair(key, true);
+    }
+
+    size_t size() const {
+        return num_entries;
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    size_t get_memory_in_bytes() const {
+        return slots.size() * sizeof(Slot);
+    }
+};
+
+#endif
@@ -0,0 +1,246 @@
+// HACK! Ignore this if used as a top-level compile target.
+#ifdef OPEN_LISTS_BUCKET_ARRAY_OPEN_LIST_H
+
+#include "../option_parser.h"
+#include "../scalar_evaluator.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+
+template<class Entry>
+OpenList<Entry> *BucketArrayOpenList<Entry>::_parse(OptionParser &parser) {
+    parser.add_list_option<ScalarEvaluator *>("evaluators");
+    parser.add_option<bool>("pref_only", false,
+                            "insert only preferred operators");
+    Options opts = parser.parse();
+
+    opts.verify_list_non_empty<ScalarEvaluator *>("evaluators");
+
+    if (parser.dry_run())
+        return 0;
+    else
+        return new BucketArrayOpenList<Entry>(opts);
+}
+
+template<class Entry>
+BucketArrayOpenList<Entry>::BucketArrayOpenList(const Options &opts)
+    : OpenList<Entry>(opts.get<bool>("pref_only")),
+      buckets(MIN_WINDOW_SIZE),
+      non_empty_buckets(MIN_WINDOW_SIZE / BITS_PER_WORD, 0),
+      free_chunk(NO_CHUNK), window_mask(MIN_WINDOW_SIZE - 1),
+      lowest_key(0), highest_key(0), size(0),
+      evaluator(opts.get_list<ScalarEvaluator *>("evaluators")[0]) {
+}
+
+template<class Entry>
+BucketArrayOpenList<Entry>::BucketArrayOpenList(
+    ScalarEvaluator *eval, bool preferred_only)
+    : OpenList<Entry>(preferred_only),
+      buckets(MIN_WINDOW_SIZE),
+      non_empty_buckets(MIN_WINDOW_SIZE / BITS_PER_WORD, 0),
+      free_chunk(NO_CHUNK), window_mask(MIN_WINDOW_SIZE - 1),
+      lowest_key(0), highest_key(0), size(0), evaluator(eval) {
+}
+
+template<class Entry>
+BucketArrayOpenList<Entry>::~BucketArrayOpenList() {
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::set_bit(int slot) {
+    non_empty_buckets[slot / BITS_PER_WORD] |= 1U << (slot % BITS_PER_WORD);
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::clear_bit(int slot) {
+    non_empty_buckets[slot / BITS_PER_WORD] &= ~(1U << (slot % BITS_PER_WORD));
+}
+
+template<class Entry>
+int BucketArrayOpenList<Entry>::find_next_non_empty_slot(int slot) const {
+    // Returns the first non-empty slot at or (circularly) after slot.
+    assert(size > 0);
+    int num_words = non_empty_buckets.size();
+    int word = slot / BITS_PER_WORD;
+    unsigned int bits = non_empty_buckets[word] &
+                        (~0U << (slot % BITS_PER_WORD));
+    for (int i = 0; i <= num_words; ++i) {
+        if (bits)
+            return word * BITS_PER_WORD + __builtin_ctz(bits);
+        word = (word + 1) % num_words;
+        bits = non_empty_buckets[word];
+    }
+    assert(false);
+    return -1;
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::grow_window(int min_key, int max_key) {
+    // Moves all buckets to a window that can hold [min_key, max_key].
+    int new_size = get_window_size();
+    while (new_size <= max_key - min_key)
+        new_size *= 2;
+    vector<Bucket> new_buckets(new_size);
+    vector<unsigned int> new_non_empty(new_size / BITS_PER_WORD, 0);
+    int new_mask = new_size - 1;
+    if (size > 0) {
+        for (int slot = 0; slot < buckets.size(); ++slot) {
+            const Bucket &bucket = buckets[slot];
+            if (bucket.first_chunk == NO_CHUNK)
+                continue;
+            int key = lowest_key + ((slot - lowest_key) & window_mask);
+            int new_slot = key & new_mask;
+            new_buckets[new_slot] = bucket;
+            new_non_empty[new_slot / BITS_PER_WORD] |=
+                1U << (new_slot % BITS_PER_WORD);
+        }
+    }
+    buckets.swap(new_buckets);
+    non_empty_buckets.swap(new_non_empty);
+    window_mask = new_mask;
+}
+
+template<class Entry>
+int BucketArrayOpenList<Entry>::allocate_chunk() {
+    int chunk_id;
+    if (free_chunk != NO_CHUNK) {
+        chunk_id = free_chunk;
+        free_chunk = chunks[chunk_id].next;
+    } else {
+        chunk_id = chunks.size();
+        chunks.push_back(Chunk());
+        chunks[chunk_id].entries.reserve(CHUNK_SIZE);
+    }
+    chunks[chunk_id].next = NO_CHUNK;
+    return chunk_id;
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::release_chunk(int chunk_id) {
+    // Keeps the capacity of the chunk for reuse.
+    chunks[chunk_id].entries.clear();
+    chunks[chunk_id].next = free_chunk;
+    free_chunk = chunk_id;
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::push_back(Bucket &bucket,
+                                           const Entry &entry) {
+    if (bucket.first_chunk == NO_CHUNK) {
+        int chunk_id = allocate_chunk();
+        bucket.first_chunk = bucket.last_chunk = chunk_id;
+        bucket.first_pos = 0;
+    } else if (chunks[bucket.last_chunk].entries.size() == CHUNK_SIZE) {
+        int chunk_id = allocate_chunk();
+        chunks[bucket.last_chunk].next = chunk_id;
+        bucket.last_chunk = chunk_id;
+    }
+    chunks[bucket.last_chunk].entries.push_back(entry);
+}
+
+template<class Entry>
+Entry BucketArrayOpenList<Entry>::pop_front(Bucket &bucket) {
+    assert(bucket.first_chunk != NO_CHUNK);
+    int chunk_id = bucket.first_chunk;
+    Chunk &chunk = chunks[chunk_id];
+    Entry result = chunk.entries[bucket.first_pos++];
+    if (bucket.first_pos == chunk.entries.size()) {
+        // Chunk exhausted; if it is the last one, the bucket is now empty.
+        bucket.first_chunk = chunk.next;
+        bucket.first_pos = 0;
+        if (bucket.first_chunk == NO_CHUNK)
+            bucket.last_chunk = NO_CHUNK;
+        release_chunk(chunk_id);
+    }
+    return result;
+}
+
+template<class Entry>
+int BucketArrayOpenList<Entry>::insert(const Entry &entry) {
+    if (OpenList<Entry>::only_preferred && !last_preferred)
+        return 0;
+    if (dead_end)
+        return 0;
+    int key = last_evaluated_value;
+    assert(key >= 0);
+    if (size == 0) {
+        lowest_key = highest_key = key;
+    } else {
+        int min_key = min(lowest_key, key);
+        int max_key = max(highest_key, key);
+        if (max_key - min_key > window_mask)
+            grow_window(min_key, max_key);
+        lowest_key = min_key;
+        highest_key = max_key;
+    }
+    int slot = key & window_mask;
+    push_back(buckets[slot], entry);
+    set_bit(slot);
+    ++size;
+    return 1;
+}
+
+template<class Entry>
+Entry BucketArrayOpenList<Entry>::remove_min(vector<int> *key) {
+    assert(size > 0);
+    int slot = lowest_key & window_mask;
+    if (key) {
+        assert(key->empty());
+        key->push_back(lowest_key);
+    }
+    Bucket &bucket = buckets[slot];
+    Entry result = pop_front(bucket);
+    --size;
+    if (bucket.first_chunk == NO_CHUNK) {
+        clear_bit(slot);
+        if (size > 0) {
+            int next_slot = find_next_non_empty_slot(slot);
+            lowest_key += (next_slot - slot) & window_mask;
+        }
+    }
+    return result;
+}
+
+
+template<class Entry>
+bool BucketArrayOpenList<Entry>::empty() const {
+    return size == 0;
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::clear() {
+    buckets.assign(buckets.size(), Bucket());
+    non_empty_buckets.assign(non_empty_buckets.size(), 0);
+    chunks.clear();
+    free_chunk = NO_CHUNK;
+    size = 0;
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::evaluate(int g, bool preferred) {
+    get_evaluator()->evaluate(g, preferred);
+    last_evaluated_value = get_evaluator()->get_value();
+    last_preferred = preferred;
+    dead_end = get_evaluator()->is_dead_end();
+    dead_end_reliable = get_evaluator()->dead_end_is_reliable();
+}
+
+template<class Entry>
+bool BucketArrayOpenList<Entry>::is_dead_end() const {
+    return dead_end;
+}
+
+template<class Entry>
+bool BucketArrayOpenList<Entry>::dead_end_is_reliable() const {
+    return dead_end_reliable;
+}
+
+template<class Entry>
+void BucketArrayOpenList<Entry>::get_involved_heuristics(
+    std::set<Heuristic *> &hset) {
+    evaluator->get_involved_heuristics(hset);
+}
+#endif
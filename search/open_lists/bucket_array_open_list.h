@@ -0,0 +1,104 @@
+#ifndef OPEN_LISTS_BUCKET_ARRAY_OPEN_LIST_H
+#define OPEN_LISTS_BUCKET_ARRAY_OPEN_LIST_H
+
+#include "open_list.h"
+#include "../segmented_vector.h"
+
+#include <vector>
+
+class Options;
+class OptionParser;
+class ScalarEvaluator;
+
+/*
+  Open list for a single non-negative int key with FIFO tie-breaking,
+  specialised for the small f and h values of typical searches. It can
+  be used instead of StandardScalarOpenList ("single"), which pays for
+  a map lookup and deque operations on every insertion and removal.
+
+  - Buckets live in a circular window of a power-of-two number of
+    slots covering the keys [lowest_key, lowest_key + window size).
+    Key k is stored in slot k & window_mask, so moving the window to a
+    new minimum does not move any buckets. The window only grows (and
+    its buckets are redistributed) when the keys present span more
+    than the window size.
+  - A bitmap of the non-empty slots lets us find the next minimum
+    with __builtin_ctz, one 32-slot word at a time.
+  - Each bucket is a linked list of fixed-size chunks, which all
+    buckets allocate from a shared pool with a free list. Unlike
+    std::deque, this does not allocate or free memory in the steady
+    state.
+*/
+
+template<class Entry>
+class BucketArrayOpenList : public OpenList<Entry> {
+    static const int NO_CHUNK = -1;
+    static const int CHUNK_SIZE = 64;
+    static const int MIN_WINDOW_SIZE = 64;
+    static const int BITS_PER_WORD = 32;
+
+    struct Chunk {
+        std::vector<Entry> entries;
+        int next;
+    };
+
+    struct Bucket {
+        int first_chunk; // NO_CHUNK iff the bucket is empty
+        int last_chunk;
+        int first_pos; // position of the front entry in first_chunk
+        Bucket() : first_chunk(NO_CHUNK), last_chunk(NO_CHUNK), first_pos(0) {}
+    };
+
+    std::vector<Bucket> buckets;
+    std::vector<unsigned int> non_empty_buckets;
+    SegmentedVector<Chunk> chunks;
+    int free_chunk;
+    int window_mask;
+    // Only meaningful if size > 0. lowest_key is the smallest key
+    // present; highest_key is an upper bound on all keys present.
+    int lowest_key;
+    int highest_key;
+    int size;
+
+    ScalarEvaluator *evaluator;
+    int last_evaluated_value;
+    bool last_preferred;
+    bool dead_end;
+    bool dead_end_reliable;
+
+    int get_window_size() const {return window_mask + 1; }
+    void set_bit(int slot);
+    void clear_bit(int slot);
+    int find_next_non_empty_slot(int slot) const;
+    void grow_window(int min_key, int max_key);
+
+    int allocate_chunk();
+    void release_chunk(int chunk_id);
+    void push_back(Bucket &bucket, const Entry &entry);
+    Entry pop_front(Bucket &bucket);
+protected:
+    ScalarEvaluator *get_evaluator() {return evaluator; }
+
+public:
+    BucketArrayOpenList(const Options &opts);
+    BucketArrayOpenList(ScalarEvaluator *eval, bool preferred_only);
+    ~BucketArrayOpenList();
+
+    int insert(const Entry &entry);
+    Entry remove_min(std::vector<int> *key = 0);
+    bool empty() const;
+    void clear();
+
+    void evaluate(int g, bool preferred);
+    bool is_dead_end() const;
+    bool dead_end_is_reliable() const;
+    void get_involved_heuristics(std::set<Heuristic *> &hset);
+
+    static OpenList<Entry> *_parse(OptionParser &parser);
+};
+
+#include "bucket_array_open_list.cc"
+
+// HACK! Need a better strategy of dealing with templates, also in the Makefile.
+
+#endif
@@ -64,10 +64,7 @@ int StandardScalarOpenList<Entry>::insert(const Entry &entry) {
 
 template<class Entry>
 Entry StandardScalarOpenList<Entry>::remove_min(vector<int> *key) {
-    
-	cout << "AQUIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIII" << endl;
-
-	assert(size > 0);
+    assert(size > 0);
     typename std::map<int, Bucket>::iterator it;
     it = buckets.begin();
     assert(it != buckets.end());
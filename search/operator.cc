@@ -17,8 +17,6 @@ PrePost::PrePost(istream &in) {
 }
 
 Operator::Operator(istream &in, bool axiom, bool is_abstract) {
-    marked = false;
-
     is_an_axiom = axiom;
     if (!is_an_axiom) {
 		  if (is_abstract) 
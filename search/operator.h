@@ -64,8 +64,6 @@ class Operator {
     std::string name;
     int cost;
     int type;
-
-    mutable bool marked; // Used for short-term marking of preferred operators
 public:
     Operator(std::istream &in, bool is_axiom, bool is_abstract);
     void dump() const;
@@ -86,16 +84,6 @@ public:
         return true;
     }
 
-    bool is_marked() const {
-        return marked;
-    }
-    void mark() const {
-        marked = true;
-    }
-    void unmark() const {
-        marked = false;
-    }
-
     mutable bool marker1, marker2; // HACK! HACK!
 
     int get_cost() const {return cost; }
@@ -218,9 +218,23 @@ SearchEngine *OptionParser::parse_cmd_line(
 			++i;
 			g_use_abstractions = true;
 			g_horizon = atoi(argv[i]);
+		} else if (arg.compare("--state-hash-table") == 0) {
+            ++i;
+            string type = i < argc ? argv[i] : "";
+            if (type == "open") {
+                g_state_hash_table_type = OPEN_ADDRESSING_STATE_HASH_TABLE;
+            } else if (type == "chained") {
+                g_state_hash_table_type = CHAINED_STATE_HASH_TABLE;
+            } else {
+                cerr << "unknown state hash table " << type << endl;
+                exit_with(EXIT_INPUT_ERROR);
+            }
 		} else if (arg.compare("--plan-file") == 0) {
             ++i;
             g_plan_filename = argv[i];
+        } else if (arg.compare("--pdb-dir") == 0) {
+            ++i;
+            g_pdb_directory = i < argc ? argv[i] : "";
         } else {
             cerr << "unknown option " << arg << endl << endl;
             cout << OptionParser::usage(argv[0]) << endl;
@@ -254,8 +268,16 @@ string OptionParser::usage(string progname) {
 		"	 Generate landmark subset for abstraction technique and save into a file\n"
 		"--abstractions HORIZON\n"
 		"    Planning using abstractions based in horizon\n"
+        "--state-hash-table {open,chained}\n"
+        "    Hash table used for duplicate detection of registered states:\n"
+        "    open addressing with fingerprints (default) or the chained\n"
+        "    __gnu_cxx::hash_set\n"
         "--plan-file FILENAME\n"
-        "    Plan will be output to a file called FILENAME\n\n"
+        "    Plan will be output to a file called FILENAME\n"
+        "--pdb-dir DIRECTORY\n"
+        "    Save pattern databases to files in DIRECTORY, and load them\n"
+        "    from there in later runs that need the same PDBs, i.e. the\n"
+        "    same projection of the task to the pattern.\n\n"
         "See http://www.fast-downward.org/ for details.";
     return usage;
 }
@@ -0,0 +1,209 @@
+#include "bdd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using namespace std;
+
+// operations in the computed table
+enum {ITE, RESTRICT};
+
+static const size_t MIN_TABLE_SIZE = 1 << 16;
+
+BDDManager::BDDManager(int num_vars_)
+    : num_vars(num_vars_) {
+    unique_table.resize(MIN_TABLE_SIZE, -1);
+    CacheEntry empty = {-1, 0, 0, 0, 0};
+    computed_table.resize(MIN_TABLE_SIZE / 2, empty);
+    // false and true are the first two nodes
+    get_constant(0);
+    get_constant(1);
+}
+
+BDDManager::~BDDManager() {
+}
+
+size_t BDDManager::hash_node(int var, int low, int high) const {
+    size_t hash = var;
+    hash = hash * 12582917 + low;
+    hash = hash * 4256249 + high;
+    return hash ^ (hash >> 16);
+}
+
+int BDDManager::make_node(int var, int low, int high) {
+    if (low == high && var != num_vars)
+        return low;
+    size_t mask = unique_table.size() - 1;
+    size_t slot = hash_node(var, low, high) & mask;
+    while (unique_table[slot] != -1) {
+        const Node &node = nodes[unique_table[slot]];
+        if (node.var == var && node.low == low && node.high == high)
+            return unique_table[slot];
+        slot = (slot + 1) & mask;
+    }
+    Node node = {var, low, high};
+    nodes.push_back(node);
+    unique_table[slot] = nodes.size() - 1;
+    if (nodes.size() * 2 > unique_table.size())
+        resize_tables();
+    return nodes.size() - 1;
+}
+
+void BDDManager::resize_tables() {
+    size_t size = MIN_TABLE_SIZE;
+    while (size < nodes.size() * 4)
+        size *= 2;
+    unique_table.assign(size, -1);
+    size_t mask = size - 1;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        size_t slot = hash_node(nodes[i].var, nodes[i].low, nodes[i].high) & mask;
+        while (unique_table[slot] != -1)
+            slot = (slot + 1) & mask;
+        unique_table[slot] = i;
+    }
+    // The computed table grows with the unique table, forgetting its entries.
+    CacheEntry empty = {-1, 0, 0, 0, 0};
+    computed_table.assign(size / 2, empty);
+}
+
+int BDDManager::lookup_computed(int op, int f, int g, int h) const {
+    const CacheEntry &entry = computed_table[(hash_node(f, g, h) + op) & (computed_table.size() - 1)];
+    if (entry.op == op && entry.f == f && entry.g == g && entry.h == h)
+        return entry.result;
+    return -1;
+}
+
+void BDDManager::store_computed(int op, int f, int g, int h, int result) {
+    CacheEntry &entry = computed_table[(hash_node(f, g, h) + op) & (computed_table.size() - 1)];
+    entry.op = op;
+    entry.f = f;
+    entry.g = g;
+    entry.h = h;
+    entry.result = result;
+}
+
+int BDDManager::get_constant(int value) {
+    return make_node(num_vars, value, -1);
+}
+
+int BDDManager::get_literal(int var, bool value) {
+    assert(var >= 0 && var < num_vars);
+    if (value)
+        return make_node(var, get_false(), get_true());
+    else
+        return make_node(var, get_true(), get_false());
+}
+
+int BDDManager::ite(int f, int g, int h) {
+    if (f == get_true())
+        return g;
+    if (f == get_false())
+        return h;
+    if (g == h)
+        return g;
+    if (g == get_true() && h == get_false())
+        return f;
+    int result = lookup_computed(ITE, f, g, h);
+    if (result != -1)
+        return result;
+
+    // split on the first variable tested by any of the arguments
+    int var = min(nodes[f].var, min(nodes[g].var, nodes[h].var));
+    int f_low = f, f_high = f, g_low = g, g_high = g, h_low = h, h_high = h;
+    if (nodes[f].var == var) {
+        f_low = nodes[f].low;
+        f_high = nodes[f].high;
+    }
+    if (nodes[g].var == var) {
+        g_low = nodes[g].low;
+        g_high = nodes[g].high;
+    }
+    if (nodes[h].var == var) {
+        h_low = nodes[h].low;
+        h_high = nodes[h].high;
+    }
+    int low = ite(f_low, g_low, h_low);
+    int high = ite(f_high, g_high, h_high);
+    result = make_node(var, low, high);
+    store_computed(ITE, f, g, h, result);
+    return result;
+}
+
+int BDDManager::restrict(int f, int cube) {
+    if (cube == get_true() || is_terminal(f))
+        return f;
+    assert(cube != get_false());
+    int cube_var = nodes[cube].var;
+    bool positive = nodes[cube].low == get_false();
+    int rest_of_cube = positive ? nodes[cube].high : nodes[cube].low;
+    if (cube_var < nodes[f].var)
+        return restrict(f, rest_of_cube);
+    int result = lookup_computed(RESTRICT, f, cube, 0);
+    if (result != -1)
+        return result;
+
+    if (cube_var == nodes[f].var) {
+        result = restrict(positive ? nodes[f].high : nodes[f].low, rest_of_cube);
+    } else {
+        int var = nodes[f].var;
+        int low = nodes[f].low;
+        int high = nodes[f].high;
+        low = restrict(low, cube);
+        high = restrict(high, cube);
+        result = make_node(var, low, high);
+    }
+    store_computed(RESTRICT, f, cube, 0, result);
+    return result;
+}
+
+size_t BDDManager::count_nodes(int f) const {
+    // Children have lower numbers than their parents, so one pass from f downwards finds all nodes.
+    vector<bool> reached(f + 1, false);
+    reached[f] = true;
+    size_t count = 0;
+    for (int i = f; i >= 0; --i) {
+        if (!reached[i])
+            continue;
+        ++count;
+        if (!is_terminal(i)) {
+            reached[nodes[i].low] = true;
+            reached[nodes[i].high] = true;
+        }
+    }
+    return count;
+}
+
+void BDDManager::garbage_collect(const vector<int *> &roots) {
+    vector<bool> reached(nodes.size(), false);
+    reached[get_false()] = true;
+    reached[get_true()] = true;
+    for (size_t i = 0; i < roots.size(); ++i)
+        reached[*roots[i]] = true;
+    for (int i = nodes.size() - 1; i >= 0; --i) {
+        if (reached[i] && !is_terminal(i)) {
+            reached[nodes[i].low] = true;
+            reached[nodes[i].high] = true;
+        }
+    }
+
+    // Keeping the order of the nodes keeps children below their parents.
+    vector<int> new_number(nodes.size(), -1);
+    size_t num_kept = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!reached[i])
+            continue;
+        Node node = nodes[i];
+        if (node.var != num_vars) {
+            node.low = new_number[node.low];
+            node.high = new_number[node.high];
+        }
+        new_number[i] = num_kept;
+        nodes[num_kept++] = node;
+    }
+    nodes.resize(num_kept);
+    vector<Node>(nodes).swap(nodes);
+    for (size_t i = 0; i < roots.size(); ++i)
+        *roots[i] = new_number[*roots[i]];
+    resize_tables();
+}
@@ -0,0 +1,91 @@
+#ifndef PDBS_BDD_H
+#define PDBS_BDD_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+  A minimal package for reduced ordered binary decision diagrams over
+  the variables 0, ..., num_vars - 1 (tested in this order), as needed
+  by SymbolicPDBHeuristic.
+
+  BDDs are referred to by the number of their root node. Terminal nodes
+  carry an integer value, so that the same nodes also represent
+  multi-terminal BDDs (ADDs) mapping assignments to integers: the BDD
+  false is the terminal 0 and true is the terminal 1. All operations
+  except ite expect their arguments to be BDDs in this sense.
+
+  Nodes are shared through a unique table and results of operations
+  are remembered in a (lossy) computed table. There is no reference
+  counting: nodes live until garbage_collect is called with the BDDs
+  that are still needed.
+*/
+class BDDManager {
+    struct Node {
+        int var; // num_vars for terminals
+        int low; // for terminals, the value
+        int high; // -1 for terminals
+    };
+
+    struct CacheEntry {
+        int op;
+        int f;
+        int g;
+        int h;
+        int result;
+    };
+
+    int num_vars;
+    std::vector<Node> nodes;
+    std::vector<int> unique_table; // node numbers, -1 for empty slots (open addressing)
+    std::vector<CacheEntry> computed_table;
+
+    int make_node(int var, int low, int high);
+    size_t hash_node(int var, int low, int high) const;
+    void resize_tables();
+
+    int lookup_computed(int op, int f, int g, int h) const;
+    void store_computed(int op, int f, int g, int h, int result);
+
+    // not implemented
+    BDDManager(const BDDManager &);
+    BDDManager &operator=(const BDDManager &);
+public:
+    explicit BDDManager(int num_vars);
+    ~BDDManager();
+
+    int get_false() const {return 0; }
+    int get_true() const {return 1; }
+    // Returns the terminal node with the given value.
+    int get_constant(int value);
+    // Returns the BDD for the literal var = value.
+    int get_literal(int var, bool value);
+
+    // If-then-else: f must be a BDD, g and h may be ADDs.
+    int ite(int f, int g, int h);
+    int apply_and(int f, int g) {return ite(f, g, get_false()); }
+    int apply_or(int f, int g) {return ite(f, get_true(), g); }
+    int apply_not(int f) {return ite(f, get_false(), get_true()); }
+    /* Returns the cofactor of f for the assignment given by cube, which must be a conjunction of literals: the
+       function which maps each assignment x to f(x') where x' agrees with cube on its variables and with x
+       otherwise. */
+    int restrict(int f, int cube);
+
+    bool is_terminal(int f) const {return nodes[f].var == num_vars; }
+    int get_value(int f) const {return nodes[f].low; }
+    int get_var(int f) const {return nodes[f].var; }
+    int get_low(int f) const {return nodes[f].low; }
+    int get_high(int f) const {return nodes[f].high; }
+
+    int get_num_vars() const {return num_vars; }
+    // Returns the number of nodes, including those which are not needed any more.
+    size_t get_num_nodes() const {return nodes.size(); }
+    // Returns the number of nodes of the given BDD.
+    size_t count_nodes(int f) const;
+
+    /* Deletes all nodes that are not part of the BDDs pointed to by roots and renumbers the others, updating
+       the roots. The children of a node always have lower numbers than the node itself. */
+    void garbage_collect(const std::vector<int *> &roots);
+};
+
+#endif
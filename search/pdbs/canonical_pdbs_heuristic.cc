@@ -19,16 +19,20 @@
 
 using namespace std;
 
-CanonicalPDBsHeuristic::CanonicalPDBsHeuristic(const Options &opts)
+CanonicalPDBsHeuristic::CanonicalPDBsHeuristic(const Options &opts, bool dump)
     : Heuristic(opts) {
     const vector<vector<int> > &pattern_collection(opts.get_list<vector<int> >("patterns"));
+    int num_threads = opts.contains("threads") ? opts.get<int>("threads") : 1;
     Timer timer;
     size = 0;
     pattern_databases.reserve(pattern_collection.size());
-    for (size_t i = 0; i < pattern_collection.size(); ++i)
-        _add_pattern(pattern_collection[i]);
+    build_pdbs(cost_type, pattern_collection, vector<vector<int> >(),
+               num_threads, dump, pattern_databases);
+    for (size_t i = 0; i < pattern_databases.size(); ++i)
+        size += pattern_databases[i]->get_size();
     compute_additive_vars();
     compute_max_cliques();
+    evaluator.set_collection(pattern_databases, max_cliques);
     cout << "PDB collection construction time: " << timer << endl;
 }
 
@@ -110,6 +114,7 @@ void CanonicalPDBsHeuristic::dominance_pruning() {
     int num_cliques = max_cliques.size();
 
     DominancePruner(pattern_databases, max_cliques).prune();
+    evaluator.set_collection(pattern_databases, max_cliques);
 
     // Adjust size.
     size = 0;
@@ -129,34 +134,32 @@ void CanonicalPDBsHeuristic::initialize() {
 }
 
 int CanonicalPDBsHeuristic::compute_heuristic(const State &state) {
-    int max_h = 0;
-    assert(!max_cliques.empty());
-    // if we have an empty collection, then max_cliques = { \emptyset }
+    return evaluator.evaluate(state);
+}
 
-    for (size_t i = 0; i < pattern_databases.size(); ++i) {
-        pattern_databases[i]->evaluate(state);
-        if (pattern_databases[i]->is_dead_end())
-            return -1;
-    }
-    for (size_t i = 0; i < max_cliques.size(); ++i) {
-        const vector<PDBHeuristic *> &clique = max_cliques[i];
-        int clique_h = 0;
-        for (size_t j = 0; j < clique.size(); ++j) {
-            clique_h += clique[j]->get_heuristic();
-        }
-        max_h = max(max_h, clique_h);
-    }
-    return max_h;
+void CanonicalPDBsHeuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &,
+    vector<int> &values) {
+    for (size_t i = 0; i < states.size(); ++i)
+        values[i] = evaluator.evaluate(states[i]);
 }
 
 void CanonicalPDBsHeuristic::add_pattern(const vector<int> &pattern) {
     _add_pattern(pattern);
     compute_max_cliques();
+    evaluator.set_collection(pattern_databases, max_cliques);
+}
+
+void CanonicalPDBsHeuristic::add_pdb(PDBHeuristic *pdb) {
+    pattern_databases.push_back(pdb);
+    size += pdb->get_size();
+    compute_max_cliques();
+    evaluator.set_collection(pattern_databases, max_cliques);
 }
 
 
 void CanonicalPDBsHeuristic::get_max_additive_subsets(
-    const vector<int> &new_pattern, vector<vector<PDBHeuristic *> > &max_additive_subsets) {
+    const vector<int> &new_pattern, vector<vector<PDBHeuristic *> > &max_additive_subsets) const {
     /*
       We compute additive pattern sets S with the property that we could
       add the new pattern P to S and still have an additive pattern set.
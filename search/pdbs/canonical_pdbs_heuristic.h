@@ -1,6 +1,8 @@
 #ifndef PDBS_CANONICAL_PDBS_HEURISTIC_H
 #define PDBS_CANONICAL_PDBS_HEURISTIC_H
 
+#include "pdb_collection_evaluator.h"
+
 #include "../heuristic.h"
 
 #include <vector>
@@ -12,6 +14,7 @@ class CanonicalPDBsHeuristic : public Heuristic {
     std::vector<std::vector<PDBHeuristic *> > max_cliques; // final computed max_cliques
     std::vector<std::vector<bool> > are_additive; // pair of variables which are additive
     std::vector<PDBHeuristic *> pattern_databases; // final pattern databases
+    PDBCollectionEvaluator evaluator; // set up for pattern_databases and max_cliques
 
     /* Returns true iff the two patterns are additive i.e. there is no operator
        which affects variables in pattern one as well as in pattern two. */
@@ -34,13 +37,22 @@ class CanonicalPDBsHeuristic : public Heuristic {
 protected:
     virtual void initialize();
     virtual int compute_heuristic(const State &state);
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
 public:
-    CanonicalPDBsHeuristic(const Options &opts);
+    // dump: if set to true, prints the construction time of each PDB.
+    CanonicalPDBsHeuristic(const Options &opts, bool dump = true);
     virtual ~CanonicalPDBsHeuristic();
 
     // add a new pattern to the collection and recomputes maximal cliques
     void add_pattern(const std::vector<int> &pattern);
 
+    /* as add_pattern, but for an already built PDB (with the cost type of the collection),
+       which is then owned by the collection */
+    void add_pdb(PDBHeuristic *pdb);
+
     /* Prune pattern set P = {P_1, ..., P_k} if there exists another pattern set
        Q = {Q_1, ..., Q_l} where each P_i is a subset of some Q_j:
        this implies h^P <= h^Q for all states. */
@@ -48,7 +60,7 @@ public:
 
     // checks for all max cliques if they would be additive to this pattern
     void get_max_additive_subsets(const std::vector<int> &new_pattern,
-                                  std::vector<std::vector<PDBHeuristic *> > &max_additive_subsets);
+                                  std::vector<std::vector<PDBHeuristic *> > &max_additive_subsets) const;
     const std::vector<PDBHeuristic *> &get_pattern_databases() const {return pattern_databases; }
     int get_size() const {return size; }
     void dump() const;
@@ -9,167 +9,164 @@
 
 using namespace std;
 
-struct MatchTree::Node {
-    Node(int test_var = -1, int test_var_size = 0);
-    ~Node();
-    std::vector<const AbstractOperator *> applicable_operators;
-    int test_var; // variable which this node represents
-    int var_size;
-    Node **successors; // edges with specific values for test_var_
-    Node *star_successor; // star-edge (unspecified value for test_var)
-};
-
-MatchTree::Node::Node(int test_var_, int test_var_size) : test_var(test_var_), var_size(test_var_size), star_successor(0) {
-    if (test_var_size == 0) { // construct a default node (test_var = -1), successors doesn't get initialized
-        successors = 0;
-    } else { // a test var has been specified, initialize node accordingly
-        successors = new Node *[test_var_size];
-        for (int i = 0; i < test_var_size; ++i) {
-            successors[i] = 0;
-        }
-    }
-}
-
-MatchTree::Node::~Node() {
-    for (int i = 0; i < var_size; ++i) {
-        delete successors[i];
+MatchTree::MatchTree(const vector<int> &pattern_, const vector<size_t> &hash_multipliers_,
+                     const vector<AbstractOperator> &operators)
+    : pattern(pattern_), hash_multipliers(hash_multipliers_) {
+    if (!operators.empty()) {
+        vector<pair<int, int> > op_and_pre_index;
+        op_and_pre_index.reserve(operators.size());
+        for (size_t i = 0; i < operators.size(); ++i)
+            op_and_pre_index.push_back(make_pair(i, 0));
+        build_recursively(operators, op_and_pre_index);
     }
-    delete[] successors;
-    delete star_successor;
-}
-
-MatchTree::MatchTree(const vector<int> &pattern_, const vector<size_t> &hash_multipliers_)
-    : pattern(pattern_), hash_multipliers(hash_multipliers_), root(0) {
 }
 
 MatchTree::~MatchTree() {
-    delete root;
 }
 
-void MatchTree::build_recursively(
-    const AbstractOperator &op, int pre_index, Node **edge_from_parent) {
-    if (*edge_from_parent == 0) {
-        // We don't exist yet: create a new node.
-        *edge_from_parent = new Node();
+int MatchTree::build_recursively(const vector<AbstractOperator> &operators,
+                                 const vector<pair<int, int> > &op_and_pre_index) {
+    int node_index = nodes.size();
+    nodes.push_back(Node());
+
+    /* Operators whose preconditions have all been checked are inserted here. The node tests the smallest variable
+       of the next preconditions of all other operators. */
+    int test_var = -1;
+    int operators_begin = node_operators.size();
+    for (size_t i = 0; i < op_and_pre_index.size(); ++i) {
+        const vector<pair<int, int> > &regression_preconditions =
+            operators[op_and_pre_index[i].first].get_regression_preconditions();
+        int pre_index = op_and_pre_index[i].second;
+        if (pre_index == regression_preconditions.size()) {
+            node_operators.push_back(op_and_pre_index[i].first);
+        } else {
+            int var = regression_preconditions[pre_index].first;
+            if (test_var == -1 || var < test_var)
+                test_var = var;
+        }
     }
-
-    const vector<pair<int, int> > &regression_preconditions = op.get_regression_preconditions();
-    Node *node = *edge_from_parent;
-    if (pre_index == regression_preconditions.size()) { // all preconditions have been checked, insert op
-        node->applicable_operators.push_back(&op);
-    } else {
+    nodes[node_index].operators_begin = operators_begin;
+    nodes[node_index].operators_end = node_operators.size();
+    nodes[node_index].test_var = test_var;
+    nodes[node_index].var_size = 0;
+    nodes[node_index].successors = -1;
+    nodes[node_index].star_successor = -1;
+    if (test_var == -1) // node is a leaf
+        return node_index;
+
+    // distribute the other operators to the successors for their value of test_var and the star-edge
+    int test_var_size = g_variable_domain[pattern[test_var]];
+    vector<vector<pair<int, int> > > value_successors(test_var_size);
+    vector<pair<int, int> > star_successor;
+    for (size_t i = 0; i < op_and_pre_index.size(); ++i) {
+        const vector<pair<int, int> > &regression_preconditions =
+            operators[op_and_pre_index[i].first].get_regression_preconditions();
+        int pre_index = op_and_pre_index[i].second;
+        if (pre_index == regression_preconditions.size())
+            continue;
         const pair<int, int> &var_val = regression_preconditions[pre_index];
-
-        // setup node correctly or insert a new node if necessary
-        if (node->test_var == -1) { // node is a leaf
-            node->test_var = var_val.first;
-            int test_var_size = g_variable_domain[pattern[var_val.first]];
-            node->successors = new Node *[test_var_size];
-            node->var_size = test_var_size;
-            for (int i = 0; i < test_var_size; ++i) {
-                node->successors[i] = 0;
-            }
-        } else if (node->test_var > var_val.first) {
-            // The variable to test has been left out: must insert new node and treat it as the "node".
-            Node *new_node = new Node(var_val.first, g_variable_domain[pattern[var_val.first]]);
-            // The new node gets the left out variable as test_var.
-            *edge_from_parent = new_node;
-            new_node->star_successor = node;
-            node = new_node; // The new node is now the node of interest.
+        if (var_val.first == test_var) { // operator has a precondition on test_var
+            value_successors[var_val.second].push_back(make_pair(op_and_pre_index[i].first, pre_index + 1));
+        } else { // operator doesn't have a precondition on test_var, follow the *-edge
+            assert(var_val.first > test_var);
+            star_successor.push_back(op_and_pre_index[i]);
         }
+    }
 
-        // setup edge to the correct child (for which we want to call this function recursively)
-        Node **edge_to_child = 0;
-        if (node->test_var == var_val.first) { // operator has a precondition on test_var
-            edge_to_child = &node->successors[var_val.second];
-            ++pre_index;
-        } else { // operator doesn't have a precondition on test_var, follow/create *-edge
-            assert(node->test_var < var_val.first);
-            edge_to_child = &node->star_successor;
+    int successors = successor_table.size();
+    successor_table.resize(successors + test_var_size, -1);
+    nodes[node_index].var_size = test_var_size;
+    nodes[node_index].successors = successors;
+    for (int val = 0; val < test_var_size; ++val) {
+        if (!value_successors[val].empty()) {
+            int successor = build_recursively(operators, value_successors[val]);
+            successor_table[successors + val] = successor;
         }
-
-        build_recursively(op, pre_index, edge_to_child);
     }
+    if (!star_successor.empty()) {
+        int successor = build_recursively(operators, star_successor);
+        nodes[node_index].star_successor = successor;
+    }
+    return node_index;
 }
 
-void MatchTree::insert(const AbstractOperator &op) {
-    build_recursively(op, 0, &root);
-}
-
-void MatchTree::traverse(Node *node, const size_t state_index,
-                         vector<const AbstractOperator *> &applicable_operators) const {
+void MatchTree::traverse(int node_index, const size_t state_index,
+                         vector<int> &applicable_operators) const {
     /*
-      Note: different from the code that builds the match tree, we do
-      the test if node == 0 *before* calling traverse rather than *at
-      the start* of traverse since this turned out to be faster in
-      some informal experiments.
+      Note: we do the test whether a successor exists *before*
+      calling traverse rather than *at the start* of traverse since
+      this turned out to be faster in some informal experiments.
      */
 
+    const Node &node = nodes[node_index];
     applicable_operators.insert(applicable_operators.end(),
-                                node->applicable_operators.begin(),
-                                node->applicable_operators.end());
+                                node_operators.begin() + node.operators_begin,
+                                node_operators.begin() + node.operators_end);
 
     // leaf reached, return
-    if (node->test_var == -1)
+    if (node.test_var == -1)
         return;
 
-    int var_index = node->test_var;
+    int var_index = node.test_var;
     int temp = state_index / hash_multipliers[var_index];
-    int val = temp % node->var_size;
+    int val = temp % node.var_size;
 
-    if (node->successors[val] != 0) { // follow the correct successor-edge, if exists
-        traverse(node->successors[val], state_index, applicable_operators);
+    int successor = successor_table[node.successors + val];
+    if (successor != -1) { // follow the correct successor-edge, if exists
+        traverse(successor, state_index, applicable_operators);
     }
-    if (node->star_successor != 0) { // always follow the *-edge, if exists
-        traverse(node->star_successor, state_index, applicable_operators);
+    if (node.star_successor != -1) { // always follow the *-edge, if exists
+        traverse(node.star_successor, state_index, applicable_operators);
     }
 }
 
 void MatchTree::get_applicable_operators(size_t state_index,
-                                         vector<const AbstractOperator *> &applicable_operators) const {
-    if (root != 0)
-        traverse(root, state_index, applicable_operators);
+                                         vector<int> &applicable_operators) const {
+    if (!nodes.empty())
+        traverse(0, state_index, applicable_operators);
 }
 
-void MatchTree::_dump(Node *node) const {
-    if (node == 0) { // root == 0
+void MatchTree::_dump(int node_index, const vector<AbstractOperator> &operators) const {
+    if (node_index == -1) { // no nodes
         cout << "Empty MatchTree" << endl;
         return;
     }
+    const Node &node = nodes[node_index];
     cout << endl;
-    cout << "node->test_var = " << node->test_var << endl;
-    if (node->applicable_operators.empty())
+    cout << "node.test_var = " << node.test_var << endl;
+    if (node.operators_begin == node.operators_end)
         cout << "no applicable operators at this node" << endl;
     else {
-        cout << "applicable_operators.size() = " << node->applicable_operators.size() << endl;
-        for (size_t i = 0; i < node->applicable_operators.size(); ++i) {
-            node->applicable_operators[i]->dump(pattern);
+        cout << "applicable_operators.size() = " << node.operators_end - node.operators_begin << endl;
+        for (int i = node.operators_begin; i < node.operators_end; ++i) {
+            operators[node_operators[i]].dump(pattern);
         }
     }
-    if (node->test_var == -1) {
+    if (node.test_var == -1) {
         cout << "leaf node!" << endl;
-        assert(node->successors == 0);
-        assert(node->star_successor == 0);
+        assert(node.successors == -1);
+        assert(node.star_successor == -1);
     } else {
-        for (int i = 0; i < node->var_size; ++i) {
-            if (node->successors[i] == 0)
+        for (int i = 0; i < node.var_size; ++i) {
+            int successor = successor_table[node.successors + i];
+            if (successor == -1)
                 cout << "no child for value " << i << " of test_var" << endl;
             else {
                 cout << "recursive call for child with value " << i << " of test_var" << endl;
-                _dump(node->successors[i]);
-                cout << "back from recursive call (for successors[" << i << "]) to node with test_var = " << node->test_var << endl;
+                _dump(successor, operators);
+                cout << "back from recursive call (for successors[" << i << "]) to node with test_var = " << node.test_var << endl;
             }
         }
-        if (node->star_successor == 0)
+        if (node.star_successor == -1)
             cout << "no star_successor" << endl;
         else {
             cout << "recursive call for star_successor" << endl;
-            _dump(node->star_successor);
-            cout << "back from recursive call (for star_successor) to node with test_var = " << node->test_var << endl;
+            _dump(node.star_successor, operators);
+            cout << "back from recursive call (for star_successor) to node with test_var = " << node.test_var << endl;
         }
     }
 }
 
-void MatchTree::dump() const {
-    _dump(root);
+void MatchTree::dump(const vector<AbstractOperator> &operators) const {
+    _dump(nodes.empty() ? -1 : 0, operators);
 }
@@ -2,29 +2,46 @@
 #define PDBS_MATCH_TREE_H
 
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 // Implements a Successor Generator for abstract operators
 class AbstractOperator;
 class MatchTree {
-    struct Node;
+    /* The nodes are stored in one array and refer to each other by their index in it. The root is node 0 unless
+       there are no operators, in which case there are no nodes. */
+    struct Node {
+        int test_var; // variable which this node represents, -1 for leaves
+        int var_size;
+        int successors; // successor_table[successors + val] is the edge for value val of test_var
+        int star_successor; // star-edge (unspecified value for test_var)
+        // the operators of this node are node_operators[operators_begin] up to (excluding) [operators_end]
+        int operators_begin;
+        int operators_end;
+    };
     std::vector<int> pattern; // as in PDBHeuristic
     std::vector<size_t> hash_multipliers; // as in PDBHeuristic
-    Node *root;
-    void build_recursively(const AbstractOperator &op, int pre_index, Node **edge_from_parent); // called by insert
-    void traverse(Node *node, const size_t state_index,
-                  std::vector<const AbstractOperator *> &applicable_operators) const; // called by get_applicable_operators
-    void _dump(Node *node) const;
+    std::vector<Node> nodes;
+    std::vector<int> successor_table; // node indices, -1 for no successor
+    std::vector<int> node_operators; // operator numbers
+
+    /* Builds the subtree for the given operators, where the first precondition of each operator to be tested is
+       given by the second component. Returns the index of its root. */
+    int build_recursively(const std::vector<AbstractOperator> &operators,
+                          const std::vector<std::pair<int, int> > &op_and_pre_index);
+    void traverse(int node_index, const size_t state_index,
+                  std::vector<int> &applicable_operators) const; // called by get_applicable_operators
+    void _dump(int node_index, const std::vector<AbstractOperator> &operators) const;
 public:
-    MatchTree(const std::vector<int> &pattern, const std::vector<size_t> &hash_multipliers); // initialize empty match tree
+    // builds the match tree for the given abstract operators
+    MatchTree(const std::vector<int> &pattern, const std::vector<size_t> &hash_multipliers,
+              const std::vector<AbstractOperator> &operators);
     ~MatchTree();
-    void insert(const AbstractOperator &op); // inserts an abstract operator into the match tree, creating or enlarging it
 
-    // Extracts all applicable abstract operators for the abstract state given by state_index (the index is converted back
-    // to variable/values pairs)
-    void get_applicable_operators(size_t state_index,
-                                  std::vector<const AbstractOperator *> &applicable_operators) const;
-    void dump() const;
+    // Extracts the numbers (indices in the vector passed to the constructor) of all applicable abstract operators
+    // for the abstract state given by state_index (the index is converted back to variable/values pairs)
+    void get_applicable_operators(size_t state_index, std::vector<int> &applicable_operators) const;
+    void dump(const std::vector<AbstractOperator> &operators) const;
 };
 
 #endif
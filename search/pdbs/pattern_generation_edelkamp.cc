@@ -183,7 +183,7 @@ void PatternGenerationEdelkamp::evaluate(vector<double> &fitness_values) {
             opts.set<int>("cost_type", cost_type);
             opts.set<vector<vector<int> > >("patterns", pattern_collection);
             ZeroOnePDBsHeuristic *zoppch =
-                new ZeroOnePDBsHeuristic(opts);
+                new ZeroOnePDBsHeuristic(opts, false);
             fitness = zoppch->get_approx_mean_finite_h();
             // update the best heuristic found so far.
             if (fitness > best_fitness) {
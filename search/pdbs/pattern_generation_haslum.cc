@@ -11,6 +11,7 @@
 #include "../rng.h"
 #include "../state.h"
 #include "../successor_generator.h"
+#include "../thread_pool.h"
 #include "../timer.h"
 #include "../utilities.h"
 
@@ -18,6 +19,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -28,7 +30,8 @@ PatternGenerationHaslum::PatternGenerationHaslum(const Options &opts)
       collection_max_size(opts.get<int>("collection_max_size")),
       num_samples(opts.get<int>("num_samples")),
       min_improvement(opts.get<int>("min_improvement")),
-      cost_type(OperatorCost(opts.get<int>("cost_type"))) {
+      cost_type(OperatorCost(opts.get<int>("cost_type"))),
+      num_threads(opts.get<int>("threads")) {
     Timer timer;
     initialize();
     cout << "Pattern generation (Haslum et al.) time: " << timer << endl;
@@ -118,23 +121,19 @@ void PatternGenerationHaslum::sample_states(vector<State> &samples, double avera
     }
 }
 
-bool PatternGenerationHaslum::is_heuristic_improved(PDBHeuristic *pdb_heuristic,
-                                                    const State &sample) {
-    pdb_heuristic->evaluate(sample);
-    if (pdb_heuristic->is_dead_end()) {
+bool PatternGenerationHaslum::is_heuristic_improved(const PDBHeuristic &pdb_heuristic, const State &sample,
+                                                    int h_collection, const vector<int> &pdb_h_values,
+                                                    const vector<vector<int> > &max_additive_subsets) const {
+    int h_pattern = pdb_heuristic.get_distance(pdb_heuristic.hash_index(sample)); // h-value of the new pattern
+    if (h_pattern == -1) { // dead end
         return true;
     }
-    int h_pattern = pdb_heuristic->get_heuristic(); // h-value of the new pattern
-    vector<vector<PDBHeuristic *> > max_additive_subsets;
-    current_heuristic->get_max_additive_subsets(pdb_heuristic->get_pattern(), max_additive_subsets);
-    current_heuristic->evaluate(sample);
-    int h_collection = current_heuristic->get_heuristic(); // h-value of the current collection heuristic
     for (size_t k = 0; k < max_additive_subsets.size(); ++k) { // for each max additive subset...
         int h_subset = 0;
         for (size_t l = 0; l < max_additive_subsets[k].size(); ++l) { // ...calculate its h-value
-            max_additive_subsets[k][l]->evaluate(sample);
-            assert(!max_additive_subsets[k][l]->is_dead_end());
-            h_subset += max_additive_subsets[k][l]->get_heuristic();
+            int h = pdb_h_values[max_additive_subsets[k][l]];
+            assert(h != -1);
+            h_subset += h;
         }
         if (h_pattern + h_subset > h_collection) {
             // return true if one max additive subest is found for which the condition is met
@@ -144,6 +143,100 @@ bool PatternGenerationHaslum::is_heuristic_improved(PDBHeuristic *pdb_heuristic,
     return false;
 }
 
+class PatternGenerationHaslum::CandidateEvaluationJob : public ThreadPool::Job {
+    const PatternGenerationHaslum &generator;
+    const vector<PDBHeuristic *> &candidate_pdbs;
+    const vector<State> &samples;
+    const vector<int> &h_collection; // for each sample
+    const vector<vector<int> > &pdb_h_values; // for each sample and PDB of the current collection
+    const map<const PDBHeuristic *, int> &pdb_numbers; // of the PDBs of the current collection
+    vector<int> &counts;
+    int next_candidate;
+    int best_count;
+
+    void evaluate_candidate(int candidate) {
+        const PDBHeuristic &pdb_heuristic = *candidate_pdbs[candidate];
+        vector<vector<PDBHeuristic *> > subsets;
+        generator.current_heuristic->get_max_additive_subsets(pdb_heuristic.get_pattern(), subsets);
+        vector<vector<int> > max_additive_subsets(subsets.size());
+        for (size_t k = 0; k < subsets.size(); ++k) {
+            for (size_t l = 0; l < subsets[k].size(); ++l)
+                max_additive_subsets[k].push_back(pdb_numbers.find(subsets[k][l])->second);
+        }
+
+        int count = 0;
+        int num_samples = samples.size();
+        for (int j = 0; j < num_samples; ++j) {
+            // Stop if even improving all remaining samples would not reach the best count so far.
+            if (count + (num_samples - j) < best_count) {
+                counts[candidate] = -1;
+                return;
+            }
+            if (generator.is_heuristic_improved(pdb_heuristic, samples[j], h_collection[j], pdb_h_values[j],
+                                                max_additive_subsets))
+                ++count;
+        }
+        counts[candidate] = count;
+
+        // best_count = max(best_count, count), but other threads may change best_count in between
+        while (true) {
+            int old_best_count = best_count;
+            if (count <= old_best_count ||
+                __sync_bool_compare_and_swap(&best_count, old_best_count, count))
+                break;
+        }
+    }
+public:
+    CandidateEvaluationJob(const PatternGenerationHaslum &generator_,
+                           const vector<PDBHeuristic *> &candidate_pdbs_, const vector<State> &samples_,
+                           const vector<int> &h_collection_, const vector<vector<int> > &pdb_h_values_,
+                           const map<const PDBHeuristic *, int> &pdb_numbers_, vector<int> &counts_)
+        : generator(generator_), candidate_pdbs(candidate_pdbs_), samples(samples_),
+          h_collection(h_collection_), pdb_h_values(pdb_h_values_), pdb_numbers(pdb_numbers_),
+          counts(counts_), next_candidate(0), best_count(0) {
+    }
+
+    virtual void run(int) {
+        // Every thread takes the next candidate that nobody has started yet.
+        while (true) {
+            int i = __sync_fetch_and_add(&next_candidate, 1);
+            if (i >= candidate_pdbs.size())
+                break;
+            if (candidate_pdbs[i] != 0)
+                evaluate_candidate(i);
+        }
+    }
+};
+
+void PatternGenerationHaslum::evaluate_candidates(const vector<PDBHeuristic *> &candidate_pdbs,
+                                                  const vector<State> &samples, vector<int> &counts) {
+    // The h-values of the current collection and its PDBs are the same for all candidates.
+    const vector<PDBHeuristic *> &pattern_databases = current_heuristic->get_pattern_databases();
+    map<const PDBHeuristic *, int> pdb_numbers;
+    for (size_t i = 0; i < pattern_databases.size(); ++i)
+        pdb_numbers[pattern_databases[i]] = i;
+    vector<int> h_collection(samples.size());
+    vector<vector<int> > pdb_h_values(samples.size());
+    for (size_t j = 0; j < samples.size(); ++j) {
+        current_heuristic->evaluate(samples[j]);
+        h_collection[j] = current_heuristic->get_heuristic();
+        for (size_t i = 0; i < pattern_databases.size(); ++i) {
+            const PDBHeuristic *pdb = pattern_databases[i];
+            pdb_h_values[j].push_back(pdb->get_distance(pdb->hash_index(samples[j])));
+        }
+    }
+
+    counts.assign(candidate_pdbs.size(), 0);
+    CandidateEvaluationJob job(*this, candidate_pdbs, samples, h_collection, pdb_h_values, pdb_numbers, counts);
+    int threads = min<size_t>(num_threads, candidate_pdbs.size());
+    if (threads <= 1) {
+        job.run(0);
+    } else {
+        ThreadPool thread_pool(threads);
+        thread_pool.run(job);
+    }
+}
+
 void PatternGenerationHaslum::hill_climbing(double average_operator_cost,
                                             vector<vector<int> > &initial_candidate_patterns) {
     Timer timer;
@@ -173,47 +266,40 @@ void PatternGenerationHaslum::hill_climbing(double average_operator_cost,
 
         // For the new candidate patterns check whether they already have been candidates before and
         // thus already a PDB has been created an inserted into candidate_pdbs.
+        vector<vector<int> > new_patterns;
         for (size_t i = 0; i < new_candidates.size(); ++i) {
             if (generated_patterns.count(new_candidates[i]) == 0) {
-                Options opts;
-                opts.set<int>("cost_type", cost_type);
-                opts.set<vector<int> >("pattern", new_candidates[i]);
-                candidate_pdbs.push_back(new PDBHeuristic(opts, false));
-                max_pdb_size = max(max_pdb_size,
-                                   candidate_pdbs.back()->get_size());
+                new_patterns.push_back(new_candidates[i]);
                 generated_patterns.insert(new_candidates[i]);
             }
         }
+        size_t num_old_candidates = candidate_pdbs.size();
+        build_pdbs(cost_type, new_patterns, vector<vector<int> >(), num_threads, false, candidate_pdbs);
+        for (size_t i = num_old_candidates; i < candidate_pdbs.size(); ++i)
+            max_pdb_size = max(max_pdb_size, candidate_pdbs[i]->get_size());
+
+        // If a candidate's size added to the current collection's size exceeds the maximum
+        // collection size, then delete the PDB and let the PDB's entry point to a null reference
+        for (size_t i = 0; i < candidate_pdbs.size(); ++i) {
+            if (candidate_pdbs[i] != 0 &&
+                current_heuristic->get_size() + candidate_pdbs[i]->get_size() > collection_max_size) {
+                delete candidate_pdbs[i];
+                candidate_pdbs[i] = 0;
+            }
+        }
 
         // TODO: The original implementation by Haslum et al. uses astar to compute h values for
         // the sample states only instead of generating all PDBs.
+        // TODO: The original implementation by Haslum et al. uses m/t as a statistical
+        // confidence intervall to stop the astar-search (which they use, see above) earlier.
+        vector<int> counts;
+        evaluate_candidates(candidate_pdbs, samples, counts);
+
+        // Search for the best improving pattern/pdb; among equally good ones, take the first.
         int improvement = 0; // best improvement (= hightest count) for a pattern so far
         int best_pdb_index = 0;
-
-        // Iterate over all candidates and search for the best improving pattern/pdb
         for (size_t i = 0; i < candidate_pdbs.size(); ++i) {
-            PDBHeuristic *pdb_heuristic = candidate_pdbs[i];
-            if (pdb_heuristic == 0) { // candidate pattern is too large
-                continue;
-            }
-            // If a candidate's size added to the current collection's size exceeds the maximum
-            // collection size, then delete the PDB and let the PDB's entry point to a null reference
-            if (current_heuristic->get_size() + pdb_heuristic->get_size() > collection_max_size) {
-                delete pdb_heuristic;
-                candidate_pdbs[i] = 0;
-                continue;
-            }
-
-            // Calculate the "counting approximation" for all sample states: count the number of
-            // samples for which the current pattern collection heuristic would be improved
-            // if the new pattern was included into it.
-            // TODO: The original implementation by Haslum et al. uses m/t as a statistical
-            // confidence intervall to stop the astar-search (which they use, see above) earlier.
-            int count = 0;
-            for (size_t j = 0; j < samples.size(); ++j) {
-                if (is_heuristic_improved(pdb_heuristic, samples[j]))
-                    ++count;
-            }
+            int count = counts[i];
             if (count > improvement) {
                 improvement = count;
                 best_pdb_index = i;
@@ -240,18 +326,18 @@ void PatternGenerationHaslum::hill_climbing(double average_operator_cost,
             break;
         }
 
-        // add the best pattern to the CanonicalPDBsHeuristic
-        const vector<int> &best_pattern = candidate_pdbs[best_pdb_index]->get_pattern();
+        // add the best pattern to the CanonicalPDBsHeuristic, which takes over its PDB
+        PDBHeuristic *best_pdb = candidate_pdbs[best_pdb_index];
+        const vector<int> &best_pattern = best_pdb->get_pattern();
         cout << "found a better pattern with improvement " << improvement << endl;
         cout << "pattern: " << best_pattern << endl;
-        current_heuristic->add_pattern(best_pattern);
+        current_heuristic->add_pdb(best_pdb);
 
         // clear current new_candidates and get successors for next iteration
         new_candidates.clear();
         generate_candidate_patterns(best_pattern, new_candidates);
 
         // remove from candidate_pdbs the added PDB
-        delete candidate_pdbs[best_pdb_index];
         candidate_pdbs[best_pdb_index] = 0;
 
         cout << "Hill-climbing time so far: " << timer << endl;
@@ -280,7 +366,7 @@ void PatternGenerationHaslum::initialize() {
     Options opts;
     opts.set<int>("cost_type", cost_type);
     opts.set<vector<vector<int> > >("patterns", initial_pattern_collection);
-    current_heuristic = new CanonicalPDBsHeuristic(opts);
+    current_heuristic = new CanonicalPDBsHeuristic(opts, false);
     current_heuristic->evaluate(*g_initial_state);
     if (current_heuristic->is_dead_end())
         return;
@@ -311,6 +397,8 @@ static ScalarEvaluator *_parse(OptionParser &parser) {
     parser.add_option<int>("num_samples", 1000, "number of samples");
     parser.add_option<int>("min_improvement", 10,
                            "minimum improvement while hill climbing");
+    parser.add_option<int>("threads", 1,
+                           "number of threads for building and evaluating the candidate pdbs");
 
     Heuristic::add_options_to_parser(parser);
     Options opts = parser.parse();
@@ -323,6 +411,8 @@ static ScalarEvaluator *_parse(OptionParser &parser) {
         parser.error("minimum improvement must be at least 1");
     if (opts.get<int>("min_improvement") > opts.get<int>("num_samples"))
         parser.error("minimum improvement must not be higher than number of samples");
+    if (opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
 
     if (parser.dry_run())
         return 0;
@@ -17,6 +17,7 @@ class PatternGenerationHaslum {
     const int num_samples;
     const int min_improvement; // minimal improvement required for hill climbing to continue search
     const OperatorCost cost_type;
+    const int num_threads; // for building and evaluating the candidate PDBs
     CanonicalPDBsHeuristic *current_heuristic;
 
     int num_rejected; // for stats only
@@ -35,20 +36,31 @@ class PatternGenerationHaslum {
        num_samples of sample states. */
     void sample_states(std::vector<State> &samples, double average_operator_costs);
 
-    /* Returns true iff the h-value of the new pattern (from pdb_heuristic) plus the h-value of all
-       additive subsets from the current pattern collection heuristic if the new pattern was added
-       to it is greater than the the h-value of the current pattern collection. */
-    bool is_heuristic_improved(PDBHeuristic *pdb_heuristic, const State &sample);
+    /* Returns true iff the h-value of the new pattern (from pdb_heuristic) plus the h-value of one of the
+       additive subsets from the current pattern collection heuristic if the new pattern was added to it is
+       greater than the the h-value of the current pattern collection (h_collection). The subsets are given
+       as indices of the PDBs of the current collection, whose h-values for the sample are pdb_h_values.
+       Does not change any heuristic, so that several threads can call it at once. */
+    bool is_heuristic_improved(const PDBHeuristic &pdb_heuristic, const State &sample, int h_collection,
+                               const std::vector<int> &pdb_h_values,
+                               const std::vector<std::vector<int> > &max_additive_subsets) const;
+
+    /* Computes the "counting approximation" of the improvement of each candidate, i.e. the number of samples
+       for which is_heuristic_improved holds, using num_threads threads. Candidates that are 0 are skipped. The
+       counting stops early for candidates that cannot reach the highest count found so far anymore: their count
+       is set to -1. So the candidates with the highest count are always counted completely and the result does
+       not depend on the number of threads. */
+    void evaluate_candidates(const std::vector<PDBHeuristic *> &candidate_pdbs, const std::vector<State> &samples,
+                             std::vector<int> &counts);
+    class CandidateEvaluationJob;
+    friend class CandidateEvaluationJob;
 
     /* This is the core algorithm of this class. As soon as after an iteration, the improvement (according
        to the "counting approximation") is smaller than the minimal required improvement, the search is
        stopped. This method uses a vector to store PDBs to avoid recomputation of the same PDBs later.
        This is quite a large time gain, but may use too much memory. Also a set is used to store all
-       patterns in their "normal form" for duplicate detection.
-       TODO: This method computes all PDBs already for candidate iteration, but for each call of
-       add_pattern for the current CanonicalPDBsHeuristic, only the pattern is passed as an argument
-       and in CanonicalPDBsHeuristic, the PDB is *again* built. One could possibly avoid this by
-       passing the PDB and adapt CanonicalPDBsHeuristic accordingly. */
+       patterns in their "normal form" for duplicate detection. The PDB of the best candidate is moved
+       into the current CanonicalPDBsHeuristic instead of being built again. */
     void hill_climbing(double average_operator_costs, std::vector<std::vector<int> > &initial_candidate_patterns);
 
     /* Initializes everything for the hill climbing algorithm. Note that the initial pattern collection
@@ -0,0 +1,171 @@
+#include "pdb_collection_evaluator.h"
+
+#include "pdb_heuristic.h"
+
+#include "../state.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <map>
+#include <vector>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define PDB_USE_AVX2 1
+#include <immintrin.h>
+#else
+#define PDB_USE_AVX2 0
+#endif
+
+using namespace std;
+
+static const int BLOCK_SIZE = 8;
+
+#if PDB_USE_AVX2
+/* Computes the abstract state indices of all PDBs with the blocks of PDBCollectionEvaluator. Indices fit into
+   32 bits since the number of abstract states of a PDB does. */
+__attribute__((target("avx2")))
+static void compute_indices_avx2(const int *state_values, const vector<int> &block_begin, const int *vars,
+                                 const int *multipliers, int num_pdbs, size_t *indices) {
+    int num_blocks = block_begin.size() - 1;
+    int block_indices[BLOCK_SIZE];
+    for (int b = 0; b < num_blocks; ++b) {
+        __m256i index = _mm256_setzero_si256();
+        for (int pos = block_begin[b]; pos < block_begin[b + 1]; pos += BLOCK_SIZE) {
+            __m256i step_vars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(vars + pos));
+            __m256i step_multipliers = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(multipliers + pos));
+            __m256i values = _mm256_i32gather_epi32(state_values, step_vars, sizeof(int));
+            index = _mm256_add_epi32(index, _mm256_mullo_epi32(values, step_multipliers));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(block_indices), index);
+        int end = min(BLOCK_SIZE, num_pdbs - b * BLOCK_SIZE);
+        for (int i = 0; i < end; ++i)
+            indices[b * BLOCK_SIZE + i] = block_indices[i];
+    }
+}
+#endif
+
+PDBCollectionEvaluator::PDBCollectionEvaluator()
+    : use_avx2(false) {
+    pattern_begin.push_back(0);
+    block_begin.push_back(0);
+    clique_begin.push_back(0);
+}
+
+PDBCollectionEvaluator::~PDBCollectionEvaluator() {
+}
+
+void PDBCollectionEvaluator::set_collection(const vector<PDBHeuristic *> &pattern_databases,
+                                            const vector<vector<PDBHeuristic *> > &cliques) {
+    pdbs.assign(pattern_databases.begin(), pattern_databases.end());
+    pattern_begin.clear();
+    index_vars.clear();
+    index_multipliers.clear();
+    map<const PDBHeuristic *, int> pdb_numbers;
+    for (size_t i = 0; i < pdbs.size(); ++i) {
+        pdb_numbers[pdbs[i]] = i;
+        pattern_begin.push_back(index_vars.size());
+        const vector<int> &pattern = pdbs[i]->get_pattern();
+        const vector<size_t> &hash_multipliers = pdbs[i]->get_hash_multipliers();
+        index_vars.insert(index_vars.end(), pattern.begin(), pattern.end());
+        index_multipliers.insert(index_multipliers.end(), hash_multipliers.begin(), hash_multipliers.end());
+    }
+    pattern_begin.push_back(index_vars.size());
+
+#if PDB_USE_AVX2
+    // The gathers compute indices in 32-bit lanes.
+    use_avx2 = __builtin_cpu_supports("avx2");
+    for (size_t i = 0; i < pdbs.size(); ++i)
+        if (pdbs[i]->get_size() > static_cast<size_t>(numeric_limits<int>::max()))
+            use_avx2 = false;
+#endif
+    block_begin.clear();
+    block_vars.clear();
+    block_multipliers.clear();
+    for (size_t first = 0; first < pdbs.size(); first += BLOCK_SIZE) {
+        block_begin.push_back(block_vars.size());
+        size_t end = min(first + BLOCK_SIZE, pdbs.size());
+        int steps = 0;
+        for (size_t i = first; i < end; ++i)
+            steps = max(steps, pattern_begin[i + 1] - pattern_begin[i]);
+        // Padding reads variable 0 with multiplier 0.
+        for (int k = 0; k < steps; ++k) {
+            for (size_t i = first; i < first + BLOCK_SIZE; ++i) {
+                if (i < end && k < pattern_begin[i + 1] - pattern_begin[i]) {
+                    block_vars.push_back(index_vars[pattern_begin[i] + k]);
+                    block_multipliers.push_back(index_multipliers[pattern_begin[i] + k]);
+                } else {
+                    block_vars.push_back(0);
+                    block_multipliers.push_back(0);
+                }
+            }
+        }
+    }
+    block_begin.push_back(block_vars.size());
+
+    clique_begin.clear();
+    clique_members.clear();
+    for (size_t i = 0; i < cliques.size(); ++i) {
+        clique_begin.push_back(clique_members.size());
+        for (size_t j = 0; j < cliques[i].size(); ++j) {
+            assert(pdb_numbers.count(cliques[i][j]));
+            clique_members.push_back(pdb_numbers[cliques[i][j]]);
+        }
+    }
+    clique_begin.push_back(clique_members.size());
+
+    indices.resize(pdbs.size());
+    h_values.resize(pdbs.size());
+}
+
+void PDBCollectionEvaluator::compute_indices(const State &state) {
+    const int *vars = index_vars.empty() ? 0 : &index_vars[0];
+    const size_t *multipliers = index_multipliers.empty() ? 0 : &index_multipliers[0];
+    int num_pdbs = pdbs.size();
+    for (int i = 0; i < num_pdbs; ++i) {
+        size_t index = 0;
+        int end = pattern_begin[i + 1];
+        for (int j = pattern_begin[i]; j < end; ++j)
+            index += multipliers[j] * state[vars[j]];
+        indices[i] = index;
+    }
+}
+
+int PDBCollectionEvaluator::evaluate(const State &state) {
+    int num_pdbs = pdbs.size();
+
+    // Compute the abstract state indices of all PDBs.
+#if PDB_USE_AVX2
+    if (use_avx2)
+        compute_indices_avx2(state.get_buffer(), block_begin, block_vars.empty() ? 0 : &block_vars[0],
+                             block_multipliers.empty() ? 0 : &block_multipliers[0], num_pdbs,
+                             indices.empty() ? 0 : &indices[0]);
+    else
+        compute_indices(state);
+#else
+    compute_indices(state);
+#endif
+
+    for (int i = 0; i < num_pdbs; ++i)
+        pdbs[i]->prefetch_distance(indices[i]);
+
+    for (int i = 0; i < num_pdbs; ++i) {
+        int h = pdbs[i]->get_distance(indices[i]);
+        if (h == -1)
+            return -1;
+        h_values[i] = h;
+    }
+
+    // if we have an empty collection, then there is one empty clique
+    assert(clique_begin.size() > 1);
+    int max_h = 0;
+    int num_cliques = clique_begin.size() - 1;
+    for (int i = 0; i < num_cliques; ++i) {
+        int clique_h = 0;
+        int end = clique_begin[i + 1];
+        for (int j = clique_begin[i]; j < end; ++j)
+            clique_h += h_values[clique_members[j]];
+        max_h = max(max_h, clique_h);
+    }
+    return max_h;
+}
@@ -0,0 +1,61 @@
+#ifndef PDBS_PDB_COLLECTION_EVALUATOR_H
+#define PDBS_PDB_COLLECTION_EVALUATOR_H
+
+#include <cstddef>
+#include <vector>
+
+class PDBHeuristic;
+class State;
+
+/* Evaluates all PDBs of a collection on a state at once and combines their h-values into the maximum over some
+   cliques of the sum of the h-values in the clique (the canonical heuristic function; with a single clique
+   containing all PDBs, this is their sum).
+
+   Instead of calling evaluate on each PDB, the patterns of all PDBs are flattened into one table of variables and
+   hash multipliers, so that the abstract state indices of all PDBs are computed in one loop over contiguous
+   memory. On processors with AVX2, the indices of eight PDBs are computed at once: their patterns are padded to
+   the same length (with multiplier 0), and each step gathers the values of one variable of each of the eight
+   patterns from the state. Then the distance table entries of all PDBs are prefetched before any of them is read,
+   so that the cache misses of the lookups overlap. The result is the same as evaluating the PDBs one by one.
+
+   The evaluator refers to the PDBs, so it must be set up again whenever the collection or its cliques change. */
+class PDBCollectionEvaluator {
+    std::vector<const PDBHeuristic *> pdbs;
+
+    // The variables and hash multipliers of pdbs[i] are at positions pattern_begin[i] up to (excluding)
+    // pattern_begin[i + 1] of index_vars and index_multipliers.
+    std::vector<int> pattern_begin;
+    std::vector<int> index_vars;
+    std::vector<size_t> index_multipliers;
+
+    // The same for the AVX2 version, by blocks of eight PDBs (the last one filled up with empty patterns): step k
+    // of block b uses the eight entries of block_vars and block_multipliers at position block_begin[b] + 8 * k.
+    // The steps of block b end at block_begin[b + 1].
+    bool use_avx2;
+    std::vector<int> block_begin;
+    std::vector<int> block_vars;
+    std::vector<int> block_multipliers;
+
+    // The PDBs of clique i are pdbs[clique_members[j]] for j from clique_begin[i] up to (excluding)
+    // clique_begin[i + 1].
+    std::vector<int> clique_begin;
+    std::vector<int> clique_members;
+
+    // Scratch space for evaluate, indexed like pdbs.
+    std::vector<size_t> indices;
+    std::vector<int> h_values;
+
+    // Computes the abstract state indices of all PDBs into indices without AVX2.
+    void compute_indices(const State &state);
+public:
+    PDBCollectionEvaluator();
+    ~PDBCollectionEvaluator();
+
+    void set_collection(const std::vector<PDBHeuristic *> &pattern_databases,
+                        const std::vector<std::vector<PDBHeuristic *> > &cliques);
+
+    // Returns -1 (dead end) if some PDB of the collection (not only of some clique) is a dead end.
+    int evaluate(const State &state);
+};
+
+#endif
@@ -6,8 +6,11 @@
 #include "../globals.h"
 #include "../operator.h"
 #include "../plugin.h"
+#include "../exact_timer.h"
+#include "../option_parser.h"
 #include "../priority_queue.h"
 #include "../state.h"
+#include "../thread_pool.h"
 #include "../timer.h"
 #include "../utilities.h"
 
@@ -15,19 +18,31 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <limits>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace std;
 
 AbstractOperator::AbstractOperator(const vector<pair<int, int> > &prev_pairs,
                                    const vector<pair<int, int> > &pre_pairs,
-                                   const vector<pair<int, int> > &eff_pairs, int c,
+                                   const vector<pair<int, int> > &eff_pairs,
+                                   const vector<pair<int, int> > &free_effects, int c,
                                    const vector<size_t> &hash_multipliers)
     : cost(c), regression_preconditions(prev_pairs) {
     regression_preconditions.insert(regression_preconditions.end(), eff_pairs.begin(), eff_pairs.end());
+    regression_preconditions.insert(regression_preconditions.end(),
+                                    free_effects.begin(), free_effects.end());
     sort(regression_preconditions.begin(), regression_preconditions.end()); // for MatchTree construction
     for (size_t i = 1; i < regression_preconditions.size(); ++i) {
         assert(regression_preconditions[i].first != regression_preconditions[i - 1].first);
@@ -43,6 +58,13 @@ AbstractOperator::AbstractOperator(const vector<pair<int, int> > &prev_pairs,
         size_t effect = (new_val - old_val) * hash_multipliers[var];
         hash_effect += effect;
     }
+    for (size_t i = 0; i < free_effects.size(); ++i) {
+        int var = free_effects[i].first;
+        free_variables.push_back(var);
+        // the free variable changes from its effect value to 0
+        hash_effect -= free_effects[i].second * hash_multipliers[var];
+    }
+    sort(free_variables.begin(), free_variables.end());
 }
 
 AbstractOperator::~AbstractOperator() {
@@ -56,13 +78,17 @@ void AbstractOperator::dump(const vector<int> &pattern) const {
              << g_variable_name[pattern[regression_preconditions[i].first]] << ", Index: "
              << i << ") Value: " << regression_preconditions[i].second << endl;
     }
+    cout << "Free variables:";
+    for (size_t i = 0; i < free_variables.size(); ++i)
+        cout << " " << free_variables[i];
+    cout << endl;
     cout << "Hash effect:" << hash_effect << endl;
 }
 
 PDBHeuristic::PDBHeuristic(
     const Options &opts, bool dump,
     const vector<int> &op_costs)
-    : Heuristic(opts) {
+    : Heuristic(opts), entry_size(4), distances(0), mapped_file(0), mapped_file_size(0) {
     verify_no_axioms_no_cond_effects();
 
     if (op_costs.empty()) { // if no operator costs are specified, use default operator costs
@@ -77,11 +103,17 @@ PDBHeuristic::PDBHeuristic(
 
     Timer timer;
     set_pattern(opts.get_list<int>("pattern"));
-    if (dump)
-        cout << "PDB construction time: " << timer << endl;
+    if (dump) {
+        if (is_loaded_from_file())
+            cout << "PDB loaded from file in " << timer << endl;
+        else
+            cout << "PDB construction time: " << timer << endl;
+    }
 }
 
 PDBHeuristic::~PDBHeuristic() {
+    if (mapped_file)
+        munmap(mapped_file, mapped_file_size);
 }
 
 void PDBHeuristic::verify_no_axioms_no_cond_effects() const {
@@ -118,10 +150,12 @@ void PDBHeuristic::multiply_out(int pos, int op_no, int cost, vector<pair<int, i
                                 vector<pair<int, int> > &pre_pairs,
                                 vector<pair<int, int> > &eff_pairs,
                                 const vector<pair<int, int> > &effects_without_pre,
+                                const vector<pair<int, int> > &free_effects,
                                 vector<AbstractOperator> &operators) {
     if (pos == effects_without_pre.size()) { // all effects withouth precondition have been checked, insert op
-        if (!eff_pairs.empty()) {
-            operators.push_back(AbstractOperator(prev_pairs, pre_pairs, eff_pairs, cost, hash_multipliers));
+        if (!eff_pairs.empty() || !free_effects.empty()) {
+            operators.push_back(AbstractOperator(prev_pairs, pre_pairs, eff_pairs, free_effects, cost,
+                                                 hash_multipliers));
             relevant_operators[op_no] = true;
         }
     } else {
@@ -136,7 +170,7 @@ void PDBHeuristic::multiply_out(int pos, int op_no, int cost, vector<pair<int, i
                 prev_pairs.push_back(make_pair(var, i));
             }
             multiply_out(pos + 1, op_no, cost, prev_pairs, pre_pairs, eff_pairs,
-                         effects_without_pre, operators);
+                         effects_without_pre, free_effects, operators);
             if (i != eff) {
                 pre_pairs.pop_back();
                 eff_pairs.pop_back();
@@ -154,6 +188,7 @@ void PDBHeuristic::build_abstract_operators(
     vector<pair<int, int> > pre_pairs; // all variable value pairs that are a precondition (value != -1)
     vector<pair<int, int> > eff_pairs; // all variable value pairs that are an effect
     vector<pair<int, int> > effects_without_pre; // all variable value pairs that are a precondition (value = -1)
+    vector<pair<int, int> > free_effects; // as effects_without_pre, but for variables with more than two values
     const vector<Prevail> &prevail = op.get_prevail();
     const vector<PrePost> &pre_post = op.get_pre_post();
     for (size_t i = 0; i < prevail.size(); ++i) {
@@ -162,16 +197,163 @@ void PDBHeuristic::build_abstract_operators(
         }
     }
     for (size_t i = 0; i < pre_post.size(); ++i) {
-        if (variable_to_index[pre_post[i].var] != -1) {
+        int var = pre_post[i].var;
+        if (variable_to_index[var] != -1) {
             if (pre_post[i].pre != -1) {
-                pre_pairs.push_back(make_pair(variable_to_index[pre_post[i].var], pre_post[i].pre));
-                eff_pairs.push_back(make_pair(variable_to_index[pre_post[i].var], pre_post[i].post));
+                pre_pairs.push_back(make_pair(variable_to_index[var], pre_post[i].pre));
+                eff_pairs.push_back(make_pair(variable_to_index[var], pre_post[i].post));
+            } else if (g_variable_domain[var] <= 2) {
+                effects_without_pre.push_back(make_pair(variable_to_index[var], pre_post[i].post));
             } else {
-                effects_without_pre.push_back(make_pair(variable_to_index[pre_post[i].var], pre_post[i].post));
+                free_effects.push_back(make_pair(variable_to_index[var], pre_post[i].post));
             }
         }
     }
-    multiply_out(0, op_no, operator_costs[op_no], prev_pairs, pre_pairs, eff_pairs, effects_without_pre, operators);
+    multiply_out(0, op_no, operator_costs[op_no], prev_pairs, pre_pairs, eff_pairs, effects_without_pre,
+                 free_effects, operators);
+}
+
+/* A queue for the regression search if all abstract operators have the same cost, so that it is a breadth-first
+   search: all keys pushed are the key of the last entry popped (for cost 0) or that key plus the cost. Like
+   TwoBucketQueue, it only keeps the entries of these two keys. */
+class BreadthFirstQueue {
+    vector<size_t> current_layer;
+    vector<size_t> next_layer;
+    int current_key;
+    int next_key;
+public:
+    typedef pair<int, size_t> Entry;
+
+    BreadthFirstQueue() : current_key(0), next_key(0) {
+    }
+
+    void push(int key, size_t value) {
+        if (key == current_key) {
+            current_layer.push_back(value);
+        } else {
+            assert(next_layer.empty() || key == next_key);
+            next_key = key;
+            next_layer.push_back(value);
+        }
+    }
+
+    Entry pop() {
+        if (current_layer.empty()) {
+            assert(!next_layer.empty());
+            current_layer.swap(next_layer);
+            current_key = next_key;
+        }
+        size_t value = current_layer.back();
+        current_layer.pop_back();
+        return make_pair(current_key, value);
+    }
+
+    bool empty() const {
+        return current_layer.empty() && next_layer.empty();
+    }
+};
+
+template<class Queue, class Entry>
+bool PDBHeuristic::regression_search(const vector<AbstractOperator> &operators, const MatchTree &match_tree,
+                                     Queue &queue, Entry *h_values) const {
+    const int dead_end = numeric_limits<Entry>::max();
+    vector<int> domain_sizes;
+    for (size_t i = 0; i < pattern.size(); ++i)
+        domain_sizes.push_back(g_variable_domain[pattern[i]]);
+
+    vector<int> applicable_operators;
+    vector<int> free_values;
+    while (!queue.empty()) {
+        pair<int, size_t> node = queue.pop();
+        int distance = node.first;
+        size_t state_index = node.second;
+        if (distance > h_values[state_index]) {
+            continue;
+        }
+
+        // regress abstract_state
+        applicable_operators.clear();
+        match_tree.get_applicable_operators(state_index, applicable_operators);
+        for (size_t i = 0; i < applicable_operators.size(); ++i) {
+            const AbstractOperator &op = operators[applicable_operators[i]];
+            const vector<int> &free_variables = op.get_free_variables();
+            int alternative_cost = distance + op.get_cost();
+            /* A cost that does not fit into an Entry is only a problem if it is stored, i.e. for the
+               predecessors that have not been reached yet. They are exactly those whose value is larger than
+               dead_end - 1. */
+            bool too_large = alternative_cost >= dead_end;
+            if (too_large)
+                alternative_cost = dead_end - 1;
+            size_t predecessor = state_index + op.get_hash_effect();
+
+            if (free_variables.empty()) {
+                if (alternative_cost < h_values[predecessor]) {
+                    if (too_large)
+                        return false;
+                    h_values[predecessor] = alternative_cost;
+                    queue.push(alternative_cost, predecessor);
+                }
+                continue;
+            }
+
+            /* Enumerate the predecessors for all values of the free variables: the values of the first one in
+               the inner loop, the values of the others counting up like an odometer. */
+            int inner_size = domain_sizes[free_variables[0]];
+            size_t inner_multiplier = hash_multipliers[free_variables[0]];
+            if (free_variables.size() > 1)
+                free_values.assign(free_variables.size(), 0);
+            while (true) {
+                size_t inner_predecessor = predecessor;
+                for (int val = 0; val < inner_size; ++val, inner_predecessor += inner_multiplier) {
+                    if (alternative_cost < h_values[inner_predecessor]) {
+                        if (too_large)
+                            return false;
+                        h_values[inner_predecessor] = alternative_cost;
+                        queue.push(alternative_cost, inner_predecessor);
+                    }
+                }
+                size_t pos = 1;
+                for (; pos < free_variables.size(); ++pos) {
+                    int var = free_variables[pos];
+                    if (++free_values[pos] < domain_sizes[var]) {
+                        predecessor += hash_multipliers[var];
+                        break;
+                    }
+                    predecessor -= (free_values[pos] - 1) * hash_multipliers[var];
+                    free_values[pos] = 0;
+                }
+                if (pos >= free_variables.size())
+                    break;
+            }
+        }
+    }
+    return true;
+}
+
+template<class Entry>
+bool PDBHeuristic::compute_distances(const vector<AbstractOperator> &operators, const MatchTree &match_tree,
+                                     const vector<size_t> &goal_states, bool unit_cost) {
+    // Release the table of a previous try first, so that only one table is allocated at a time.
+    vector<unsigned char>().swap(table_storage);
+    table_storage.resize(num_states * sizeof(Entry));
+    entry_size = sizeof(Entry);
+    Entry *h_values = table_storage.empty() ? 0 : reinterpret_cast<Entry *>(&table_storage[0]);
+    fill(h_values, h_values + num_states, numeric_limits<Entry>::max());
+    for (size_t i = 0; i < goal_states.size(); ++i)
+        h_values[goal_states[i]] = 0;
+    distances = table_storage.empty() ? 0 : &table_storage[0];
+
+    if (unit_cost) {
+        BreadthFirstQueue queue;
+        for (size_t i = 0; i < goal_states.size(); ++i)
+            queue.push(0, goal_states[i]);
+        return regression_search(operators, match_tree, queue, h_values);
+    } else {
+        AdaptiveQueue<size_t> queue; // (first implicit entry: priority,) second entry: index for an abstract state
+        for (size_t i = 0; i < goal_states.size(); ++i)
+            queue.push(0, goal_states[i]);
+        return regression_search(operators, match_tree, queue, h_values);
+    }
 }
 
 void PDBHeuristic::create_pdb() {
@@ -182,10 +364,7 @@ void PDBHeuristic::create_pdb() {
     }
 
     // build the match tree
-    MatchTree match_tree(pattern, hash_multipliers);
-    for (size_t i = 0; i < operators.size(); ++i) {
-        match_tree.insert(operators[i]);
-    }
+    MatchTree match_tree(pattern, hash_multipliers, operators);
 
     // compute abstract goal var-val pairs
     vector<pair<int, int> > abstract_goal;
@@ -195,40 +374,25 @@ void PDBHeuristic::create_pdb() {
         }
     }
 
-    distances.reserve(num_states);
-    AdaptiveQueue<size_t> pq; // (first implicit entry: priority,) second entry: index for an abstract state
-
-    // initialize queue
-    for (size_t state_index = 0; state_index < num_states; ++state_index) {
-        if (is_goal_state(state_index, abstract_goal)) {
-            pq.push(0, state_index);
-            distances.push_back(0);
-        } else {
-            distances.push_back(numeric_limits<int>::max());
+    bool unit_cost = true;
+    for (size_t i = 1; i < operators.size(); ++i) {
+        if (operators[i].get_cost() != operators[0].get_cost()) {
+            unit_cost = false;
+            break;
         }
     }
 
-    // Dijkstra loop
-    while (!pq.empty()) {
-        pair<int, size_t> node = pq.pop();
-        int distance = node.first;
-        size_t state_index = node.second;
-        if (distance > distances[state_index]) {
-            continue;
-        }
-
-        // regress abstract_state
-        vector<const AbstractOperator *> applicable_operators;
-        match_tree.get_applicable_operators(state_index, applicable_operators);
-        for (size_t i = 0; i < applicable_operators.size(); ++i) {
-            size_t predecessor = state_index + applicable_operators[i]->get_hash_effect();
-            int alternative_cost = distances[state_index] + applicable_operators[i]->get_cost();
-            if (alternative_cost < distances[predecessor]) {
-                distances[predecessor] = alternative_cost;
-                pq.push(alternative_cost, predecessor);
-            }
-        }
+    vector<size_t> goal_states;
+    for (size_t state_index = 0; state_index < num_states; ++state_index) {
+        if (is_goal_state(state_index, abstract_goal))
+            goal_states.push_back(state_index);
     }
+
+    /* Search with the smallest entry size first and start over with the next one if a distance does not fit, so
+       that the table never takes more memory during the search than in the end. All distances fit into an int. */
+    if (!compute_distances<unsigned char>(operators, match_tree, goal_states, unit_cost) &&
+        !compute_distances<unsigned short>(operators, match_tree, goal_states, unit_cost))
+        compute_distances<int>(operators, match_tree, goal_states, unit_cost);
 }
 
 void PDBHeuristic::set_pattern(const vector<int> &pat) {
@@ -242,7 +406,26 @@ void PDBHeuristic::set_pattern(const vector<int> &pat) {
         variable_to_index[pattern[i]] = i;
         num_states *= g_variable_domain[pattern[i]];
     }
-    create_pdb();
+    if (!g_pdb_directory.empty()) {
+        vector<int> fingerprint;
+        compute_fingerprint(fingerprint);
+        size_t key = compute_file_key(fingerprint);
+        string file_name = get_file_name(key);
+        if (load_pdb(file_name, key, fingerprint)) {
+            compute_relevant_operators(pattern, relevant_operators);
+            return;
+        }
+        create_pdb();
+        save_pdb(file_name, key, fingerprint);
+    } else {
+        create_pdb();
+    }
+
+#ifndef NDEBUG
+    vector<bool> relevant;
+    compute_relevant_operators(pattern, relevant);
+    assert(relevant == relevant_operators);
+#endif
 }
 
 bool PDBHeuristic::is_goal_state(const size_t state_index, const vector<pair<int, int> > &abstract_goal) const {
@@ -269,21 +452,26 @@ void PDBHeuristic::initialize() {
 }
 
 int PDBHeuristic::compute_heuristic(const State &state) {
-    int h = distances[hash_index(state)];
-    if (h == numeric_limits<int>::max())
-        return -1;
-    return h;
+    return get_distance(hash_index(state));
+}
+
+void PDBHeuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &,
+    vector<int> &values) {
+    for (size_t i = 0; i < states.size(); ++i)
+        values[i] = get_distance(hash_index(states[i]));
 }
 
 double PDBHeuristic::compute_mean_finite_h() const {
     double sum = 0;
     int size = num_states;
-    for (size_t i = 0; i < distances.size(); ++i) {
-        if (distances[i] == numeric_limits<int>::max()) {
+    for (size_t i = 0; i < num_states; ++i) {
+        int h = get_distance(i);
+        if (h == DEAD_END) {
             --size;
             continue;
         }
-        sum += distances[i];
+        sum += h;
     }
     if (size == 0) { // empty pattern or all states are dead-end
         return numeric_limits<double>::infinity();
@@ -291,6 +479,241 @@ double PDBHeuristic::compute_mean_finite_h() const {
         return sum / num_states;
 }
 
+/* A PDB file consists of a PDBFileHeader, the fingerprint (fingerprint_size ints) and, starting at the next multiple
+   of 8 bytes, the distances (num_states entries of entry_size bytes). The file uses the byte order and type sizes of
+   the machine that wrote it. */
+struct PDBFileHeader {
+    char magic[8];
+    size_t key;
+    size_t num_states;
+    size_t fingerprint_size;
+    size_t entry_size;
+};
+
+static const char PDB_FILE_MAGIC[8] = {'P', 'D', 'B', 'F', 'I', 'L', 'E', '2'};
+
+static size_t get_table_offset(size_t fingerprint_size) {
+    size_t offset = sizeof(PDBFileHeader) + fingerprint_size * sizeof(int);
+    return (offset + 7) / 8 * 8;
+}
+
+void PDBHeuristic::compute_fingerprint(vector<int> &fingerprint) const {
+    /* The PDB only depends on the pattern, the domains of its variables, the goal on them and the operators with
+       an effect on them (projected to them, with their costs). Other operators only induce self-loops. */
+    fingerprint.clear();
+    fingerprint.push_back(pattern.size());
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        fingerprint.push_back(pattern[i]);
+        fingerprint.push_back(g_variable_domain[pattern[i]]);
+    }
+    for (size_t op_no = 0; op_no < g_operators.size(); ++op_no) {
+        const vector<Prevail> &prevail = g_operators[op_no].get_prevail();
+        const vector<PrePost> &pre_post = g_operators[op_no].get_pre_post();
+        size_t start = fingerprint.size();
+        fingerprint.push_back(operator_costs[op_no]);
+        size_t num_effects = 0;
+        for (size_t i = 0; i < pre_post.size(); ++i) {
+            int index = variable_to_index[pre_post[i].var];
+            if (index != -1) {
+                fingerprint.push_back(index);
+                fingerprint.push_back(pre_post[i].pre);
+                fingerprint.push_back(pre_post[i].post);
+                ++num_effects;
+            }
+        }
+        if (num_effects == 0) {
+            fingerprint.resize(start);
+            continue;
+        }
+        fingerprint.push_back(-1);
+        for (size_t i = 0; i < prevail.size(); ++i) {
+            int index = variable_to_index[prevail[i].var];
+            if (index != -1) {
+                fingerprint.push_back(index);
+                fingerprint.push_back(prevail[i].prev);
+            }
+        }
+        fingerprint.push_back(-1);
+    }
+    fingerprint.push_back(-2);
+    for (size_t i = 0; i < g_goal.size(); ++i) {
+        int index = variable_to_index[g_goal[i].first];
+        if (index != -1) {
+            fingerprint.push_back(index);
+            fingerprint.push_back(g_goal[i].second);
+        }
+    }
+}
+
+static size_t combine_words(size_t high, size_t low) {
+    // The high word is shifted out where size_t has 32 bits (C++98 has no 64-bit literals).
+    return ((high << 16) << 16) | low;
+}
+
+size_t PDBHeuristic::compute_file_key(const vector<int> &fingerprint) const {
+    // FNV-1a over the bytes of the fingerprint, with the 64-bit parameters where size_t has 64 bits
+    bool wide = sizeof(size_t) >= 8;
+    size_t key = wide ? combine_words(0xcbf29ce4U, 0x84222325U) : 2166136261U;
+    size_t prime = wide ? combine_words(0x100U, 0x1b3U) : 16777619U;
+    const unsigned char *bytes = fingerprint.empty() ? 0 : reinterpret_cast<const unsigned char *>(&fingerprint[0]);
+    for (size_t i = 0; i < fingerprint.size() * sizeof(int); ++i)
+        key = (key ^ bytes[i]) * prime;
+    return key;
+}
+
+string PDBHeuristic::get_file_name(size_t key) const {
+    ostringstream file_name;
+    file_name << g_pdb_directory << "/pdb-" << hex << key << ".bin";
+    return file_name.str();
+}
+
+bool PDBHeuristic::load_pdb(const string &file_name, size_t key, const vector<int> &fingerprint) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat file_stat;
+    void *data = MAP_FAILED;
+    size_t file_size = 0;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size >= sizeof(PDBFileHeader)) {
+        file_size = file_stat.st_size;
+        data = mmap(0, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    const PDBFileHeader *header = static_cast<const PDBFileHeader *>(data);
+    const int *file_fingerprint = reinterpret_cast<const int *>(header + 1);
+    bool matches = memcmp(header->magic, PDB_FILE_MAGIC, sizeof(PDB_FILE_MAGIC)) == 0 &&
+                   header->key == key && header->num_states == num_states &&
+                   header->fingerprint_size == fingerprint.size() &&
+                   (header->entry_size == 1 || header->entry_size == 2 || header->entry_size == 4) &&
+                   file_size == get_table_offset(fingerprint.size()) + num_states * header->entry_size &&
+                   equal(fingerprint.begin(), fingerprint.end(), file_fingerprint);
+    if (!matches) {
+        cout << "PDB file " << file_name << " does not match; rebuilding it" << endl;
+        munmap(data, file_size);
+        return false;
+    }
+    mapped_file = data;
+    mapped_file_size = file_size;
+    entry_size = header->entry_size;
+    distances = static_cast<const unsigned char *>(data) + get_table_offset(fingerprint.size());
+    return true;
+}
+
+void PDBHeuristic::save_pdb(const string &file_name, size_t key, const vector<int> &fingerprint) const {
+    // Write to a temporary file first, so that other runs never map a partially written file.
+    ostringstream temp_file_name;
+    temp_file_name << file_name << ".tmp" << getpid() << "-" << this;
+    PDBFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PDB_FILE_MAGIC, sizeof(PDB_FILE_MAGIC));
+    header.key = key;
+    header.num_states = num_states;
+    header.fingerprint_size = fingerprint.size();
+    header.entry_size = entry_size;
+    vector<char> padding(get_table_offset(fingerprint.size()) - sizeof(header) - fingerprint.size() * sizeof(int),
+                         0);
+
+    ofstream file(temp_file_name.str().c_str(), ios::out | ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(&fingerprint[0]), fingerprint.size() * sizeof(int));
+    if (!padding.empty())
+        file.write(&padding[0], padding.size());
+    file.write(reinterpret_cast<const char *>(distances), num_states * entry_size);
+    file.close();
+    if (!file || rename(temp_file_name.str().c_str(), file_name.c_str()) != 0) {
+        cout << "Warning: could not write PDB file " << file_name << endl;
+        remove(temp_file_name.str().c_str());
+    }
+}
+
+void PDBHeuristic::compute_relevant_operators(const vector<int> &pat, vector<bool> &result) {
+    /* An operator is relevant iff build_abstract_operators builds an abstract operator for it, i.e. iff it has an
+       effect on a pattern variable that has a precondition, or whose variable has a value different from the
+       effect. */
+    vector<bool> in_pattern(g_variable_domain.size(), false);
+    for (size_t i = 0; i < pat.size(); ++i)
+        in_pattern[pat[i]] = true;
+    result.assign(g_operators.size(), false);
+    for (size_t op_no = 0; op_no < g_operators.size(); ++op_no) {
+        const vector<PrePost> &pre_post = g_operators[op_no].get_pre_post();
+        for (size_t i = 0; i < pre_post.size(); ++i) {
+            int var = pre_post[i].var;
+            if (in_pattern[var] && (pre_post[i].pre != -1 || g_variable_domain[var] > 1)) {
+                result[op_no] = true;
+                break;
+            }
+        }
+    }
+}
+
+class PDBBuildJob : public ThreadPool::Job {
+    const vector<Options> &pdb_options;
+    const vector<vector<int> > &operator_costs;
+    vector<PDBHeuristic *> &pdbs;
+    vector<double> &construction_times;
+    int next_pdb;
+public:
+    PDBBuildJob(const vector<Options> &pdb_options_, const vector<vector<int> > &operator_costs_,
+                vector<PDBHeuristic *> &pdbs_, vector<double> &construction_times_)
+        : pdb_options(pdb_options_), operator_costs(operator_costs_), pdbs(pdbs_),
+          construction_times(construction_times_), next_pdb(0) {
+    }
+
+    virtual void run(int) {
+        // Every thread takes the next PDB that nobody has started yet.
+        while (true) {
+            int i = __sync_fetch_and_add(&next_pdb, 1);
+            if (i >= pdbs.size())
+                break;
+            ExactTimer timer(ExactTimer::THREAD_CPU_TIME);
+            if (operator_costs.empty())
+                pdbs[i] = new PDBHeuristic(pdb_options[i], false);
+            else
+                pdbs[i] = new PDBHeuristic(pdb_options[i], false, operator_costs[i]);
+            construction_times[i] = timer() / 1e9;
+        }
+    }
+};
+
+void build_pdbs(OperatorCost cost_type, const vector<vector<int> > &patterns,
+                const vector<vector<int> > &operator_costs, int num_threads,
+                bool dump, vector<PDBHeuristic *> &result) {
+    assert(operator_costs.empty() || operator_costs.size() == patterns.size());
+    assert(num_threads >= 1);
+    // Set up the options of all PDBs before starting the threads.
+    vector<Options> pdb_options(patterns.size());
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        pdb_options[i].set<int>("cost_type", cost_type);
+        pdb_options[i].set<vector<int> >("pattern", patterns[i]);
+    }
+    vector<PDBHeuristic *> pdbs(patterns.size(), 0);
+    vector<double> construction_times(patterns.size(), 0);
+    PDBBuildJob job(pdb_options, operator_costs, pdbs, construction_times);
+    num_threads = min<size_t>(num_threads, patterns.size());
+    if (num_threads <= 1) {
+        job.run(0);
+    } else {
+        ExactTimer timer(ExactTimer::WALL_CLOCK_TIME);
+        ThreadPool thread_pool(num_threads);
+        thread_pool.run(job);
+        if (dump)
+            cout << "Built " << patterns.size() << " PDBs with " << num_threads
+                 << " threads in " << timer << " (wall-clock time)" << endl;
+    }
+    if (dump) {
+        for (size_t i = 0; i < pdbs.size(); ++i) {
+            cout << "PDB " << pdbs[i]->get_pattern() << ": " << pdbs[i]->get_size()
+                 << " states, " << pdbs[i]->get_entry_size() << " byte(s) per state, "
+                 << (pdbs[i]->is_loaded_from_file() ? "loaded from file in " : "construction time: ")
+                 << construction_times[i] << "s" << endl;
+        }
+    }
+    result.insert(result.end(), pdbs.begin(), pdbs.end());
+}
+
 static ScalarEvaluator *_parse(OptionParser &parser) {
     Heuristic::add_options_to_parser(parser);
     Options opts;
@@ -3,6 +3,8 @@
 
 #include "../heuristic.h"
 
+#include <limits>
+#include <string>
 #include <vector>
 
 class AbstractOperator {
@@ -10,6 +12,11 @@ class AbstractOperator {
     This class represents an abstract operator how it is needed for the regression search performed during the
     PDB-construction. As all abstract states are represented as a number, abstract operators don't have "usual"
     effects but "hash effects", i.e. the change (as number) the abstract operator implies on a given abstract state.
+
+    Effects on variables with more than two values and without a precondition (pre = -1) are not multiplied out
+    (see PDBHeuristic::multiply_out): such a variable is a "free variable" of the abstract operator. Regressing an
+    abstract state (which has the effect value on all free variables) yields one predecessor for each combination
+    of values of the free variables.
     */
 
     int cost;
@@ -17,21 +24,31 @@ class AbstractOperator {
     // Preconditions for the regression search, corresponds to normal effects and prevail of concrete operators
     std::vector<std::pair<int, int> > regression_preconditions;
 
-    // Effect of the operator during regression search on a given abstract state number
+    // Variables with an effect but without a precondition, sorted
+    std::vector<int> free_variables;
+
+    /* Effect of the operator during regression search on a given abstract state number, for the predecessor in
+       which all free variables have value 0 */
     size_t hash_effect;
 public:
     /* Abstract operators are built from concrete operators. The parameters follow the usual name convention of SAS+
-       operators, meaning prevail, preconditions and effects are all related to progression search. */
+       operators, meaning prevail, preconditions and effects are all related to progression search.
+       free_effects are the effects on the free variables. */
     AbstractOperator(const std::vector<std::pair<int, int> > &prevail,
                      const std::vector<std::pair<int, int> > &preconditions,
-                     const std::vector<std::pair<int, int> > &effects, int cost,
+                     const std::vector<std::pair<int, int> > &effects,
+                     const std::vector<std::pair<int, int> > &free_effects, int cost,
                      const std::vector<size_t> &hash_multipliers);
     ~AbstractOperator();
 
     // Returns variable value pairs which represent the preconditions of the abstract operator in a regression search
     const std::vector<std::pair<int, int> > &get_regression_preconditions() const {return regression_preconditions; }
 
-    // Returns the effect of the abstract operator in form of a value change (+ or -) to an abstract state index
+    // Returns the free variables of the abstract operator
+    const std::vector<int> &get_free_variables() const {return free_variables; }
+
+    /* Returns the effect of the abstract operator in form of a value change (+ or -) to an abstract state index,
+       for the predecessor in which all free variables have value 0 */
     size_t get_hash_effect() const {return hash_effect; }
 
     // Returns the cost of the abstract operator (same as the cost of the original concrete operator)
@@ -40,6 +57,7 @@ public:
 };
 
 // Implements a single PDB
+class MatchTree;
 class Operator;
 class State;
 class PDBHeuristic : public Heuristic {
@@ -54,30 +72,63 @@ class PDBHeuristic : public Heuristic {
     // concrete variable are mapped to abstract variables in the order they appear in pattern
     std::vector<int> variable_to_index;
 
-    // final h-values for abstract-states. dead-ends are represented by numeric_limits<int>::max()
-    std::vector<int> distances;
+    /* final h-values for abstract-states, with entry_size bytes per state: 1, 2 or 4, the smallest size whose
+       largest value is larger than all finite h-values. dead-ends are represented by this largest value. The
+       table is either stored in table_storage or part of a memory-mapped PDB file (see g_pdb_directory). */
+    int entry_size;
+    const unsigned char *distances;
+    std::vector<unsigned char> table_storage;
+    void *mapped_file; // 0 if the table is not memory-mapped
+    size_t mapped_file_size;
 
     std::vector<size_t> hash_multipliers; // multipliers for each variable for perfect hash function
     void verify_no_axioms_no_cond_effects() const; // we support SAS+ tasks only
 
     /* Recursive method; called by build_abstract_operators.
-       In the case of a precondition with value = -1 in the conrete operator, all mutliplied out abstract
-       operators are computed, i.e. for all possible values of the variable (with precondition = -1),
-       one abstract operator with a conrete value (!= -1) is computed. */
+       In the case of a precondition with value = -1 in the conrete operator on a variable with at most two values,
+       all mutliplied out abstract operators are computed, i.e. for all possible values of the variable (with
+       precondition = -1), one abstract operator with a conrete value (!= -1) is computed. Such effects on
+       variables with more values (free_effects) are not multiplied out but become free variables of the abstract
+       operators, since multiplying them out creates an abstract operator for each of their values. */
     void multiply_out(int pos, int op_no, int cost, std::vector<std::pair<int, int> > &prev_pairs,
                       std::vector<std::pair<int, int> > &pre_pairs,
                       std::vector<std::pair<int, int> > &eff_pairs,
                       const std::vector<std::pair<int, int> > &effects_without_pre,
+                      const std::vector<std::pair<int, int> > &free_effects,
                       std::vector<AbstractOperator> &operators);
 
     /* Computes all abstract operators for a given concrete operator (by its global operator number). Initializes
        datastructures for initial call to recursive method multiyply_out. */
     void build_abstract_operators(int op_no, std::vector<AbstractOperator> &operators);
 
-    /* Computes all abstract operators, builds the match tree (successor generator) and then does a Dijkstra regression
-       search to compute all final h-values (stored in distances). */
+    /* Computes all abstract operators, builds the match tree (successor generator) and then does a regression
+       search to compute all final h-values (stored in distances). The search is a breadth-first search if all
+       abstract operators have the same cost and a Dijkstra search otherwise. */
     void create_pdb();
 
+    /* The regression search of create_pdb. h_values must contain 0 for the goal states, which must be in
+       queue, and numeric_limits<Entry>::max() for all other states. Returns false if a distance does not fit into
+       an Entry (then h_values is incomplete). */
+    template<class Queue, class Entry>
+    bool regression_search(const std::vector<AbstractOperator> &operators, const MatchTree &match_tree,
+                           Queue &queue, Entry *h_values) const;
+
+    /* Computes the distances with entries of type Entry, stored in table_storage. Returns false if the distances
+       do not fit into an Entry. */
+    template<class Entry>
+    bool compute_distances(const std::vector<AbstractOperator> &operators, const MatchTree &match_tree,
+                           const std::vector<size_t> &goal_states, bool unit_cost);
+
+    /* The fingerprint describes everything the PDB depends on: the pattern, the domains of its variables, and
+       the goal and the operators (with their costs) projected to it. It is stored in the PDB file and compared
+       when loading. PDB files are named after a hash value of the fingerprint (the key). */
+    void compute_fingerprint(std::vector<int> &fingerprint) const;
+    size_t compute_file_key(const std::vector<int> &fingerprint) const;
+    std::string get_file_name(size_t key) const;
+    // Memory-maps the distances from the given file. Returns false if the file does not exist or does not match.
+    bool load_pdb(const std::string &file_name, size_t key, const std::vector<int> &fingerprint);
+    void save_pdb(const std::string &file_name, size_t key, const std::vector<int> &fingerprint) const;
+
     // Sets the pattern for the PDB and initializes hash_multipliers and num_states.
     void set_pattern(const std::vector<int> &pattern);
 
@@ -85,12 +136,13 @@ class PDBHeuristic : public Heuristic {
        and compared with the given pairs of goal variables and values. Returns true iff the state is a goal state. */
     bool is_goal_state(const size_t state_index, const std::vector<std::pair<int, int> > &abstract_goal) const;
 
-    /* The given concrete state is used to calculate the index of the according abstract state. This is only used
-       for table lookup (distances) during search. */
-    size_t hash_index(const State &state) const;
 protected:
     virtual void initialize();
     virtual int compute_heuristic(const State &state);
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
 public:
     /* Important: It is assumed that the pattern (passed via Options) is small enough so that the number of
                   abstract states is below numeric_limits<int>::max()
@@ -109,6 +161,44 @@ public:
     // Returns the size (number of abstrat states) of the PDB
     size_t get_size() const {return num_states; }
 
+    // Returns the number of bytes used for each abstract state (1, 2 or 4)
+    int get_entry_size() const {return entry_size; }
+
+    // Returns the multipliers of the perfect hash function, one for each variable of the pattern
+    const std::vector<size_t> &get_hash_multipliers() const {return hash_multipliers; }
+
+    /* The given concrete state is used to calculate the index of the according abstract state. This is only used
+       for table lookup (distances), e.g. as get_distance(hash_index(state)), which unlike evaluate does not
+       change the PDB and can therefore be used by several threads at once. */
+    size_t hash_index(const State &state) const;
+
+    // Returns the h-value stored for the given abstract state, or DEAD_END.
+    int get_distance(size_t state_index) const {
+        int h;
+        if (entry_size == 1) {
+            h = distances[state_index];
+            if (h == std::numeric_limits<unsigned char>::max())
+                return DEAD_END;
+        } else if (entry_size == 2) {
+            h = reinterpret_cast<const unsigned short *>(distances)[state_index];
+            if (h == std::numeric_limits<unsigned short>::max())
+                return DEAD_END;
+        } else {
+            h = reinterpret_cast<const int *>(distances)[state_index];
+            if (h == std::numeric_limits<int>::max())
+                return DEAD_END;
+        }
+        return h;
+    }
+
+    // Tells the processor that get_distance will soon be called for the given abstract state
+    void prefetch_distance(size_t state_index) const {
+        __builtin_prefetch(distances + state_index * entry_size);
+    }
+
+    // Returns true iff the distances were loaded from a PDB file instead of being computed
+    bool is_loaded_from_file() const {return mapped_file != 0; }
+
     /* Returns the average h-value over all states, where dead-ends are ignored (they neither increase
        the sum of all h-values nor the total number of entries for the mean value calculation). If pattern
        is empty or all states are dead-ends, infinity is retuned.
@@ -117,6 +207,18 @@ public:
 
     // Returns all operators affecting this PDB
     const std::vector<bool> &get_relevant_operators() const {return relevant_operators; }
+
+    /* Computes which operators affect a PDB for the given pattern (the result of get_relevant_operators)
+       without building it. */
+    static void compute_relevant_operators(const std::vector<int> &pattern, std::vector<bool> &result);
 };
 
+/* Builds a PDB for each pattern, using up to num_threads threads. If dump is set to true, prints the construction
+   time of each (the CPU time of the thread that built it). The PDBs are independent, so the result does not depend on the
+   number of threads. operator_costs[i] are the operator costs for patterns[i]; if operator_costs is empty,
+   default operator costs are used for all patterns. */
+extern void build_pdbs(OperatorCost cost_type, const std::vector<std::vector<int> > &patterns,
+                       const std::vector<std::vector<int> > &operator_costs, int num_threads,
+                       bool dump, std::vector<PDBHeuristic *> &result);
+
 #endif
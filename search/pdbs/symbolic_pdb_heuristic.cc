@@ -0,0 +1,337 @@
+#include "symbolic_pdb_heuristic.h"
+
+#include "bdd.h"
+#include "util.h"
+
+#include "../globals.h"
+#include "../operator.h"
+#include "../option_parser.h"
+#include "../plugin.h"
+#include "../state.h"
+#include "../timer.h"
+#include "../utilities.h"
+
+#include <cassert>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+/* The operators with a given cost and effect, as needed for the regression: the predecessors of a set of states S
+   are precondition and S restricted to effect. */
+struct SymbolicOperatorGroup {
+    int cost;
+    int precondition; // BDD (disjunction of the preconditions of the operators)
+    int effect; // cube BDD
+};
+
+SymbolicPDBHeuristic::SymbolicPDBHeuristic(const Options &opts)
+    : Heuristic(opts), pattern(opts.get_list<int>("pattern")), max_nodes(opts.get<int>("max_nodes")),
+      add_root(-2 - DEAD_END) {
+    verify_no_axioms_no_cond_effects();
+    Timer timer;
+
+    // Each pattern variable is encoded by the smallest number of bits that can represent its values.
+    vector<int> first_bit;
+    vector<int> num_bits;
+    int total_bits = 0;
+    double num_states = 1;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        int domain_size = g_variable_domain[pattern[i]];
+        int bits = 0;
+        while ((1 << bits) < domain_size)
+            ++bits;
+        first_bit.push_back(total_bits);
+        num_bits.push_back(bits);
+        total_bits += bits;
+        num_states *= domain_size;
+    }
+    cout << "Symbolic PDB for " << num_states << " abstract states with " << total_bits << " BDD variables"
+         << endl;
+
+    BDDManager manager(total_bits);
+    create_pdb(manager, first_bit, num_bits);
+    cout << "Symbolic PDB construction time: " << timer << endl;
+}
+
+SymbolicPDBHeuristic::~SymbolicPDBHeuristic() {
+}
+
+int SymbolicPDBHeuristic::get_value_bdd(BDDManager &manager, const vector<int> &first_bit,
+                                        const vector<int> &num_bits, int index, int value) const {
+    // most significant bit first, built from the last variable upwards
+    int result = manager.get_true();
+    for (int bit = 0; bit < num_bits[index]; ++bit) {
+        int var = first_bit[index] + num_bits[index] - 1 - bit;
+        result = manager.apply_and(manager.get_literal(var, (value >> bit) & 1), result);
+    }
+    return result;
+}
+
+void SymbolicPDBHeuristic::create_pdb(BDDManager &manager, const vector<int> &first_bit,
+                                      const vector<int> &num_bits) {
+    vector<int> variable_to_index(g_variable_domain.size(), -1);
+    for (size_t i = 0; i < pattern.size(); ++i)
+        variable_to_index[pattern[i]] = i;
+
+    // states in which all variables have one of their values (and not one of the unused codes of their bits)
+    int valid_states = manager.get_true();
+    for (int i = pattern.size() - 1; i >= 0; --i) {
+        int valid_values = manager.get_false();
+        for (int val = 0; val < g_variable_domain[pattern[i]]; ++val)
+            valid_values = manager.apply_or(valid_values,
+                                            get_value_bdd(manager, first_bit, num_bits, i, val));
+        valid_states = manager.apply_and(valid_values, valid_states);
+    }
+
+    int goal_states = valid_states;
+    for (size_t i = 0; i < g_goal.size(); ++i) {
+        int index = variable_to_index[g_goal[i].first];
+        if (index != -1)
+            goal_states = manager.apply_and(goal_states, get_value_bdd(manager, first_bit, num_bits, index,
+                                                                       g_goal[i].second));
+    }
+
+    // Operators without an effect on the pattern only induce self-loops and are ignored.
+    vector<SymbolicOperatorGroup> groups;
+    map<pair<int, int>, int> group_numbers; // (cost, effect) -> index in groups
+    for (size_t op_no = 0; op_no < g_operators.size(); ++op_no) {
+        const Operator &op = g_operators[op_no];
+        const vector<Prevail> &prevail = op.get_prevail();
+        const vector<PrePost> &pre_post = op.get_pre_post();
+        int precondition = manager.get_true();
+        int effect = manager.get_true();
+        for (size_t i = 0; i < prevail.size(); ++i) {
+            int index = variable_to_index[prevail[i].var];
+            if (index != -1)
+                precondition = manager.apply_and(precondition, get_value_bdd(manager, first_bit, num_bits, index,
+                                                                             prevail[i].prev));
+        }
+        for (size_t i = 0; i < pre_post.size(); ++i) {
+            int index = variable_to_index[pre_post[i].var];
+            if (index == -1)
+                continue;
+            if (pre_post[i].pre != -1)
+                precondition = manager.apply_and(precondition, get_value_bdd(manager, first_bit, num_bits,
+                                                                             index, pre_post[i].pre));
+            effect = manager.apply_and(effect, get_value_bdd(manager, first_bit, num_bits, index,
+                                                             pre_post[i].post));
+        }
+        if (effect == manager.get_true())
+            continue;
+        pair<int, int> key(get_adjusted_cost(op), effect);
+        map<pair<int, int>, int>::iterator it = group_numbers.find(key);
+        if (it == group_numbers.end()) {
+            group_numbers[key] = groups.size();
+            SymbolicOperatorGroup group = {key.first, precondition, effect};
+            groups.push_back(group);
+        } else {
+            int &group_precondition = groups[it->second].precondition;
+            group_precondition = manager.apply_or(group_precondition, precondition);
+        }
+    }
+    cout << "Symbolic PDB operator groups: " << groups.size() << endl;
+
+    /* Uniform-cost regression search: open[g] are states reached with cost g, layers the closed states by
+       distance. The number of nodes is checked after each image, so that a single layer cannot exceed max_nodes
+       by much. If the search stops, unreached_h is the smallest distance that has not been completely
+       explored. */
+    map<int, int> open;
+    open[0] = goal_states;
+    vector<pair<int, int> > layers;
+    int closed = manager.get_false();
+    size_t num_live_nodes = manager.get_num_nodes();
+    int unreached_h = DEAD_END;
+    bool stopped = false;
+    vector<int *> temporaries;
+    while (!open.empty()) {
+        int distance = open.begin()->first;
+        int layer = manager.apply_and(open.begin()->second, manager.apply_not(closed));
+        open.erase(open.begin());
+
+        // add the states reached by operators of cost 0
+        int frontier = layer;
+        while (frontier != manager.get_false()) {
+            int predecessors = manager.get_false();
+            for (size_t i = 0; i < groups.size(); ++i) {
+                if (groups[i].cost == 0) {
+                    int pre_image = manager.apply_and(groups[i].precondition,
+                                                      manager.restrict(frontier, groups[i].effect));
+                    predecessors = manager.apply_or(predecessors, pre_image);
+                    temporaries.clear();
+                    temporaries.push_back(&layer);
+                    temporaries.push_back(&frontier);
+                    temporaries.push_back(&predecessors);
+                    if (!check_nodes(manager, valid_states, closed, groups, layers, open, temporaries,
+                                     num_live_nodes)) {
+                        // The layer of this distance is incomplete.
+                        unreached_h = distance;
+                        stopped = true;
+                        break;
+                    }
+                }
+            }
+            if (stopped)
+                break;
+            int new_states = manager.apply_not(manager.apply_or(closed, layer));
+            frontier = manager.apply_and(manager.apply_and(predecessors, valid_states), new_states);
+            layer = manager.apply_or(layer, frontier);
+        }
+        if (stopped)
+            break;
+        if (layer == manager.get_false())
+            continue;
+        closed = manager.apply_or(closed, layer);
+        layers.push_back(make_pair(distance, layer));
+
+        map<int, int> predecessors; // by cost
+        for (size_t i = 0; i < groups.size(); ++i) {
+            int cost = groups[i].cost;
+            if (cost == 0)
+                continue;
+            int pre_image = manager.apply_and(groups[i].precondition, manager.restrict(layer, groups[i].effect));
+            if (predecessors.count(cost))
+                predecessors[cost] = manager.apply_or(predecessors[cost], pre_image);
+            else
+                predecessors[cost] = pre_image;
+            temporaries.clear();
+            temporaries.push_back(&layer);
+            for (map<int, int>::iterator it = predecessors.begin(); it != predecessors.end(); ++it)
+                temporaries.push_back(&it->second);
+            if (!check_nodes(manager, valid_states, closed, groups, layers, open, temporaries, num_live_nodes)) {
+                // All states up to this distance have been reached, but not all of their predecessors.
+                unreached_h = distance + 1;
+                stopped = true;
+                break;
+            }
+        }
+        if (stopped)
+            break;
+        int new_states = manager.apply_and(valid_states, manager.apply_not(closed));
+        for (map<int, int>::iterator it = predecessors.begin(); it != predecessors.end(); ++it) {
+            int states = manager.apply_and(it->second, new_states);
+            if (states == manager.get_false())
+                continue;
+            if (open.count(distance + it->first))
+                open[distance + it->first] = manager.apply_or(open[distance + it->first], states);
+            else
+                open[distance + it->first] = states;
+        }
+
+        temporaries.clear();
+        if (!check_nodes(manager, valid_states, closed, groups, layers, open, temporaries, num_live_nodes) &&
+            !open.empty()) {
+            // All states with a smaller distance than the first one left in open have been reached.
+            unreached_h = open.begin()->first;
+            stopped = true;
+            break;
+        }
+    }
+    if (stopped)
+        cout << "Symbolic PDB search stopped after " << num_live_nodes << " BDD nodes" << endl;
+
+    int h_values = manager.get_constant(unreached_h);
+    for (size_t i = 0; i < layers.size(); ++i)
+        h_values = manager.ite(layers[i].second, manager.get_constant(layers[i].first), h_values);
+    cout << "Symbolic PDB layers: " << layers.size() << endl;
+    if (!layers.empty())
+        cout << "Symbolic PDB max finite h value: " << layers.back().first << endl;
+    if (unreached_h != DEAD_END)
+        cout << "Symbolic PDB h value of unexplored states: " << unreached_h << endl;
+    set_add(manager, h_values, first_bit, num_bits);
+    cout << "Symbolic PDB size: " << add_nodes.size() << " ADD nodes" << endl;
+}
+
+bool SymbolicPDBHeuristic::check_nodes(BDDManager &manager, int &valid_states, int &closed,
+                                       vector<SymbolicOperatorGroup> &groups, vector<pair<int, int> > &layers,
+                                       map<int, int> &open, const vector<int *> &temporaries,
+                                       size_t &num_live_nodes) const {
+    if (manager.get_num_nodes() <= 2 * num_live_nodes && manager.get_num_nodes() <= max_nodes)
+        return true;
+    vector<int *> roots(temporaries);
+    roots.push_back(&valid_states);
+    roots.push_back(&closed);
+    for (size_t i = 0; i < groups.size(); ++i) {
+        roots.push_back(&groups[i].precondition);
+        roots.push_back(&groups[i].effect);
+    }
+    for (size_t i = 0; i < layers.size(); ++i)
+        roots.push_back(&layers[i].second);
+    for (map<int, int>::iterator it = open.begin(); it != open.end(); ++it)
+        roots.push_back(&it->second);
+    manager.garbage_collect(roots);
+    num_live_nodes = manager.get_num_nodes();
+    return num_live_nodes <= max_nodes;
+}
+
+void SymbolicPDBHeuristic::set_add(const BDDManager &manager, int root, const vector<int> &first_bit,
+                                   const vector<int> &num_bits) {
+    // The concrete variable and bit tested by each BDD variable.
+    vector<int> bit_var(manager.get_num_vars());
+    vector<int> bit_shift(manager.get_num_vars());
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        for (int bit = 0; bit < num_bits[i]; ++bit) {
+            bit_var[first_bit[i] + bit] = pattern[i];
+            bit_shift[first_bit[i] + bit] = num_bits[i] - 1 - bit;
+        }
+    }
+
+    // Children have lower numbers than their parents in the manager, so numbering the reached nodes in
+    // ascending order keeps this property (and the root last).
+    vector<bool> reached(root + 1, false);
+    reached[root] = true;
+    for (int i = root; i >= 0; --i) {
+        if (reached[i] && !manager.is_terminal(i)) {
+            reached[manager.get_low(i)] = true;
+            reached[manager.get_high(i)] = true;
+        }
+    }
+    vector<int> new_number(root + 1, -1);
+    add_nodes.clear();
+    for (int i = 0; i <= root; ++i) {
+        if (!reached[i])
+            continue;
+        if (manager.is_terminal(i)) {
+            new_number[i] = -2 - manager.get_value(i);
+        } else {
+            ADDNode node;
+            node.var = bit_var[manager.get_var(i)];
+            node.shift = bit_shift[manager.get_var(i)];
+            node.low = new_number[manager.get_low(i)];
+            node.high = new_number[manager.get_high(i)];
+            new_number[i] = add_nodes.size();
+            add_nodes.push_back(node);
+        }
+    }
+    add_root = new_number[root];
+}
+
+int SymbolicPDBHeuristic::get_distance(const State &state) const {
+    int node = add_root;
+    while (node >= 0) {
+        const ADDNode &add_node = add_nodes[node];
+        node = ((state[add_node.var] >> add_node.shift) & 1) ? add_node.high : add_node.low;
+    }
+    return -2 - node;
+}
+
+int SymbolicPDBHeuristic::compute_heuristic(const State &state) {
+    return get_distance(state);
+}
+
+static ScalarEvaluator *_parse(OptionParser &parser) {
+    Heuristic::add_options_to_parser(parser);
+    parser.add_option<int>("max_nodes", 1000000,
+                           "maximum number of BDD nodes for the symbolic search");
+    Options opts;
+    parse_pattern(parser, opts, 100000000);
+
+    if (parser.dry_run())
+        return 0;
+    if (opts.get<int>("max_nodes") < 1)
+        parser.error("max_nodes must be at least 1");
+
+    return new SymbolicPDBHeuristic(opts);
+}
+
+static Plugin<ScalarEvaluator> _plugin("spdb", _parse);
@@ -0,0 +1,72 @@
+#ifndef PDBS_SYMBOLIC_PDB_HEURISTIC_H
+#define PDBS_SYMBOLIC_PDB_HEURISTIC_H
+
+#include "../heuristic.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+class BDDManager;
+struct SymbolicOperatorGroup;
+
+/*
+  A PDB whose distances are computed by a symbolic regression search from the abstract goal states instead of an
+  explicit one, so that its size is not limited by a table with one entry per abstract state (see PDBHeuristic).
+
+  Each variable of the pattern is encoded in binary by BDD variables (bits), in the order of the pattern. The search
+  computes the set of abstract states of each distance as a BDD (uniform-cost search with a fixpoint for operators
+  of cost 0). The predecessors of a set S for an operator with precondition pre and effect eff are
+  pre and S[eff], where S[eff] is S with the effect variables set to their effect values (a cofactor), so no
+  transition relation over primed variables is needed. Operators with the same cost and effect share one
+  BDD for their preconditions.
+
+  The layers are then combined into a single multi-terminal BDD mapping each abstract state to its distance, so that
+  a lookup follows one path of at most one node per bit of the pattern, independent of the number of layers.
+
+  If more than max_nodes BDD nodes are needed, the search stops, even in the middle of a layer (the number of nodes
+  is checked after each image computation); states that have not been reached then get the smallest distance not
+  yet completely explored, which keeps the heuristic admissible.
+*/
+class SymbolicPDBHeuristic : public Heuristic {
+    struct ADDNode {
+        int var; // concrete variable tested by the node
+        int shift; // the node tests bit number shift of the value of var
+        // the next node if the bit is 0 or 1: a node number, or -2 - h for the distance h (-1 for dead-ends)
+        int low;
+        int high;
+    };
+
+    std::vector<int> pattern;
+    int max_nodes;
+
+    std::vector<ADDNode> add_nodes;
+    int add_root; // encoded like the children of an ADDNode
+
+    // Builds the symbolic PDB, using the given BDD variable for each bit (see constructor).
+    void create_pdb(BDDManager &manager, const std::vector<int> &first_bit, const std::vector<int> &num_bits);
+    /* Collects garbage if many nodes are dead or there are more than max_nodes nodes, keeping the BDDs of the
+       search given by the parameters and temporaries. Returns false if more than max_nodes nodes are needed. */
+    bool check_nodes(BDDManager &manager, int &valid_states, int &closed, std::vector<SymbolicOperatorGroup> &groups,
+                     std::vector<std::pair<int, int> > &layers, std::map<int, int> &open,
+                     const std::vector<int *> &temporaries, size_t &num_live_nodes) const;
+    // Returns the BDD for pattern[index] = value.
+    int get_value_bdd(BDDManager &manager, const std::vector<int> &first_bit, const std::vector<int> &num_bits,
+                      int index, int value) const;
+    // Copies the given ADD (with bits as in first_bit and num_bits) into add_nodes.
+    void set_add(const BDDManager &manager, int root, const std::vector<int> &first_bit,
+                 const std::vector<int> &num_bits);
+protected:
+    virtual int compute_heuristic(const State &state);
+public:
+    SymbolicPDBHeuristic(const Options &opts);
+    virtual ~SymbolicPDBHeuristic();
+
+    // Returns the pattern (i.e. all variables used) of the PDB
+    const std::vector<int> &get_pattern() const {return pattern; }
+
+    // Returns the distance of the abstract state of the given concrete state, or DEAD_END.
+    int get_distance(const State &state) const;
+};
+
+#endif
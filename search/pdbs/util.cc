@@ -113,9 +113,9 @@ static void build_singleton_patterns(
 }
 
 
-void parse_pattern(OptionParser &parser, Options &opts) {
+void parse_pattern(OptionParser &parser, Options &opts, int default_max_states) {
     parser.add_option<int>(
-        "max_states", 1000000, "maximum abstraction size");
+        "max_states", default_max_states, "maximum abstraction size");
     parser.add_list_option<int>(
         "pattern", "the pattern", OptionFlags(false));
 
@@ -144,8 +144,12 @@ void parse_patterns(OptionParser &parser, Options &opts) {
         "combo", false, "use the combo strategy");
     parser.add_option<int>(
         "max_states", 1000000, "maximum abstraction size for combo strategy");
+    parser.add_option<int>(
+        "threads", 1, "number of threads for building the pattern databases");
 
     opts = parser.parse();
+    if (!parser.dry_run() && opts.get<int>("threads") < 1)
+        parser.error("threads must be at least 1");
 
     vector<vector<int> > pattern_collection;
     if (opts.contains("patterns")) {
@@ -4,7 +4,7 @@
 class OptionParser;
 class Options;
 
-extern void parse_pattern(OptionParser &parser, Options &opts);
+extern void parse_pattern(OptionParser &parser, Options &opts, int default_max_states = 1000000);
 extern void parse_patterns(OptionParser &parser, Options &opts);
 
 #endif
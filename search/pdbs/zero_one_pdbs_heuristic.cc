@@ -10,12 +10,14 @@
 #include "../state.h"
 #include "../utilities.h"
 
+#include <algorithm>
+#include <cassert>
 #include <vector>
 
 using namespace std;
 
 ZeroOnePDBsHeuristic::ZeroOnePDBsHeuristic(
-    const Options &opts,
+    const Options &opts, bool dump,
     const vector<int> &op_costs)
     : Heuristic(opts) {
     vector<int> operator_costs;
@@ -28,26 +30,36 @@ ZeroOnePDBsHeuristic::ZeroOnePDBsHeuristic(
         operator_costs = op_costs;
     }
     const vector<vector<int> > &pattern_collection(opts.get_list<vector<int> >("patterns"));
+    int num_threads = opts.contains("threads") ? opts.get<int>("threads") : 1;
     //Timer timer;
-    approx_mean_finite_h = 0;
-    pattern_databases.reserve(pattern_collection.size());
+
+    /* Action cost partitioning: the operators relevant for a PDB cost 0 in all further PDBs. Which operators are
+       relevant only depends on the pattern, so we can compute the costs for all PDBs up front and then build the
+       PDBs independently of each other. */
+    vector<vector<int> > pdb_operator_costs;
+    pdb_operator_costs.reserve(pattern_collection.size());
+    vector<bool> used_ops;
     for (size_t i = 0; i < pattern_collection.size(); ++i) {
-        Options opts;
-        opts.set<int>("cost_type", cost_type);
-        opts.set<vector<int> >("pattern", pattern_collection[i]);
-        PDBHeuristic *pdb_heuristic = new PDBHeuristic(opts, false, operator_costs);
-        pattern_databases.push_back(pdb_heuristic);
-
-        // get used operators and set their cost for further iterations to 0 (action cost partitioning)
-        const vector<bool> &used_ops = pdb_heuristic->get_relevant_operators();
+        pdb_operator_costs.push_back(operator_costs);
+        PDBHeuristic::compute_relevant_operators(pattern_collection[i], used_ops);
         assert(used_ops.size() == operator_costs.size());
         for (size_t k = 0; k < used_ops.size(); ++k) {
             if (used_ops[k])
                 operator_costs[k] = 0;
         }
-
-        approx_mean_finite_h += pdb_heuristic->compute_mean_finite_h();
     }
+
+    pattern_databases.reserve(pattern_collection.size());
+    build_pdbs(cost_type, pattern_collection, pdb_operator_costs, num_threads,
+               dump, pattern_databases);
+
+    approx_mean_finite_h = 0;
+    for (size_t i = 0; i < pattern_databases.size(); ++i)
+        approx_mean_finite_h += pattern_databases[i]->compute_mean_finite_h();
+    // since we use action cost partitioning, we can simply add up all h-values
+    // from the patterns in the pattern collection
+    evaluator.set_collection(pattern_databases,
+                             vector<vector<PDBHeuristic *> >(1, pattern_databases));
     //cout << "All or nothing PDB collection construction time: " <<
     //timer << endl;
 }
@@ -62,16 +74,14 @@ void ZeroOnePDBsHeuristic::initialize() {
 }
 
 int ZeroOnePDBsHeuristic::compute_heuristic(const State &state) {
-    // since we use action cost partitioning, we can simply add up all h-values
-    // from the patterns in the pattern collection
-    int h_val = 0;
-    for (size_t i = 0; i < pattern_databases.size(); ++i) {
-        pattern_databases[i]->evaluate(state);
-        if (pattern_databases[i]->is_dead_end())
-            return -1;
-        h_val += pattern_databases[i]->get_heuristic();
-    }
-    return h_val;
+    return evaluator.evaluate(state);
+}
+
+void ZeroOnePDBsHeuristic::compute_heuristic_batch(
+    const vector<State> &states, const vector<EvaluationContext> &,
+    vector<int> &values) {
+    for (size_t i = 0; i < states.size(); ++i)
+        values[i] = evaluator.evaluate(states[i]);
 }
 
 void ZeroOnePDBsHeuristic::dump() const {
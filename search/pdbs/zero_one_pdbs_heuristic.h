@@ -1,6 +1,8 @@
 #ifndef PDBS_ZERO_ONE_PDBS_HEURISTIC_H
 #define PDBS_ZERO_ONE_PDBS_HEURISTIC_H
 
+#include "pdb_collection_evaluator.h"
+
 #include "../heuristic.h"
 
 #include <vector>
@@ -11,11 +13,20 @@ class ZeroOnePDBsHeuristic : public Heuristic {
     // summed up mean finite h-values of all PDBs - this is an approximation only, see get-method
     double approx_mean_finite_h;
     std::vector<PDBHeuristic *> pattern_databases; // final pattern databases
+    PDBCollectionEvaluator evaluator; // sums up the h-values of all pattern databases
 protected:
     virtual void initialize();
     virtual int compute_heuristic(const State &state);
+    virtual void compute_heuristic_batch(
+        const std::vector<State> &states,
+        const std::vector<EvaluationContext> &contexts,
+        std::vector<int> &values);
 public:
+    /* dump:     If set to true, prints the construction time of each PDB.
+       op_costs: Can specify individual operator costs for each operator. If left empty, default operator costs
+                 are used. */
     ZeroOnePDBsHeuristic(const Options &opts,
+                         bool dump = true,
                          const std::vector<int> &op_costs = std::vector<int>());
     virtual ~ZeroOnePDBsHeuristic();
     /* Returns the sum of all mean finite h-values of every PDB.
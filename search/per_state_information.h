@@ -0,0 +1,62 @@
+#ifndef PER_STATE_INFORMATION_H
+#define PER_STATE_INFORMATION_H
+
+#include "segmented_vector.h"
+#include "state_id.h"
+
+/*
+  PerStateInformation is used to associate information with registered
+  states. Since StateIDs are dense (the registry numbers states 0, 1,
+  2, ... in the order in which they are registered), this is a plain
+  vector indexed by StateID rather than a hash table keyed by the state
+  data, so every access is O(1) and never touches the state itself.
+
+  Entries for states that have not been accessed before are created on
+  demand with the default value. References to entries remain valid
+  when other entries are added, because the underlying storage is
+  segmented.
+*/
+
+template<class Entry>
+class PerStateInformation {
+    const Entry default_value;
+    SegmentedVector<Entry> entries;
+
+    // No implementation to forbid copies and assignment.
+    PerStateInformation(const PerStateInformation<Entry> &);
+    PerStateInformation &operator=(const PerStateInformation<Entry> &);
+public:
+    PerStateInformation()
+        : default_value() {
+    }
+
+    explicit PerStateInformation(const Entry &default_value_)
+        : default_value(default_value_) {
+    }
+
+    Entry &operator[](StateID id) {
+        size_t index = id.value;
+        assert(id != StateID::no_state);
+        if (index >= entries.size())
+            entries.resize(index + 1, default_value);
+        return entries[index];
+    }
+
+    const Entry &operator[](StateID id) const {
+        size_t index = id.value;
+        assert(id != StateID::no_state);
+        if (index >= entries.size())
+            return default_value;
+        return entries[index];
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    void clear() {
+        entries.clear();
+    }
+};
+
+#endif
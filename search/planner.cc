@@ -5,6 +5,8 @@
 #include "timer.h"
 #include "utilities.h"
 #include "search_engine.h"
+#include "state.h"
+#include "state_registry.h"
 
 #include <iostream>
 #include <new>
@@ -22,7 +24,6 @@ int main(int argc, const char **argv) {
    		read_everything(cin);
 
    SearchEngine *engine = 0;
-	operator_level = 0;
 	Timer search_timer;
 
     //the input will be parsed twice:
@@ -30,6 +31,10 @@ int main(int argc, const char **argv) {
     //then in normal mode
 	try {
     	OptionParser::parse_cmd_line(argc, argv, true);
+        // The dry run has selected the state hash table. The initial
+        // state is registered first, so it always has ID 0.
+        g_state_registry = new StateRegistry(g_state_hash_table_type);
+        g_state_registry->register_state(*g_initial_state);
     	engine = OptionParser::parse_cmd_line(argc, argv, false);
     } catch (ParseError &pe) {
    		cerr << pe << endl;
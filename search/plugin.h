@@ -7,6 +7,7 @@
 #include <iostream>
 #include "open_lists/standard_scalar_open_list.h"
 #include "open_lists/open_list_buckets.h"
+#include "open_lists/bucket_array_open_list.h"
 #include "open_lists/tiebreaking_open_list.h"
 #include "open_lists/alternation_open_list.h"
 #include "open_lists/pareto_open_list.h"
@@ -42,6 +43,8 @@ public:
             "single", StandardScalarOpenList<Entry>::_parse);
         Registry<OpenList<Entry > *>::instance()->register_object(
             "single_buckets", BucketOpenList<Entry>::_parse);
+        Registry<OpenList<Entry > *>::instance()->register_object(
+            "single_bucket_array", BucketArrayOpenList<Entry>::_parse);
         Registry<OpenList<Entry > *>::instance()->register_object(
             "tiebreaking", TieBreakingOpenList<Entry>::_parse);
         Registry<OpenList<Entry > *>::instance()->register_object(
@@ -11,7 +11,9 @@
 /*
   We define three priority queue classes here: HeapQueue (heap-based),
   BucketQueue (bucket-based), and AdaptiveQueue (starts out bucket-based,
-  transforms into heap-based if that seems to make sense).
+  transforms into heap-based if that seems to make sense). For
+  explorations that know their operator costs in advance, there are
+  also TwoBucketQueue and CappedBucketQueue (see below).
 
   More precisely, an AdaptiveQueue is converted from a BucketQueue to
   a HeapQueue when the number of required buckets exceeds both
@@ -262,4 +264,123 @@ public:
     }
 };
 
+
+/*
+  The following two queues have the same interface as AdaptiveQueue,
+  but never change their strategy, so that an exploration can choose
+  the right one for its operator costs once (see
+  RelaxationHeuristic::choose_queue_type) and use it without virtual
+  calls.
+
+  TwoBucketQueue only keeps the entries of the current key (the key
+  of the last entry popped) and the next one. It is meant for
+  explorations where all keys pushed are at least the current key and
+  at most one more, e.g. h^max with operator costs 0 and 1.
+
+  CappedBucketQueue keeps the entries with keys below MAX_BUCKETS in
+  buckets, popping them like BucketQueue, and all others in a heap.
+  Since all keys in buckets are smaller than those in the heap, it
+  never has to convert between the two, and a few very large keys do
+  not make it allocate a bucket for every key.
+*/
+
+template<typename Value>
+class TwoBucketQueue {
+    std::vector<Value> current_bucket;
+    std::vector<Value> next_bucket;
+    int current_key;
+public:
+    typedef std::pair<int, Value> Entry;
+
+    TwoBucketQueue() : current_key(0) {
+    }
+
+    void push(int key, const Value &value) {
+        if (key == current_key) {
+            current_bucket.push_back(value);
+        } else {
+            assert(key == current_key + 1);
+            next_bucket.push_back(value);
+        }
+    }
+
+    Entry pop() {
+        if (current_bucket.empty()) {
+            assert(!next_bucket.empty());
+            current_bucket.swap(next_bucket);
+            ++current_key;
+        }
+        Value top_element = current_bucket.back();
+        current_bucket.pop_back();
+        return std::make_pair(current_key, top_element);
+    }
+
+    bool empty() const {
+        return current_bucket.empty() && next_bucket.empty();
+    }
+
+    void clear() {
+        current_bucket.clear();
+        next_bucket.clear();
+        current_key = 0;
+    }
+};
+
+
+template<typename Value>
+class CappedBucketQueue {
+    static const int MAX_BUCKETS = 1 << 16;
+
+    typedef std::vector<Value> Bucket;
+    std::vector<Bucket> buckets;
+    size_t current_bucket_no;
+    size_t num_bucket_entries;
+    HeapQueue<Value> heap;
+public:
+    typedef std::pair<int, Value> Entry;
+
+    CappedBucketQueue() : current_bucket_no(0), num_bucket_entries(0) {
+    }
+
+    void push(int key, const Value &value) {
+        if (key >= MAX_BUCKETS) {
+            heap.push(key, value);
+            return;
+        }
+        ++num_bucket_entries;
+        if (key >= buckets.size())
+            buckets.resize(key + 1);
+        else if (key < current_bucket_no)
+            current_bucket_no = key;
+        buckets[key].push_back(value);
+    }
+
+    Entry pop() {
+        if (!num_bucket_entries)
+            return heap.pop();
+        --num_bucket_entries;
+        while (buckets[current_bucket_no].empty())
+            ++current_bucket_no;
+        Bucket &current_bucket = buckets[current_bucket_no];
+        Value top_element = current_bucket.back();
+        current_bucket.pop_back();
+        return std::make_pair(current_bucket_no, top_element);
+    }
+
+    bool empty() const {
+        return num_bucket_entries == 0 && heap.empty();
+    }
+
+    void clear() {
+        for (size_t i = current_bucket_no; num_bucket_entries; ++i) {
+            assert(i < buckets.size());
+            assert(buckets[i].size() <= num_bucket_entries);
+            num_bucket_entries -= buckets[i].size();
+            buckets[i].clear();
+        }
+        current_bucket_no = 0;
+        heap.clear();
+    }
+};
+
 #endif
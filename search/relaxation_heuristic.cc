@@ -1,19 +1,17 @@
 #include "relaxation_heuristic.h"
 
 #include "globals.h"
-#include "operator.h"
-#include "state.h"
 
-#include <cassert>
+#include <algorithm>
 #include <vector>
 using namespace std;
 
-#include <ext/hash_map>
-using namespace __gnu_cxx;
+const int RelaxationHeuristic::NO_OPERATOR;
 
 // construction and destruction
 RelaxationHeuristic::RelaxationHeuristic(const Options &opts)
-    : Heuristic(opts) {
+    : Heuristic(opts), relaxed_task(0), num_propositions(0),
+      mark_epoch(1) {
 }
 
 RelaxationHeuristic::~RelaxationHeuristic() {
@@ -21,183 +19,63 @@ RelaxationHeuristic::~RelaxationHeuristic() {
 
 // initialization
 void RelaxationHeuristic::initialize() {
-    // Build propositions.
-    int prop_id = 0;
-
-    propositions.resize(g_variable_domain.size());
-    for (int var = 0; var < g_variable_domain.size(); var++) {
-        for (int value = 0; value < g_variable_domain[var]; value++)
-            propositions[var].push_back(Proposition(prop_id++));
-    }
-
-    // Build goal propositions.
-    for (int i = 0; i < g_goal.size(); i++) {
-        int var = g_goal[i].first, val = g_goal[i].second;
-        propositions[var][val].is_goal = true;
-        goal_propositions.push_back(&propositions[var][val]);
-    }
-
-	unary_operators.resize(2);
-
-    // Build unary operators for operators and axioms.
-    for (int i = 0; i < g_operators.size(); i++)
-        build_unary_operators(g_operators[i], i, false);
-	for (int i = 0; i < g_abstract_operators.size(); i++) {
-        build_unary_operators(g_abstract_operators[i], i, true);
-	}    
-	for (int i = 0; i < g_axioms.size(); i++) {
-        build_unary_operators(g_axioms[i], -1, false);
-		build_unary_operators(g_axioms[i], -1, true);
-	}
-
-    // Simplify unary operators.
-
-	for (int i = 0; i < unary_operators.size()-1; i++) {
-    	simplify(i);
-	}
-
-    // Cross-reference unary operators.
-
-	for (int i = 0; i < unary_operators.size(); i++) {    
-		for (int j = 0; j < unary_operators[i].size(); j++) {
-			//cout << unary_operators[i].is_abstract << endl;
-		    UnaryOperator *op = &unary_operators[i][j];
-		    for (int k = 0; k < op->precondition.size(); k++)
-		        op->precondition[k]->precondition_of.push_back(op);
-		}
-	}
+    relaxed_task = &RelaxedTask::get(0, cost_type);
+    unary_operators.push_back(&relaxed_task->get_unary_operators(true));
+    unary_operators.push_back(
+        &RelaxedTask::get(1, cost_type).get_unary_operators(false));
+    operator_cost.resize(unary_operators.size());
+    unsatisfied_preconditions.resize(unary_operators.size());
+    for (int level = 0; level < unary_operators.size(); level++)
+        reset_operators(level);
+
+    num_propositions = relaxed_task->get_num_propositions();
+    goal_propositions = relaxed_task->get_goal_propositions();
+    proposition_cost.resize(num_propositions, -1);
+    reached_by.resize(num_propositions, NO_OPERATOR);
+    reached_by_cheaper.resize(num_propositions, true);
+    mark_stamp.resize(num_propositions, 0);
 }
 
-void RelaxationHeuristic::build_unary_operators(const Operator &op, int op_no, bool abstract) {
-    int base_cost = get_adjusted_cost(op);
-    const vector<Prevail> &prevail = op.get_prevail();
-    const vector<PrePost> &pre_post = op.get_pre_post();
-    vector<Proposition *> precondition;
-    for (int i = 0; i < prevail.size(); i++) {
-        assert(prevail[i].var >= 0 && prevail[i].var < g_variable_domain.size());
-        assert(prevail[i].prev >= 0 && prevail[i].prev < g_variable_domain[prevail[i].var]);
-        precondition.push_back(&propositions[prevail[i].var][prevail[i].prev]);
-    }
-    for (int i = 0; i < pre_post.size(); i++) {
-        if (pre_post[i].pre != -1) {
-            assert(pre_post[i].var >= 0 && pre_post[i].var < g_variable_domain.size());
-            assert(pre_post[i].pre >= 0 && pre_post[i].pre < g_variable_domain[pre_post[i].var]);
-            precondition.push_back(&propositions[pre_post[i].var][pre_post[i].pre]);
-        }
-    }
-    for (int i = 0; i < pre_post.size(); i++) {
-        assert(pre_post[i].var >= 0 && pre_post[i].var < g_variable_domain.size());
-        assert(pre_post[i].post >= 0 && pre_post[i].post < g_variable_domain[pre_post[i].var]);
-        Proposition *effect = &propositions[pre_post[i].var][pre_post[i].post];
-        const vector<Prevail> &eff_cond = pre_post[i].cond;
-        for (int j = 0; j < eff_cond.size(); j++) {
-            assert(eff_cond[j].var >= 0 && eff_cond[j].var < g_variable_domain.size());
-            assert(eff_cond[j].prev >= 0 && eff_cond[j].prev < g_variable_domain[eff_cond[j].var]);
-            precondition.push_back(&propositions[eff_cond[j].var][eff_cond[j].prev]);
-        }
-
-		unary_operators[abstract].push_back(UnaryOperator(precondition, effect, op_no, base_cost, abstract));
-		precondition.erase(precondition.end() - eff_cond.size(), precondition.end());
+void RelaxationHeuristic::unmark_all() {
+    ++mark_epoch;
+    if (mark_epoch == 0) {
+        // The epoch counter wrapped around: forget all old stamps.
+        mark_stamp.assign(mark_stamp.size(), 0);
+        mark_epoch = 1;
     }
 }
 
-class hash_unary_operator {
-public:
-    size_t operator()(const pair<vector<Proposition *>, Proposition *> &key) const {
-        // NOTE: We used to hash the Proposition* values directly, but
-        // this had the disadvantage that the results were not
-        // reproducible. This propagates through to the heuristic
-        // computation: runs on different computers could lead to
-        // different initial h values, for example.
-
-        unsigned long hash_value = key.second->id;
-        const vector<Proposition *> &vec = key.first;
-        for (int i = 0; i < vec.size(); i++)
-            hash_value = 17 * hash_value + vec[i]->id;
-        return size_t(hash_value);
+RelaxationHeuristic::QueueType RelaxationHeuristic::choose_queue_type(
+    bool sum_costs) const {
+    // With larger costs, too few keys share a bucket.
+    const int MAX_BUCKET_QUEUE_COST = 100;
+    int max_cost = 0;
+    for (int level = 0; level < unary_operators.size(); level++) {
+        const vector<int> &base_cost = unary_operators[level]->base_cost;
+        if (!base_cost.empty())
+            max_cost = max(max_cost,
+                           *max_element(base_cost.begin(), base_cost.end()));
     }
-};
-
-
-static bool compare_prop_pointer(const Proposition *p1, const Proposition *p2) {
-    return p1->id < p2->id;
+    if (!sum_costs && max_cost <= 1)
+        return TWO_BUCKET_QUEUE;
+    else if (max_cost <= MAX_BUCKET_QUEUE_COST)
+        return BUCKET_QUEUE;
+    else
+        return HEAP_QUEUE;
 }
 
-
-void RelaxationHeuristic::simplify(int position) {
-    // Remove duplicate or dominated unary operators.
-
-    /*
-      Algorithm: Put all unary operators into a hash_map
-      (key: condition and effect; value: index in operator vector.
-      This gets rid of operators with identical conditions.
-
-      Then go through the hash_map, checking for each element if
-      none of the possible dominators are part of the hash_map.
-      Put the element into the new operator vector iff this is the case.
-
-      In both loops, be careful to ensure that a higher-cost operator
-      never dominates a lower-cost operator.
-    */
-
-    cout << "Simplifying " << unary_operators[position].size() << " unary operators..." << flush;
-
-    typedef pair<vector<Proposition *>, Proposition *> HashKey;
-    typedef hash_map<HashKey, int, hash_unary_operator> HashMap;
-    HashMap unary_operator_index;
-    unary_operator_index.resize(unary_operators[position].size() * 2);
-
-    for (int i = 0; i < unary_operators[position].size(); i++) {
-        UnaryOperator &op = unary_operators[position][i];
-        sort(op.precondition.begin(), op.precondition.end(), compare_prop_pointer);
-        HashKey key(op.precondition, op.effect);
-        pair<HashMap::iterator, bool> inserted = unary_operator_index.insert(
-            make_pair(key, i));
-        if (!inserted.second) {
-            // We already had an element with this key; check its cost.
-
-			HashMap::iterator iter = inserted.first;
-            int old_op_no = iter->second;
-            int old_cost = unary_operators[position][old_op_no].base_cost;
-            int new_cost = unary_operators[position][i].base_cost;
-            if (new_cost < old_cost)
-                iter->second = i;
-            assert(unary_operators[position][unary_operator_index[key]].base_cost ==
-                   min(old_cost, new_cost));
-        }
-    }
-
-    vector<UnaryOperator> old_unary_operators;
-    old_unary_operators.swap(unary_operators[position]);
-
-    for (HashMap::iterator it = unary_operator_index.begin();
-         it != unary_operator_index.end(); ++it) {
-        const HashKey &key = it->first;
-        int unary_operator_no = it->second;
-        int powerset_size = (1 << key.first.size()) - 1; // -1: only consider proper subsets
-        bool match = false;
-        if (powerset_size <= 31) { // HACK! Don't spend too much time here...
-            for (int mask = 0; mask < powerset_size; mask++) {
-                HashKey dominating_key = make_pair(vector<Proposition *>(), key.second);
-                for (int i = 0; i < key.first.size(); i++)
-                    if (mask & (1 << i))
-                        dominating_key.first.push_back(key.first[i]);
-                HashMap::iterator found = unary_operator_index.find(
-                    dominating_key);
-                if (found != unary_operator_index.end()) {
-                    int my_cost = old_unary_operators[unary_operator_no].base_cost;
-                    int dominator_op_no = found->second;
-                    int dominator_cost = old_unary_operators[dominator_op_no].base_cost;
-                    if (dominator_cost <= my_cost) {
-                        match = true;
-                        break;
-                    }
-                }
+void RelaxationHeuristic::get_relevant_variables(
+    int level, vector<int> &result) const {
+    const UnaryOperators &ops = *unary_operators[level];
+    result.clear();
+    for (int var = 0; var < g_variable_domain.size(); var++) {
+        for (int value = 0; value < g_variable_domain[var]; value++) {
+            int prop = get_proposition(var, value);
+            if (is_goal(prop) ||
+                ops.triggered_begin[prop] != ops.triggered_begin[prop + 1]) {
+                result.push_back(var);
+                break;
             }
         }
-        if (!match)
-            unary_operators[position].push_back(old_unary_operators[unary_operator_no]);
     }
-
-    cout << " done! [" << unary_operators.size() << " unary operators]" << endl;
 }
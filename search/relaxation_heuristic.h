@@ -2,56 +2,125 @@
 #define RELAXATION_HEURISTIC_H
 
 #include "heuristic.h"
+#include "relaxed_task.h"
 
+#include <cassert>
+#include <utility>
 #include <vector>
 
-class Operator;
 class State;
 
-class Proposition;
-class UnaryOperator;
-
-struct UnaryOperator {
-    int operator_no; // -1 for axioms; index into g_operators otherwise
-    std::vector<Proposition *> precondition;
-    Proposition *effect;
-    int base_cost;
-	bool is_abstract;
-
-    int unsatisfied_preconditions;
-    int cost; // Used for h^max cost or h^add cost;
-              // includes operator cost (base_cost)
-    UnaryOperator(const std::vector<Proposition *> &pre, Proposition *eff,
-                  int operator_no_, int base, bool abstract)
-        : operator_no(operator_no_), precondition(pre), effect(eff),
-          base_cost(base), is_abstract(abstract){}
-};
+class RelaxationHeuristic : public Heuristic {
+protected:
+    static const int NO_OPERATOR = -1;
+
+    // The relaxed task of level 0 (for the propositions), and the
+    // unary operators of each operator level (0: the operators of the
+    // task, simplified; 1: the abstract operators). Both are shared
+    // with the other heuristics that use the same cost type.
+    const RelaxedTask *relaxed_task;
+    std::vector<const UnaryOperators *> unary_operators;
+
+    // Data of the current exploration, indexed by operator level and
+    // unary operator.
+    std::vector<std::vector<int> > operator_cost; // Used for h^max cost
+                                                  // or h^add cost;
+                                                  // includes base_cost
+    std::vector<std::vector<int> > unsatisfied_preconditions;
 
-struct Proposition {
-    bool is_goal;
-    int id;
-    std::vector<UnaryOperator *> precondition_of;
-
-    int cost; // Used for h^max cost or h^add cost
-    UnaryOperator *reached_by;
-    bool marked; // used when computing preferred operators for h^add and h^FF
-
-    Proposition(int id_) {
-        id = id_;
-        is_goal = false;
-        cost = -1;
-        reached_by = 0;
-        marked = false;
+    int num_propositions;
+    std::vector<int> goal_propositions;
+
+    // Data of the current exploration, indexed by proposition.
+    std::vector<int> proposition_cost; // Used for h^max cost or h^add cost;
+                                       // -1 for unreached propositions
+    std::vector<int> reached_by; // unary operator of the explored level
+    // Whether all preconditions of reached_by are cheaper than the
+    // proposition (true for NO_OPERATOR); see enqueue_if_necessary.
+    std::vector<char> reached_by_cheaper;
+    // Marks used when computing preferred operators and relaxed plans
+    // for h^add and h^FF. A proposition is marked iff its stamp is
+    // mark_epoch, so that unmark_all only has to start a new epoch.
+    std::vector<unsigned int> mark_stamp;
+    unsigned int mark_epoch;
+
+    int get_proposition(int var, int value) const {
+        return relaxed_task->get_proposition(var, value);
     }
-};
+    bool is_goal(int prop) const {
+        return relaxed_task->is_goal_proposition(prop);
+    }
+    bool is_marked(int prop) const {
+        return mark_stamp[prop] == mark_epoch;
+    }
+    void mark(int prop) {
+        mark_stamp[prop] = mark_epoch;
+    }
+    void unmark_all();
+    // Sets the operator costs of the given level to the base costs and
+    // counts all preconditions as unsatisfied.
+    void reset_operators(int level) {
+        operator_cost[level] = unary_operators[level]->base_cost;
+        unsatisfied_preconditions[level] =
+            unary_operators[level]->num_preconditions;
+    }
+    enum QueueType {TWO_BUCKET_QUEUE, BUCKET_QUEUE, HEAP_QUEUE};
+    // The cheapest queue that suits the operator costs: TwoBucketQueue
+    // if the keys are maxima of costs 0 and 1 (sum_costs is false),
+    // CappedBucketQueue for small costs, and HeapQueue otherwise.
+    QueueType choose_queue_type(bool sum_costs) const;
 
-class RelaxationHeuristic : public Heuristic {
-    void build_unary_operators(const Operator &op, int operator_no, bool abstract);
-    void simplify(int position);
-protected:
-    std::vector<std::vector<UnaryOperator> > unary_operators;
-    std::vector<std::vector<Proposition> > propositions;
-    std::vector<Proposition *> goal_propositions;
+    /*
+      Lowers the cost of prop to cost, reached by op, if that is
+      cheaper. cheaper_preconditions tells whether all preconditions
+      of op are cheaper than cost. Among the achievers of the same
+      cost, those with cheaper preconditions win, and of these the one
+      with the lowest index (NO_OPERATOR for the propositions of the
+      state), so that reached_by does not depend on the order in which
+      the achievers are found. The other achievers (of cost 0, such as
+      axioms) keep the first one found: letting them win ties could
+      make reached_by cyclic.
+    */
+    template<typename Queue>
+    void enqueue_if_necessary(Queue &queue, int prop, int cost, int op,
+                              bool cheaper_preconditions = true) {
+        assert(cost >= 0);
+        int &prop_cost = proposition_cost[prop];
+        if (prop_cost == -1 || prop_cost > cost) {
+            prop_cost = cost;
+            reached_by[prop] = op;
+            reached_by_cheaper[prop] = cheaper_preconditions;
+            queue.push(cost, prop);
+        } else if (prop_cost == cost && cheaper_preconditions &&
+                   (!reached_by_cheaper[prop] || op < reached_by[prop])) {
+            reached_by[prop] = op;
+            reached_by_cheaper[prop] = true;
+        }
+        assert(prop_cost != -1 && prop_cost <= cost);
+    }
+
+    /*
+      The Dijkstra exploration shared by h^add and h^max, over the unary
+      operators of levels first_level to last_level at once. It starts
+      from the propositions in the queue, and stops when the queue is
+      empty or, if stop_at_goals is set, when all goals are reached.
+
+      The cost of a unary operator starts out as its base cost. Each
+      time one of its preconditions is reached with cost prop_cost, it
+      becomes combine(op_cost, base_cost, prop_cost): their sum for
+      h^add, and the maximum of op_cost and base_cost + prop_cost for
+      h^max. The cost combination and the queue are template
+      parameters, so the inner loop has no virtual calls.
+    */
+    template<typename CostCombination, typename Queue>
+    void dijkstra_exploration(Queue &queue, CostCombination &combine,
+                              int first_level, int last_level,
+                              bool stop_at_goals);
+
+    // The variables whose values can influence an exploration over the
+    // given operator level: those of goals and unary operator
+    // preconditions.
+    void get_relevant_variables(int level, std::vector<int> &result) const;
 
     virtual void initialize();
     virtual int compute_heuristic(const State &state) = 0;
@@ -60,4 +129,45 @@ public:
     virtual ~RelaxationHeuristic();
 };
 
+template<typename CostCombination, typename Queue>
+void RelaxationHeuristic::dijkstra_exploration(
+    Queue &queue, CostCombination &combine, int first_level, int last_level,
+    bool stop_at_goals) {
+    int unsolved_goals = goal_propositions.size();
+    while (!queue.empty()) {
+        std::pair<int, int> top_pair = queue.pop();
+        int distance = top_pair.first;
+        int prop = top_pair.second;
+        int prop_cost = proposition_cost[prop];
+        assert(prop_cost >= 0);
+        assert(prop_cost <= distance);
+        if (prop_cost < distance)
+            continue;
+        if (is_goal(prop) && --unsolved_goals == 0 && stop_at_goals)
+            return;
+        for (int level = first_level; level <= last_level; level++) {
+            const UnaryOperators &ops = *unary_operators[level];
+            const int *triggered = ops.triggered.empty() ? 0 : &ops.triggered[0];
+            const int *effect = ops.effect.empty() ? 0 : &ops.effect[0];
+            const int *base_cost = ops.base_cost.empty() ? 0 : &ops.base_cost[0];
+            std::vector<int> &costs = operator_cost[level];
+            std::vector<int> &unsatisfied = unsatisfied_preconditions[level];
+            int *op_cost = costs.empty() ? 0 : &costs[0];
+            int *unsatisfied_preconditions = unsatisfied.empty() ?
+                                             0 : &unsatisfied[0];
+            int end = ops.triggered_begin[prop + 1];
+            for (int i = ops.triggered_begin[prop]; i < end; i++) {
+                int op = triggered[i];
+                op_cost[op] = combine(op_cost[op], base_cost[op], prop_cost);
+                --unsatisfied_preconditions[op];
+                assert(unsatisfied_preconditions[op] >= 0);
+                // The last precondition reached is the most expensive.
+                if (unsatisfied_preconditions[op] == 0)
+                    enqueue_if_necessary(queue, effect[op], op_cost[op], op,
+                                         op_cost[op] > prop_cost);
+            }
+        }
+    }
+}
+
 #endif
@@ -0,0 +1,288 @@
+#include "relaxed_task.h"
+
+#include "globals.h"
+#include "operator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include <ext/hash_map>
+using namespace __gnu_cxx;
+
+// Indexed by level * MAX_OPERATOR_COST + cost type.
+static vector<RelaxedTask *> relaxed_tasks;
+
+const RelaxedTask &RelaxedTask::get(int level, OperatorCost cost_type) {
+    assert(level == 0 || level == 1);
+    int index = level * MAX_OPERATOR_COST + cost_type;
+    if (relaxed_tasks.size() <= index)
+        relaxed_tasks.resize(index + 1, 0);
+    if (!relaxed_tasks[index])
+        relaxed_tasks[index] = new RelaxedTask(level, cost_type);
+    return *relaxed_tasks[index];
+}
+
+// construction and destruction
+RelaxedTask::RelaxedTask(int level_, OperatorCost cost_type_)
+    : level(level_), cost_type(cost_type_), simplified_unary_operators(0) {
+    // Build propositions.
+    num_propositions = 0;
+    for (int var = 0; var < g_variable_domain.size(); var++) {
+        proposition_offset.push_back(num_propositions);
+        num_propositions += g_variable_domain[var];
+        proposition_var.resize(num_propositions, var);
+    }
+
+    // Build goal propositions.
+    is_goal.resize(num_propositions, false);
+    for (int i = 0; i < g_goal.size(); i++) {
+        int prop = get_proposition(g_goal[i].first, g_goal[i].second);
+        is_goal[prop] = true;
+        goal_propositions.push_back(prop);
+    }
+
+    // Build operators, and unary operators for operators and axioms.
+    const vector<Operator> &ops = level == 0 ? g_operators :
+                                  g_abstract_operators;
+    vector<UnaryOperator> unary_ops;
+    for (int i = 0; i < ops.size(); i++) {
+        build_operator(ops[i]);
+        build_unary_operators(ops[i], i, unary_ops);
+    }
+    precondition_begin.push_back(preconditions.size());
+    effect_begin.push_back(effects.size());
+    for (int i = 0; i < g_axioms.size(); i++)
+        build_unary_operators(g_axioms[i], -1, unary_ops);
+
+    compile(unary_ops, unary_operators);
+}
+
+RelaxedTask::~RelaxedTask() {
+    delete simplified_unary_operators;
+}
+
+void RelaxedTask::build_operator(const Operator &op) {
+    operators.push_back(&op);
+    operator_cost.push_back(get_adjusted_action_cost(op, cost_type));
+    precondition_begin.push_back(preconditions.size());
+    effect_begin.push_back(effects.size());
+    const vector<Prevail> &prevail = op.get_prevail();
+    const vector<PrePost> &pre_post = op.get_pre_post();
+    for (int i = 0; i < prevail.size(); i++)
+        preconditions.push_back(get_proposition(prevail[i].var, prevail[i].prev));
+    for (int i = 0; i < pre_post.size(); i++) {
+        if (pre_post[i].pre != -1)
+            preconditions.push_back(get_proposition(pre_post[i].var,
+                                                    pre_post[i].pre));
+        effects.push_back(get_proposition(pre_post[i].var, pre_post[i].post));
+    }
+}
+
+void RelaxedTask::build_unary_operators(
+    const Operator &op, int operator_no, vector<UnaryOperator> &result) const {
+    int base_cost = get_adjusted_action_cost(op, cost_type);
+    const vector<Prevail> &prevail = op.get_prevail();
+    const vector<PrePost> &pre_post = op.get_pre_post();
+    vector<int> precondition;
+    for (int i = 0; i < prevail.size(); i++) {
+        assert(prevail[i].var >= 0 && prevail[i].var < g_variable_domain.size());
+        assert(prevail[i].prev >= 0 && prevail[i].prev < g_variable_domain[prevail[i].var]);
+        precondition.push_back(get_proposition(prevail[i].var, prevail[i].prev));
+    }
+    for (int i = 0; i < pre_post.size(); i++) {
+        if (pre_post[i].pre != -1) {
+            assert(pre_post[i].var >= 0 && pre_post[i].var < g_variable_domain.size());
+            assert(pre_post[i].pre >= 0 && pre_post[i].pre < g_variable_domain[pre_post[i].var]);
+            precondition.push_back(get_proposition(pre_post[i].var, pre_post[i].pre));
+        }
+    }
+    for (int i = 0; i < pre_post.size(); i++) {
+        assert(pre_post[i].var >= 0 && pre_post[i].var < g_variable_domain.size());
+        assert(pre_post[i].post >= 0 && pre_post[i].post < g_variable_domain[pre_post[i].var]);
+        int effect = get_proposition(pre_post[i].var, pre_post[i].post);
+        vector<int> unary_precondition(precondition);
+        const vector<Prevail> &eff_cond = pre_post[i].cond;
+        for (int j = 0; j < eff_cond.size(); j++) {
+            assert(eff_cond[j].var >= 0 && eff_cond[j].var < g_variable_domain.size());
+            assert(eff_cond[j].prev >= 0 && eff_cond[j].prev < g_variable_domain[eff_cond[j].var]);
+            unary_precondition.push_back(get_proposition(eff_cond[j].var, eff_cond[j].prev));
+        }
+        sort(unary_precondition.begin(), unary_precondition.end());
+        result.push_back(UnaryOperator(&op, operator_no, unary_precondition,
+                                       effect, base_cost));
+    }
+}
+
+void RelaxedTask::compile(const vector<UnaryOperator> &ops,
+                          UnaryOperators &result) const {
+    int num_ops = ops.size();
+    result.op.reserve(num_ops);
+    result.operator_no.reserve(num_ops);
+    result.effect.reserve(num_ops);
+    result.base_cost.reserve(num_ops);
+    result.num_preconditions.reserve(num_ops);
+    result.precondition_begin.reserve(num_ops + 1);
+
+    // Count the operators triggered and achieving each proposition in
+    // triggered_begin[p + 1] and achievers_begin[p + 1]; the prefix
+    // sums are then the starts of the ranges.
+    result.triggered_begin.resize(num_propositions + 1, 0);
+    result.achievers_begin.resize(num_propositions + 1, 0);
+    for (int i = 0; i < num_ops; i++) {
+        const UnaryOperator &op = ops[i];
+        result.op.push_back(op.op);
+        result.operator_no.push_back(op.operator_no);
+        result.effect.push_back(op.effect);
+        result.base_cost.push_back(op.base_cost);
+        result.num_preconditions.push_back(op.precondition.size());
+        result.precondition_begin.push_back(result.preconditions.size());
+        result.preconditions.insert(result.preconditions.end(),
+                                    op.precondition.begin(),
+                                    op.precondition.end());
+        for (int j = 0; j < op.precondition.size(); j++)
+            ++result.triggered_begin[op.precondition[j] + 1];
+        ++result.achievers_begin[op.effect + 1];
+        if (op.precondition.empty())
+            result.without_preconditions.push_back(i);
+    }
+    result.precondition_begin.push_back(result.preconditions.size());
+
+    for (int prop = 0; prop < num_propositions; prop++) {
+        result.triggered_begin[prop + 1] += result.triggered_begin[prop];
+        result.achievers_begin[prop + 1] += result.achievers_begin[prop];
+    }
+    result.triggered.resize(result.triggered_begin[num_propositions]);
+    result.achievers.resize(result.achievers_begin[num_propositions]);
+    vector<int> next_trigger(result.triggered_begin.begin(),
+                             result.triggered_begin.end() - 1);
+    vector<int> next_achiever(result.achievers_begin.begin(),
+                              result.achievers_begin.end() - 1);
+    // Operators are triggered in the order of their numbers.
+    for (int i = 0; i < num_ops; i++) {
+        const vector<int> &precondition = ops[i].precondition;
+        for (int j = 0; j < precondition.size(); j++)
+            result.triggered[next_trigger[precondition[j]]++] = i;
+        result.achievers[next_achiever[ops[i].effect]++] = i;
+    }
+}
+
+const UnaryOperators &RelaxedTask::get_unary_operators(bool simplified) const {
+    if (!simplified)
+        return unary_operators;
+    if (!simplified_unary_operators) {
+        const UnaryOperators &ops = unary_operators;
+        vector<UnaryOperator> unary_ops;
+        unary_ops.reserve(ops.size());
+        for (int i = 0; i < ops.size(); i++) {
+            vector<int> precondition(
+                ops.preconditions.begin() + ops.precondition_begin[i],
+                ops.preconditions.begin() + ops.precondition_begin[i + 1]);
+            unary_ops.push_back(UnaryOperator(
+                                    ops.op[i], ops.operator_no[i], precondition,
+                                    ops.effect[i], ops.base_cost[i]));
+        }
+        simplify(unary_ops);
+        simplified_unary_operators = new UnaryOperators;
+        compile(unary_ops, *simplified_unary_operators);
+    }
+    return *simplified_unary_operators;
+}
+
+class hash_unary_operator {
+public:
+    size_t operator()(const pair<vector<int>, int> &key) const {
+        // NOTE: We used to hash the Proposition* values directly, but
+        // this had the disadvantage that the results were not
+        // reproducible. This propagates through to the heuristic
+        // computation: runs on different computers could lead to
+        // different initial h values, for example.
+
+        unsigned long hash_value = key.second;
+        const vector<int> &vec = key.first;
+        for (int i = 0; i < vec.size(); i++)
+            hash_value = 17 * hash_value + vec[i];
+        return size_t(hash_value);
+    }
+};
+
+
+void RelaxedTask::simplify(vector<UnaryOperator> &ops) const {
+    // Remove duplicate or dominated unary operators.
+
+    /*
+      Algorithm: Put all unary operators into a hash_map
+      (key: condition and effect; value: index in operator vector.
+      This gets rid of operators with identical conditions.
+
+      Then go through the hash_map, checking for each element if
+      none of the possible dominators are part of the hash_map.
+      Put the element into the new operator vector iff this is the case.
+
+      In both loops, be careful to ensure that a higher-cost operator
+      never dominates a lower-cost operator.
+    */
+
+    cout << "Simplifying " << ops.size() << " unary operators..." << flush;
+
+    typedef pair<vector<int>, int> HashKey;
+    typedef hash_map<HashKey, int, hash_unary_operator> HashMap;
+    HashMap unary_operator_index;
+    unary_operator_index.resize(ops.size() * 2);
+
+    for (int i = 0; i < ops.size(); i++) {
+        const UnaryOperator &op = ops[i];
+        // The preconditions are sorted already.
+        HashKey key(op.precondition, op.effect);
+        pair<HashMap::iterator, bool> inserted = unary_operator_index.insert(
+            make_pair(key, i));
+        if (!inserted.second) {
+            // We already had an element with this key; check its cost.
+
+            HashMap::iterator iter = inserted.first;
+            int old_op_no = iter->second;
+            int old_cost = ops[old_op_no].base_cost;
+            int new_cost = ops[i].base_cost;
+            if (new_cost < old_cost)
+                iter->second = i;
+            assert(ops[unary_operator_index[key]].base_cost ==
+                   min(old_cost, new_cost));
+        }
+    }
+
+    vector<UnaryOperator> old_unary_operators;
+    old_unary_operators.swap(ops);
+
+    for (HashMap::iterator it = unary_operator_index.begin();
+         it != unary_operator_index.end(); ++it) {
+        const HashKey &key = it->first;
+        int unary_operator_no = it->second;
+        int powerset_size = (1 << key.first.size()) - 1; // -1: only consider proper subsets
+        bool match = false;
+        if (powerset_size <= 31) { // HACK! Don't spend too much time here...
+            for (int mask = 0; mask < powerset_size; mask++) {
+                HashKey dominating_key = make_pair(vector<int>(), key.second);
+                for (int i = 0; i < key.first.size(); i++)
+                    if (mask & (1 << i))
+                        dominating_key.first.push_back(key.first[i]);
+                HashMap::iterator found = unary_operator_index.find(
+                    dominating_key);
+                if (found != unary_operator_index.end()) {
+                    int my_cost = old_unary_operators[unary_operator_no].base_cost;
+                    int dominator_op_no = found->second;
+                    int dominator_cost = old_unary_operators[dominator_op_no].base_cost;
+                    if (dominator_cost <= my_cost) {
+                        match = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (!match)
+            ops.push_back(old_unary_operators[unary_operator_no]);
+    }
+
+    cout << " done! [" << ops.size() << " unary operators]" << endl;
+}
@@ -0,0 +1,180 @@
+#ifndef RELAXED_TASK_H
+#define RELAXED_TASK_H
+
+#include "operator_cost.h"
+
+#include <vector>
+
+class Operator;
+
+/*
+  Unary operators (one per effect of an operator or axiom, with the
+  effect conditions added to the preconditions).
+
+  Everything is stored in flat int arrays indexed by unary operator
+  or proposition number, so that explorations only walk through
+  contiguous memory. The preconditions of unary operator i are
+  preconditions[precondition_begin[i]] up to (excluding)
+  preconditions[precondition_begin[i + 1]], sorted by proposition
+  number. The unary operators that have proposition p as a
+  precondition are triggered[triggered_begin[p]] up to
+  triggered[triggered_begin[p + 1]], by increasing number.
+  achievers_begin and achievers list the unary operators with effect p
+  in the same way.
+
+  The arrays never change after construction. Explorations keep their
+  own per-operator data (costs, unsatisfied preconditions etc.).
+*/
+struct UnaryOperators {
+    std::vector<const Operator *> op; // the operator or axiom
+    std::vector<int> operator_no; // -1 for axioms; index into g_operators
+                                  // (level 0) or g_abstract_operators
+                                  // (level 1) otherwise
+    std::vector<int> effect;
+    std::vector<int> base_cost;
+    std::vector<int> num_preconditions;
+    std::vector<int> precondition_begin;
+    std::vector<int> preconditions;
+    std::vector<int> triggered_begin;
+    std::vector<int> triggered;
+    std::vector<int> achievers_begin;
+    std::vector<int> achievers;
+    std::vector<int> without_preconditions;
+
+    int size() const {
+        return operator_no.size();
+    }
+};
+
+/*
+  The delete relaxation of the task over one operator level (0: the
+  operators of the task, 1: the abstract operators; both levels
+  include the axioms), built once and shared by all heuristics that
+  explore it: h^add, h^FF, h^max, LM-cut and the Exploration of the
+  landmark code. Since the operator costs are part of it, there is
+  one instance per operator level and cost type.
+
+  Propositions are numbered consecutively, variable by variable.
+
+  Besides the unary operators, the relaxed task lists the operators of
+  the level with all their preconditions (prevail conditions first)
+  and effects, for heuristics that do not split operators (LM-cut).
+  These do not include the axioms and ignore effect conditions.
+*/
+class RelaxedTask {
+    struct UnaryOperator {
+        const Operator *op;
+        int operator_no;
+        std::vector<int> precondition;
+        int effect;
+        int base_cost;
+
+        UnaryOperator(const Operator *op_, int operator_no_,
+                      const std::vector<int> &pre, int eff, int base)
+            : op(op_), operator_no(operator_no_), precondition(pre),
+              effect(eff), base_cost(base) {}
+    };
+
+    int level;
+    OperatorCost cost_type;
+
+    std::vector<int> proposition_offset;
+    std::vector<int> proposition_var;
+    int num_propositions;
+    std::vector<bool> is_goal;
+    std::vector<int> goal_propositions;
+
+    std::vector<const Operator *> operators;
+    std::vector<int> operator_cost;
+    std::vector<int> precondition_begin;
+    std::vector<int> preconditions;
+    std::vector<int> effect_begin;
+    std::vector<int> effects;
+
+    UnaryOperators unary_operators;
+    // Built on first use.
+    mutable UnaryOperators *simplified_unary_operators;
+
+    RelaxedTask(int level, OperatorCost cost_type);
+    ~RelaxedTask();
+
+    void build_operator(const Operator &op);
+    void build_unary_operators(const Operator &op, int operator_no,
+                               std::vector<UnaryOperator> &result) const;
+    void simplify(std::vector<UnaryOperator> &ops) const;
+    void compile(const std::vector<UnaryOperator> &ops,
+                 UnaryOperators &result) const;
+
+    // not implemented
+    RelaxedTask(const RelaxedTask &);
+    RelaxedTask &operator=(const RelaxedTask &);
+public:
+    // Returns the relaxed task of the given operator level and cost
+    // type, building it on first use. (This is not thread-safe; all
+    // heuristics are initialized in the main thread.)
+    static const RelaxedTask &get(int level, OperatorCost cost_type);
+
+    int get_level() const {
+        return level;
+    }
+
+    int get_num_propositions() const {
+        return num_propositions;
+    }
+
+    int get_proposition(int var, int value) const {
+        return proposition_offset[var] + value;
+    }
+
+    int get_var(int prop) const {
+        return proposition_var[prop];
+    }
+
+    int get_value(int prop) const {
+        return prop - proposition_offset[proposition_var[prop]];
+    }
+
+    bool is_goal_proposition(int prop) const {
+        return is_goal[prop];
+    }
+
+    const std::vector<int> &get_goal_propositions() const {
+        return goal_propositions;
+    }
+
+    int get_num_operators() const {
+        return operators.size();
+    }
+
+    const Operator &get_operator(int op_no) const {
+        return *operators[op_no];
+    }
+
+    int get_operator_cost(int op_no) const {
+        return operator_cost[op_no];
+    }
+
+    std::vector<int>::const_iterator preconditions_begin(int op_no) const {
+        return preconditions.begin() + precondition_begin[op_no];
+    }
+
+    std::vector<int>::const_iterator preconditions_end(int op_no) const {
+        return preconditions.begin() + precondition_begin[op_no + 1];
+    }
+
+    std::vector<int>::const_iterator effects_begin(int op_no) const {
+        return effects.begin() + effect_begin[op_no];
+    }
+
+    std::vector<int>::const_iterator effects_end(int op_no) const {
+        return effects.begin() + effect_begin[op_no + 1];
+    }
+
+    // With simplified = true, duplicate unary operators and those
+    // dominated by an operator with the same effect, a subset of the
+    // preconditions and at most the same cost are removed. This must
+    // not be used by explorations that exclude some operators.
+    const UnaryOperators &get_unary_operators(bool simplified) const;
+};
+
+#endif
@@ -9,7 +9,8 @@ using namespace std;
 #include "option_parser.h"
 
 SearchEngine::SearchEngine(const Options &opts)
-    : search_space(OperatorCost(opts.get_enum("cost_type"))),
+    : search_space(*g_state_registry,
+                   OperatorCost(opts.get_enum("cost_type"))),
       cost_type(OperatorCost(opts.get_enum("cost_type"))) {
     solved = false;
     if (opts.get<int>("bound") < 0) {
@@ -1,7 +1,9 @@
 #ifndef SEARCH_NODE_INFO_H
 #define SEARCH_NODE_INFO_H
 
-#include "state.h"
+#include "state_id.h"
+
+class Operator;
 
 class SearchNodeInfo {
     friend class SearchNode;
@@ -13,14 +15,14 @@ class SearchNodeInfo {
     int g : 30;
     int h : 31; // TODO:CR - should we get rid of it
     bool h_is_dirty : 1;
-    const state_var_t *parent_state;
+    StateID parent_state_id;
     const Operator *creating_operator;
     int real_g;
     int k;
 
     SearchNodeInfo()
         : status(NEW), g(-1), h(-1), h_is_dirty(false),
-          parent_state(0), creating_operator(0), real_g(-1), k(0) {
+          parent_state_id(StateID::no_state), creating_operator(0), real_g(-1), k(0) {
     }
 };
 
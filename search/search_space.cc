@@ -1,24 +1,24 @@
 #include "search_space.h"
-#include "state.h"
+
+#include "globals.h"
 #include "operator.h"
+#include "state.h"
+#include "state_registry.h"
+#include "search_node_info.h"
 
 #include <cassert>
-#include <ext/hash_map>
-#include "state_proxy.h"
-#include "search_node_info.h"
 
 using namespace std;
-using namespace __gnu_cxx;
-
 
 
-
-SearchNode::SearchNode(state_var_t *state_buffer_, SearchNodeInfo &info_, OperatorCost cost_type_)
-    : state_buffer(state_buffer_), info(info_), cost_type(cost_type_) {
+SearchNode::SearchNode(StateRegistry &state_registry_, StateID state_id_,
+                       SearchNodeInfo &info_, OperatorCost cost_type_)
+    : state_registry(state_registry_), state_id(state_id_), info(info_),
+      cost_type(cost_type_) {
 }
 
 State SearchNode::get_state() const {
-    return State(state_buffer);
+    return state_registry.lookup_state(state_id);
 }
 
 bool SearchNode::is_open() const {
@@ -65,8 +65,12 @@ int SearchNode::get_k() const {
     return info.k;
 }
 
-const state_var_t *SearchNode::get_parent_buffer() const {
-    return info.parent_state;
+StateID SearchNode::get_parent_state_id() const {
+    return info.parent_state_id;
+}
+
+const Operator *SearchNode::get_creating_operator() const {
+    return info.creating_operator;
 }
 
 void SearchNode::open_initial(int h) {
@@ -76,7 +80,7 @@ void SearchNode::open_initial(int h) {
     info.real_g = 0;
     info.h = h;
     info.k = 0;
-    info.parent_state = 0;
+    info.parent_state_id = StateID::no_state;
     info.creating_operator = 0;
 }
 
@@ -88,7 +92,7 @@ void SearchNode::open(int h, const SearchNode &parent_node,
     info.real_g = parent_node.info.real_g + parent_op->get_cost();
     info.h = h;
     info.k = parent_node.get_k() + 1;
-    info.parent_state = parent_node.state_buffer;
+    info.parent_state_id = parent_node.state_id;
     info.creating_operator = parent_op;
 }
 
@@ -102,11 +106,34 @@ void SearchNode::reopen(const SearchNode &parent_node,
     info.status = SearchNodeInfo::OPEN;
     info.g = parent_node.info.g + get_adjusted_action_cost(*parent_op, cost_type);
     info.real_g = parent_node.info.real_g + parent_op->get_cost();
-    info.parent_state = parent_node.state_buffer;
+    info.parent_state_id = parent_node.state_id;
     info.k = parent_node.get_k() + 1;
     info.creating_operator = parent_op;
 }
 
+void SearchNode::open(int h, int g, int real_g, StateID parent_state_id,
+                      const Operator *parent_op) {
+    assert(info.status == SearchNodeInfo::NEW);
+    info.status = SearchNodeInfo::OPEN;
+    info.g = g;
+    info.real_g = real_g;
+    info.h = h;
+    info.k = 0;
+    info.parent_state_id = parent_state_id;
+    info.creating_operator = parent_op;
+}
+
+void SearchNode::reopen(int g, int real_g, StateID parent_state_id,
+                        const Operator *parent_op) {
+    assert(info.status == SearchNodeInfo::OPEN ||
+           info.status == SearchNodeInfo::CLOSED);
+    info.status = SearchNodeInfo::OPEN;
+    info.g = g;
+    info.real_g = real_g;
+    info.parent_state_id = parent_state_id;
+    info.creating_operator = parent_op;
+}
+
 // like reopen, except doesn't change status
 void SearchNode::update_parent(const SearchNode &parent_node,
                                const Operator *parent_op) {
@@ -117,7 +144,7 @@ void SearchNode::update_parent(const SearchNode &parent_node,
     info.k = parent_node.get_k() + 1;
     info.g = parent_node.info.g + get_adjusted_action_cost(*parent_op, cost_type);
     info.real_g = parent_node.info.real_g + parent_op->get_cost();
-    info.parent_state = parent_node.state_buffer;
+    info.parent_state_id = parent_node.state_id;
     info.creating_operator = parent_op;
 }
 
@@ -136,72 +163,63 @@ void SearchNode::mark_as_dead_end() {
 }
 
 void SearchNode::dump() {
-    cout << state_buffer << ": ";
-    State(state_buffer).dump_fdr();
+    cout << state_id << ": ";
+    get_state().dump_fdr();
     cout << " created by " << info.creating_operator->get_name()
-         << " from " << info.parent_state << endl;
+         << " from " << info.parent_state_id << endl;
 }
 
-class SearchSpace::HashTable
-    : public __gnu_cxx::hash_map<StateProxy, SearchNodeInfo> {
-    // This is more like a typedef really, but we need a proper class
-    // so that we can hide the information in the header file by using
-    // a forward declaration. This is also the reason why the hash
-    // table is allocated dynamically in the constructor.
-};
-
-
-SearchSpace::SearchSpace(OperatorCost cost_type_)
-    : cost_type(cost_type_) {
-    nodes = new HashTable;
+SearchSpace::SearchSpace(StateRegistry &state_registry_,
+                         OperatorCost cost_type_)
+    : state_registry(state_registry_),
+      search_node_infos(SearchNodeInfo()),
+      cost_type(cost_type_) {
 }
 
 SearchSpace::~SearchSpace() {
-    delete nodes;
 }
 
 int SearchSpace::size() const {
-    return nodes->size();
+    return search_node_infos.size();
 }
 
 SearchNode SearchSpace::get_node(const State &state) {
-    static SearchNodeInfo default_info;
-    pair<HashTable::iterator, bool> result = nodes->insert(
-        make_pair(StateProxy(&state), default_info));
-    if (result.second) {
-        // This is a new entry: Must give the state permanent lifetime.
-        result.first->first.make_permanent();
-    }
-    HashTable::iterator iter = result.first;
-    return SearchNode(iter->first.state_data, iter->second, cost_type);
+    return get_node(state_registry.get_id(state));
+}
+
+SearchNode SearchSpace::get_node(StateID id) {
+    return SearchNode(state_registry, id, search_node_infos[id], cost_type);
 }
 
 void SearchSpace::trace_path(const State &goal_state,
                              vector<const Operator *> &path) const {
-    StateProxy current_state(&goal_state);
+    StateID current_state_id = state_registry.get_id(goal_state);
     assert(path.empty());
     for (;;) {
-        HashTable::const_iterator iter = nodes->find(current_state);
-        assert(iter != nodes->end());
-        const SearchNodeInfo &info = iter->second;
+        const SearchNodeInfo &info = search_node_infos[current_state_id];
+        assert(info.status != SearchNodeInfo::NEW);
         const Operator *op = info.creating_operator;
         if (op == 0)
             break;
         path.push_back(op);
-        current_state = StateProxy(const_cast<state_var_t *>(info.parent_state));
+        current_state_id = info.parent_state_id;
     }
     reverse(path.begin(), path.end());
 }
 
 void SearchSpace::dump() {
-    int i = 0;
-    for (HashTable::iterator iter = nodes->begin(); iter != nodes->end(); iter++) {
-        cout << "#" << i++ << " (" << iter->first.state_data << "): ";
-        State(iter->first.state_data).dump_fdr();
-        if (iter->second.creating_operator &&
-            iter->second.parent_state) {
-            cout << " created by " << iter->second.creating_operator->get_name()
-                 << " from " << iter->second.parent_state << endl;
+    int num_states = state_registry.size();
+    for (int i = 0; i < num_states; ++i) {
+        StateID id = state_registry.get_id_for_index(i);
+        const SearchNodeInfo &info = search_node_infos[id];
+        if (info.status == SearchNodeInfo::NEW)
+            continue;
+        cout << id << ": ";
+        state_registry.lookup_state(id).dump_fdr();
+        if (info.creating_operator &&
+            info.parent_state_id != StateID::no_state) {
+            cout << " created by " << info.creating_operator->get_name()
+                 << " from " << info.parent_state_id << endl;
         } else {
             cout << "has no parent" << endl;
         }
@@ -209,6 +227,6 @@ void SearchSpace::dump() {
 }
 
 void SearchSpace::statistics() const {
-    cout << "Search space hash size: " << nodes->size() << endl;
-    cout << "Search space hash bucket count: " << nodes->bucket_count() << endl;
+    cout << "Search space size: " << search_node_infos.size() << endl;
+    state_registry.statistics();
 }
@@ -1,29 +1,29 @@
 #ifndef SEARCH_SPACE_H
 #define SEARCH_SPACE_H
 
-#include "state.h" // for state_var_t
-#include <vector>
-#include <ext/hash_map>
 #include "state.h"
-#include "state_proxy.h"
+#include "state_id.h"
 #include "search_node_info.h"
 #include "operator_cost.h"
+#include "per_state_information.h"
 
 #include <vector>
 
 class Operator;
 class State;
-class StateProxy;
+class StateRegistry;
 
 class SearchNode {
-    state_var_t *state_buffer;
+    StateRegistry &state_registry;
+    StateID state_id;
     SearchNodeInfo &info;
     OperatorCost cost_type;
 public:
-    SearchNode(state_var_t *state_buffer_, SearchNodeInfo &info_, OperatorCost cost_type_);
+    SearchNode(StateRegistry &state_registry_, StateID state_id_,
+               SearchNodeInfo &info_, OperatorCost cost_type_);
 
-    state_var_t *get_state_buffer() {
-        return state_buffer;
+    StateID get_state_id() const {
+        return state_id;
     }
     State get_state() const;
 
@@ -39,13 +39,21 @@ public:
     int get_real_g() const;
     int get_h() const;
     int get_k() const;
-    const state_var_t *get_parent_buffer() const;
+    StateID get_parent_state_id() const;
+    const Operator *get_creating_operator() const;
 
     void open_initial(int h);
     void open(int h, const SearchNode &parent_node,
               const Operator *parent_op);
     void reopen(const SearchNode &parent_node,
                 const Operator *parent_op);
+    // Like open and reopen, but for a parent that is not a node of
+    // this search space (e.g. one of another thread in HDA*), so the
+    // costs are given explicitly. These do not maintain k.
+    void open(int h, int g, int real_g, StateID parent_state_id,
+              const Operator *parent_op);
+    void reopen(int g, int real_g, StateID parent_state_id,
+                const Operator *parent_op);
     void update_parent(const SearchNode &parent_node,
                        const Operator *parent_op);
     void increase_h(int h);
@@ -56,15 +64,18 @@ public:
 };
 
 
+// The nodes of the states of one state registry (g_state_registry,
+// except in HDA*, where every thread has its own).
 class SearchSpace {
-    class HashTable;
-    HashTable *nodes;
+    StateRegistry &state_registry;
+    PerStateInformation<SearchNodeInfo> search_node_infos;
     OperatorCost cost_type;
 public:
-    SearchSpace(OperatorCost cost_type_);
+    SearchSpace(StateRegistry &state_registry_, OperatorCost cost_type_);
     ~SearchSpace();
     int size() const;
     SearchNode get_node(const State &state);
+    SearchNode get_node(StateID id);
     void trace_path(const State &goal_state,
                     std::vector<const Operator *> &path) const;
 
@@ -0,0 +1,200 @@
+#ifndef SEGMENTED_VECTOR_H
+#define SEGMENTED_VECTOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+  SegmentedVector is a vector-like container that stores its elements
+  in segments of fixed byte size. Unlike std::vector, it never moves
+  elements once they have been added, so references to elements stay
+  valid while the container grows, and growing never temporarily needs
+  twice the memory.
+
+  The search uses this for all information that is stored per
+  registered state (see PerStateInformation).
+*/
+
+template<class Entry>
+class SegmentedVector {
+    static const size_t SEGMENT_BYTES = 8192;
+    static const size_t SEGMENT_ELEMENTS =
+        (SEGMENT_BYTES / sizeof(Entry)) > 0 ? (SEGMENT_BYTES / sizeof(Entry)) : 1;
+
+    std::allocator<Entry> entry_allocator;
+
+    std::vector<Entry *> segments;
+    size_t the_size;
+
+    size_t get_segment(size_t index) const {
+        return index / SEGMENT_ELEMENTS;
+    }
+
+    size_t get_offset(size_t index) const {
+        return index % SEGMENT_ELEMENTS;
+    }
+
+    void add_segment() {
+        segments.push_back(entry_allocator.allocate(SEGMENT_ELEMENTS));
+    }
+
+    // No implementation to forbid copies and assignment.
+    SegmentedVector(const SegmentedVector<Entry> &);
+    SegmentedVector &operator=(const SegmentedVector<Entry> &);
+public:
+    SegmentedVector()
+        : the_size(0) {
+    }
+
+    ~SegmentedVector() {
+        clear();
+    }
+
+    Entry &operator[](size_t index) {
+        assert(index < the_size);
+        return segments[get_segment(index)][get_offset(index)];
+    }
+
+    const Entry &operator[](size_t index) const {
+        assert(index < the_size);
+        return segments[get_segment(index)][get_offset(index)];
+    }
+
+    void push_back(const Entry &entry) {
+        size_t segment = get_segment(the_size);
+        size_t offset = get_offset(the_size);
+        if (segment == segments.size()) {
+            assert(offset == 0);
+            // Must add a new segment.
+            add_segment();
+        }
+        entry_allocator.construct(segments[segment] + offset, entry);
+        ++the_size;
+    }
+
+    void resize(size_t new_size, const Entry &entry) {
+        // Shrinking is not needed by any of the users, so we only grow.
+        assert(new_size >= the_size);
+        while (the_size < new_size)
+            push_back(entry);
+    }
+
+    size_t size() const {
+        return the_size;
+    }
+
+    void clear() {
+        for (size_t index = 0; index < the_size; ++index)
+            entry_allocator.destroy(&operator[](index));
+        for (size_t i = 0; i < segments.size(); ++i)
+            entry_allocator.deallocate(segments[i], SEGMENT_ELEMENTS);
+        segments.clear();
+        the_size = 0;
+    }
+};
+
+
+/*
+  SegmentedArrayVector is a vector-like container for fixed-size
+  arrays of a given element type. The arrays are stored back to back
+  in segments of fixed byte size, so that
+
+  - element addresses are stable (we never reallocate a segment),
+  - growing the container never copies existing data (and hence never
+    temporarily needs twice the memory, as std::vector does), and
+  - there is no per-array allocation overhead.
+
+  The search uses this to store the packed data of all registered
+  states (see StateRegistry).
+*/
+
+template<class Element>
+class SegmentedArrayVector {
+    static const size_t SEGMENT_BYTES = 8192;
+
+    size_t elements_per_array;
+    size_t arrays_per_segment;
+    size_t elements_per_segment;
+
+    std::vector<Element *> segments;
+    size_t the_size;
+
+    size_t get_segment(size_t index) const {
+        return index / arrays_per_segment;
+    }
+
+    size_t get_offset(size_t index) const {
+        return elements_per_array * (index % arrays_per_segment);
+    }
+
+    void add_segment() {
+        segments.push_back(new Element[elements_per_segment]);
+    }
+
+    // No implementation to forbid copies and assignment.
+    SegmentedArrayVector(const SegmentedArrayVector<Element> &);
+    SegmentedArrayVector &operator=(const SegmentedArrayVector<Element> &);
+public:
+    explicit SegmentedArrayVector(size_t elements_per_array_)
+        : elements_per_array(elements_per_array_),
+          the_size(0) {
+        assert(elements_per_array > 0);
+        arrays_per_segment = SEGMENT_BYTES / (elements_per_array * sizeof(Element));
+        if (arrays_per_segment == 0)
+            arrays_per_segment = 1;
+        elements_per_segment = elements_per_array * arrays_per_segment;
+    }
+
+    ~SegmentedArrayVector() {
+        for (size_t i = 0; i < segments.size(); ++i)
+            delete[] segments[i];
+    }
+
+    Element *operator[](size_t index) {
+        assert(index < the_size);
+        return segments[get_segment(index)] + get_offset(index);
+    }
+
+    const Element *operator[](size_t index) const {
+        assert(index < the_size);
+        return segments[get_segment(index)] + get_offset(index);
+    }
+
+    void push_back(const Element *entry) {
+        size_t segment = get_segment(the_size);
+        size_t offset = get_offset(the_size);
+        if (segment == segments.size()) {
+            assert(offset == 0);
+            // Must add a new segment.
+            add_segment();
+        }
+        Element *dest = segments[segment] + offset;
+        for (size_t i = 0; i < elements_per_array; ++i)
+            dest[i] = entry[i];
+        ++the_size;
+    }
+
+    void pop_back() {
+        // We keep the last segment around even if it becomes empty:
+        // the typical use is a push_back immediately followed by a
+        // pop_back, and freeing the segment would thrash the allocator.
+        assert(the_size > 0);
+        --the_size;
+    }
+
+    size_t size() const {
+        return the_size;
+    }
+
+    size_t get_num_segments() const {
+        return segments.size();
+    }
+
+    size_t get_memory_in_bytes() const {
+        return segments.size() * elements_per_segment * sizeof(Element);
+    }
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "axioms.h"
 #include "globals.h"
 #include "operator.h"
+#include "rng.h"
 #include "utilities.h"
 
 #include <algorithm>
@@ -10,14 +11,38 @@
 #include <cassert>
 using namespace std;
 
+vector<vector<size_t> > State::zobrist_keys;
+vector<int> State::derived_variables;
+
+void State::initialize_zobrist_keys() {
+    /*
+      We use a fixed seed (rather than g_rng) so that hash values, and
+      hence hash table layouts, do not depend on --random-seed and do
+      not change the random numbers seen by the rest of the planner.
+    */
+    RandomNumberGenerator rng(2011);
+    int num_vars = g_variable_domain.size();
+    zobrist_keys.resize(num_vars);
+    derived_variables.clear();
+    for (int var = 0; var < num_vars; ++var) {
+        zobrist_keys[var].resize(g_variable_domain[var]);
+        for (int value = 0; value < g_variable_domain[var]; ++value) {
+            // Shifting twice keeps this well-defined for 32-bit size_t.
+            size_t key = rng.next32();
+            key = ((key << 16) << 16) ^ rng.next32();
+            zobrist_keys[var][value] = key;
+        }
+        if (g_axiom_layers[var] != -1)
+            derived_variables.push_back(var);
+    }
+}
+
 void State::_allocate() {
-    borrowed_buffer = false;
     vars = new state_var_t[g_variable_domain.size()];
 }
 
 void State::_deallocate() {
-    if (!borrowed_buffer)
-        delete[] vars;
+    delete[] vars;
 }
 
 void State::_copy_buffer_from_state(const State &state) {
@@ -29,14 +54,21 @@ void State::_copy_buffer_from_state(const State &state) {
 
 State & State::operator=(const State &other) {
     if (this != &other) {
-        if (borrowed_buffer)
-            _allocate();
         _copy_buffer_from_state(other);
+        id = other.id;
+        hash_value = other.hash_value;
+        hash_valid = other.hash_valid;
     }
     return *this;
 }
 
-State::State(istream &in) {
+State::State()
+    : id(StateID::no_state), hash_value(0), hash_valid(false) {
+    _allocate();
+}
+
+State::State(istream &in)
+    : id(StateID::no_state), hash_value(0), hash_valid(false) {
     _allocate();
     check_magic(in, "begin_state");
     for (int i = 0; i < g_variable_domain.size(); i++) {
@@ -49,23 +81,44 @@ State::State(istream &in) {
     g_default_axiom_values.assign(vars, vars + g_variable_domain.size());
 }
 
-State::State(const State &state) {
+State::State(const State &state)
+    : id(state.id), hash_value(state.hash_value),
+      hash_valid(state.hash_valid) {
     _allocate();
     _copy_buffer_from_state(state);
 }
 
-State::State(const State &predecessor, const Operator &op) {
+State::State(const State &predecessor, const Operator &op)
+    : id(StateID::no_state), hash_value(predecessor.hash()),
+      hash_valid(true) {
     assert(!op.is_axiom());
     _allocate();
     _copy_buffer_from_state(predecessor);
-    // Update values affected by operator.
+    // Update values affected by operator, and the hash value with them.
     for (int i = 0; i < op.get_pre_post().size(); i++) {
         const PrePost &pre_post = op.get_pre_post()[i];
-        if (pre_post.does_fire(predecessor))
-            vars[pre_post.var] = pre_post.post;
+        if (pre_post.does_fire(predecessor)) {
+            int var = pre_post.var;
+            hash_value ^= zobrist_keys[var][vars[var]] ^
+                          zobrist_keys[var][pre_post.post];
+            vars[var] = pre_post.post;
+        }
     }
 
-    g_axiom_evaluator->evaluate(*this);
+    // Without derived variables, the axiom evaluator has nothing to do.
+    if (!derived_variables.empty()) {
+        for (int i = 0; i < derived_variables.size(); ++i) {
+            int var = derived_variables[i];
+            hash_value ^= zobrist_keys[var][vars[var]];
+        }
+        g_axiom_evaluator->evaluate(*this);
+        for (int i = 0; i < derived_variables.size(); ++i) {
+            int var = derived_variables[i];
+            hash_value ^= zobrist_keys[var][vars[var]];
+        }
+        // evaluate() writes through operator[], which resets hash_valid.
+        hash_valid = true;
+    }
 }
 
 State::~State() {
@@ -100,5 +153,11 @@ bool State::operator<(const State &other) const {
 }
 
 size_t State::hash() const {
-    return ::hash_number_sequence(vars, g_variable_domain.size());
+    if (!hash_valid) {
+        hash_value = 0;
+        for (int var = 0; var < g_variable_domain.size(); ++var)
+            hash_value ^= zobrist_keys[var][vars[var]];
+        hash_valid = true;
+    }
+    return hash_value;
 }
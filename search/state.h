@@ -7,22 +7,45 @@ using namespace std;
 
 class Operator;
 
+#include "state_id.h"
 #include "state_var_t.h"
 
 class State {
+    friend class StateRegistry;
     state_var_t *vars; // values for vars
-    bool borrowed_buffer;
+    // ID of the state in the StateRegistry, or StateID::no_state if the
+    // state has not been registered (e.g. a freshly generated successor).
+    StateID id;
+    /*
+      Zobrist hash of the state: the XOR of one random key per
+      (variable, value) pair. Successor states update it incrementally
+      for the variables changed by the operator, so hashing a successor
+      costs O(#effects) rather than O(#variables). Writing to the state
+      through the non-const operator[] invalidates it, and hash()
+      recomputes it from scratch on the next call.
+    */
+    mutable size_t hash_value;
+    mutable bool hash_valid;
+    static std::vector<std::vector<size_t> > zobrist_keys;
+    static std::vector<int> derived_variables;
     void _allocate();
     void _deallocate();
     void _copy_buffer_from_state(const State &state);
 
+    // Creates a state with an uninitialized buffer. Only used by the
+    // StateRegistry, which fills in the values when unpacking.
+    State();
+
 public:
     explicit State(istream &in);
     State(const State &state);
     State(const State &predecessor, const Operator &op);
     ~State();
     State &operator=(const State &other);
+    // Only use this on unregistered states: changing the values of a
+    // registered state would make it disagree with its registry entry.
     state_var_t &operator[](int index) {
+        hash_valid = false;
         return vars[index];
     }
     int operator[](int index) const {
@@ -34,14 +57,20 @@ public:
     bool operator<(const State &other) const;
     size_t hash() const;
 
-
-    explicit State(state_var_t *buffer) {
-        vars = buffer;
-        borrowed_buffer = true;
+    StateID get_id() const {
+        return id;
     }
+
+    // The values of all variables, e.g. for vectorised lookups.
     const state_var_t *get_buffer() const {
         return vars;
     }
+
+    // Must be called once after the variables have been read.
+    static void initialize_zobrist_keys();
+    static size_t get_zobrist_key(int var, int value) {
+        return zobrist_keys[var][value];
+    }
 };
 
 #endif
@@ -0,0 +1,56 @@
+#ifndef STATE_ID_H
+#define STATE_ID_H
+
+#include <cstddef>
+#include <iostream>
+#include <ext/hash_map>
+
+// For documentation on classes relevant to storing and working with
+// registered states see the file state_registry.h.
+
+class StateID {
+    friend class StateRegistry;
+    template<class Entry>
+    friend class PerStateInformation;
+    friend std::ostream &operator<<(std::ostream &os, StateID id);
+
+    // No implementation to prevent default construction; use
+    // StateID::no_state to get an ID that does not refer to any state.
+    StateID();
+
+    explicit StateID(int value_)
+        : value(value_) {
+    }
+
+    int value;
+public:
+    static const StateID no_state;
+
+    ~StateID() {
+    }
+
+    bool operator==(const StateID &other) const {
+        return value == other.value;
+    }
+
+    bool operator!=(const StateID &other) const {
+        return !(*this == other);
+    }
+
+    size_t hash() const {
+        return value;
+    }
+};
+
+std::ostream &operator<<(std::ostream &os, StateID id);
+
+namespace __gnu_cxx {
+template<>
+struct hash<StateID> {
+    size_t operator()(StateID id) const {
+        return id.hash();
+    }
+};
+}
+
+#endif
@@ -1 +0,0 @@
-#include "state_proxy.h"
@@ -0,0 +1,136 @@
+#include "state_registry.h"
+
+#include "globals.h"
+#include "state.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+size_t StateRegistry::StateIDSemanticHash::operator()(StateID id) const {
+    const PackedStateBin *data = state_data_pool[id.value];
+    size_t hash = 0;
+    int num_vars = g_variable_domain.size();
+    for (int var = 0; var < num_vars; ++var)
+        hash ^= State::get_zobrist_key(var, state_packer.get(data, var));
+    return hash;
+}
+
+bool StateRegistry::StateIDSemanticEqual::operator()(StateID lhs,
+                                                     StateID rhs) const {
+    const PackedStateBin *lhs_data = state_data_pool[lhs.value];
+    const PackedStateBin *rhs_data = state_data_pool[rhs.value];
+    return ::equal(lhs_data, lhs_data + state_size, rhs_data);
+}
+
+
+StateRegistry::StateRegistry(StateHashTableType hash_table_type_)
+    : state_packer(g_variable_domain),
+      state_data_pool(state_packer.get_num_bins()),
+      hash_table_type(hash_table_type_),
+      registered_states(StateID::no_state,
+                        StateIDSemanticHash(state_data_pool, state_packer),
+                        StateIDSemanticEqual(state_data_pool,
+                                             state_packer.get_num_bins())),
+      chained_registered_states(0,
+                                StateIDSemanticHash(state_data_pool,
+                                                    state_packer),
+                                StateIDSemanticEqual(state_data_pool,
+                                                     state_packer.get_num_bins())),
+      packing_buffer(state_packer.get_num_bins()) {
+}
+
+StateRegistry::~StateRegistry() {
+}
+
+StateID StateRegistry::insert_id_or_pop_state(size_t hash) {
+    /*
+      Attempt to insert a StateID for the last state of state_data_pool
+      if none is present yet. If this fails (another entry for this state
+      is present), we have to remove the duplicate entry from the
+      state data pool.
+    */
+    StateID id(state_data_pool.size() - 1);
+    if (hash_table_type == CHAINED_STATE_HASH_TABLE) {
+        pair<StateIDSet::iterator, bool> result =
+            chained_registered_states.insert(id);
+        bool is_new_entry = result.second;
+        if (!is_new_entry)
+            state_data_pool.pop_back();
+        assert(chained_registered_states.size() == state_data_pool.size());
+        return *result.first;
+    }
+    pair<StateID, bool> result = registered_states.insert(id, hash);
+    bool is_new_entry = result.second;
+    if (!is_new_entry)
+        state_data_pool.pop_back();
+    assert(registered_states.size() == state_data_pool.size());
+    return result.first;
+}
+
+StateID StateRegistry::insert_state(const State &state) {
+    PackedStateBin *buffer = &packing_buffer[0];
+    int num_vars = g_variable_domain.size();
+    for (int var = 0; var < num_vars; ++var)
+        state_packer.set(buffer, var, state[var]);
+    state_data_pool.push_back(buffer);
+    return insert_id_or_pop_state(state.hash());
+}
+
+StateID StateRegistry::get_id(const State &state) {
+    if (state.id != StateID::no_state)
+        return state.id;
+    return insert_state(state);
+}
+
+void StateRegistry::register_state(State &state) {
+    state.id = get_id(state);
+}
+
+State StateRegistry::get_successor_state(const State &predecessor,
+                                         const Operator &op) {
+    State successor(predecessor, op);
+    register_state(successor);
+    return successor;
+}
+
+State StateRegistry::import_state(const State &state) {
+    State result(state);
+    result.id = insert_state(state);
+    return result;
+}
+
+State StateRegistry::lookup_state(StateID id) const {
+    const PackedStateBin *buffer = state_data_pool[id.value];
+    State state;
+    size_t hash = 0;
+    int num_vars = g_variable_domain.size();
+    for (int var = 0; var < num_vars; ++var) {
+        int value = state_packer.get(buffer, var);
+        state.vars[var] = value;
+        hash ^= State::get_zobrist_key(var, value);
+    }
+    state.id = id;
+    state.hash_value = hash;
+    state.hash_valid = true;
+    return state;
+}
+
+void StateRegistry::statistics() const {
+    cout << "Registered states: " << state_data_pool.size() << endl;
+    cout << "Bytes per registered state: "
+         << state_packer.get_num_bins() * sizeof(PackedStateBin) << endl;
+    cout << "State registry memory: "
+         << state_data_pool.get_memory_in_bytes() / 1024 << " KB" << endl;
+    if (hash_table_type == CHAINED_STATE_HASH_TABLE) {
+        cout << "State hash table: chained ("
+             << chained_registered_states.bucket_count() << " buckets)"
+             << endl;
+    } else {
+        cout << "State hash table: open addressing ("
+             << registered_states.capacity() << " slots, "
+             << registered_states.get_memory_in_bytes() / 1024 << " KB)"
+             << endl;
+    }
+}
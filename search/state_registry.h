@@ -0,0 +1,154 @@
+#ifndef STATE_REGISTRY_H
+#define STATE_REGISTRY_H
+
+#include "globals.h"
+#include "int_packer.h"
+#include "open_addressing_hash_set.h"
+#include "segmented_vector.h"
+#include "state_id.h"
+
+#include <ext/hash_set>
+
+class Operator;
+class State;
+
+/*
+  Overview of classes relevant to storing and working with registered states.
+
+  State
+    This class is used for manipulating states. It contains the (unpacked)
+    values of all state variables and is used for successor generation,
+    goal tests and heuristic evaluation. States are comparatively large,
+    so we never keep more than a few of them around at the same time.
+
+  StateID
+    A StateID is a 32-bit handle to a state that has been registered in
+    the StateRegistry. Everything that needs to refer to a state for a
+    long time (search nodes, open list entries, parent pointers) uses
+    StateIDs instead of States.
+
+  StateRegistry
+    The StateRegistry stores all states that have been registered so far.
+    Each state is stored bit-packed (see IntPacker) as a slice of one big
+    segmented pool, using ceil(log2(domain size)) bits per variable.
+    Registering a state returns its StateID; a State can be reconstructed
+    from a StateID by looking it up in the registry. Registration uses
+    the incrementally maintained hash value of the State (see
+    State::hash()), so registering a successor does not rehash all
+    variables. IDs are assigned
+    densely in registration order, so information about registered states
+    can be kept in vectors indexed by StateID (see PerStateInformation).
+
+    The registry uses a hash set of StateIDs for duplicate detection.
+    Hashing and comparing StateIDs is done on the packed data they refer
+    to, so only one copy of each state's data exists. By default, this
+    is an open addressing table that stores a fingerprint of each
+    state's hash value next to its ID (see OpenAddressingHashSet); the
+    chained __gnu_cxx::hash_set used previously can still be selected
+    with "--state-hash-table chained" for comparison.
+*/
+
+typedef IntPacker::Bin PackedStateBin;
+
+class StateRegistry {
+    /*
+      Computes the Zobrist hash of a registered state from its packed
+      data, i.e., the same value State::hash() has for the unpacked
+      state. Only needed when the hash value of the state is not at
+      hand, e.g. when the chained hash table rehashes.
+    */
+    struct StateIDSemanticHash {
+        const SegmentedArrayVector<PackedStateBin> &state_data_pool;
+        const IntPacker &state_packer;
+        StateIDSemanticHash(const SegmentedArrayVector<PackedStateBin> &state_data_pool_,
+                            const IntPacker &state_packer_)
+            : state_data_pool(state_data_pool_), state_packer(state_packer_) {
+        }
+
+        size_t operator()(StateID id) const;
+    };
+
+    struct StateIDSemanticEqual {
+        const SegmentedArrayVector<PackedStateBin> &state_data_pool;
+        int state_size;
+        StateIDSemanticEqual(const SegmentedArrayVector<PackedStateBin> &state_data_pool_,
+                             int state_size_)
+            : state_data_pool(state_data_pool_), state_size(state_size_) {
+        }
+
+        bool operator()(StateID lhs, StateID rhs) const;
+    };
+
+    typedef __gnu_cxx::hash_set<StateID, StateIDSemanticHash,
+                                StateIDSemanticEqual> StateIDSet;
+    typedef OpenAddressingHashSet<StateID, StateIDSemanticHash,
+                                  StateIDSemanticEqual> OpenStateIDSet;
+
+    IntPacker state_packer;
+    SegmentedArrayVector<PackedStateBin> state_data_pool;
+    StateHashTableType hash_table_type;
+    // Only the table selected by hash_table_type is used.
+    OpenStateIDSet registered_states;
+    StateIDSet chained_registered_states;
+    std::vector<PackedStateBin> packing_buffer;
+
+    StateID insert_id_or_pop_state(size_t hash);
+    // Registers the state data regardless of the ID the state carries.
+    StateID insert_state(const State &state);
+public:
+    explicit StateRegistry(StateHashTableType hash_table_type_);
+    ~StateRegistry();
+
+    /*
+      Returns the ID of the given state, registering it first if it
+      has not been seen before. States that already carry an ID (all
+      states returned by the registry) are answered without hashing.
+    */
+    StateID get_id(const State &state);
+
+    /*
+      Registers the given state if necessary and stores its ID in it.
+    */
+    void register_state(State &state);
+
+    /*
+      Returns the registered successor of predecessor under op. This is
+      the preferred way for search algorithms to generate successors,
+      since the returned state carries its ID and hence all later
+      lookups of per-state information are plain vector accesses.
+    */
+    State get_successor_state(const State &predecessor, const Operator &op);
+
+    /*
+      Registers a copy of the given state, ignoring any ID that it may
+      carry from another registry, and returns it with its ID in this
+      registry. This is how states move between the registries of the
+      threads of a parallel search.
+    */
+    State import_state(const State &state);
+
+    /*
+      Returns the registered state with the given ID. The returned State
+      owns an unpacked copy of the state data and knows its hash value,
+      so that its successors can be hashed incrementally.
+    */
+    State lookup_state(StateID id) const;
+
+    int size() const {
+        return state_data_pool.size();
+    }
+
+    // The registered states have the IDs 0, ..., size() - 1.
+    StateID get_id_for_index(int index) const {
+        assert(index >= 0 && index < size());
+        return StateID(index);
+    }
+
+    int get_bins_per_state() const {
+        return state_packer.get_num_bins();
+    }
+
+    void statistics() const;
+};
+
+#endif
@@ -1,16 +1,10 @@
 #ifndef STATE_VAR_T_H
 #define STATE_VAR_T_H
 
-#if STATE_VAR_BYTES == 1
-typedef unsigned char state_var_t;
-
-#elif STATE_VAR_BYTES == 2
-typedef unsigned short state_var_t;
-
-#elif STATE_VAR_BYTES == 4
+// Unpacked value of a single state variable. States are only kept
+// unpacked while they are being worked on; the StateRegistry stores
+// registered states bit-packed (see state_registry.h), so there is no
+// need to squeeze this type depending on the domain sizes of a task.
 typedef int state_var_t;
 
 #endif
-
-
-#endif
@@ -9,88 +9,146 @@
 #include <vector>
 using namespace std;
 
-class SuccessorGeneratorSwitch : public SuccessorGenerator {
-    int switch_var;
-    SuccessorGenerator *immediate_ops;
-    vector<SuccessorGenerator *> generator_for_value;
-    SuccessorGenerator *default_generator;
-public:
-    SuccessorGeneratorSwitch(istream &in, int ops);
-    virtual void generate_applicable_ops(const State &curr,
-                                         vector<const Operator *> &ops);
-    virtual void _dump(string indent);
-};
-
-class SuccessorGeneratorGenerate : public SuccessorGenerator {
-    vector<const Operator *> op;
-public:
-    SuccessorGeneratorGenerate(istream &in, int ops);
-    virtual void generate_applicable_ops(const State &curr,
-                                         vector<const Operator *> &ops);
-    virtual void _dump(string indent);
-};
-
-SuccessorGeneratorSwitch::SuccessorGeneratorSwitch(istream &in, int ops) {
-    in >> switch_var;
-    immediate_ops = read_successor_generator(in, ops);
-    for (int i = 0; i < g_variable_domain[switch_var]; i++)
-        generator_for_value.push_back(read_successor_generator(in, ops));
-    default_generator = read_successor_generator(in, ops);
-}
-
-void SuccessorGeneratorSwitch::generate_applicable_ops(
-    const State &curr, vector<const Operator *> &ops) {   
-	immediate_ops->generate_applicable_ops(curr, ops);
-    generator_for_value[curr[switch_var]]->generate_applicable_ops(curr, ops);
-    default_generator->generate_applicable_ops(curr, ops);
-}
-
-void SuccessorGeneratorSwitch::_dump(string indent) {
-    cout << indent << "switch on " << g_variable_name[switch_var] << endl;
-    cout << indent << "immediately:" << endl;
-    immediate_ops->_dump(indent + "  ");
-    for (int i = 0; i < g_variable_domain[switch_var]; i++) {
-        cout << indent << "case " << i << ":" << endl;
-        generator_for_value[i]->_dump(indent + "  ");
+static void expect_generator_type(istream &in, const string &expected) {
+    string type;
+    in >> type;
+    if (type != expected) {
+        cout << "Illegal successor generator statement!" << endl;
+        cout << "Expected '" << expected << "', got '" << type << "'." << endl;
+        exit_with(EXIT_INPUT_ERROR);
     }
-    cout << indent << "always:" << endl;
-    default_generator->_dump(indent + "  ");
 }
 
-void SuccessorGeneratorGenerate::generate_applicable_ops(const State &,
-                                                         vector<const Operator *> &ops) {
-    ops.insert(ops.end(), op.begin(), op.end());
+SuccessorGenerator::SuccessorGenerator(istream &in, int ops)
+    : root(NO_NODE) {
+    root = read_node(in, ops, 1);
 }
 
-SuccessorGeneratorGenerate::SuccessorGeneratorGenerate(istream &in, int ops) {
+void SuccessorGenerator::read_operators(istream &in, int ops) {
+    // Reads the body of a "check" statement into operators.
     int count;
     in >> count;
     for (int i = 0; i < count; i++) {
         int op_index;
         in >> op_index;
-	if (ops == 0)
-		op.push_back(&g_operators[op_index]);
-	else
-		op.push_back(&g_abstract_operators[op_index]);
+        if (ops == 0)
+            operators.push_back(&g_operators[op_index]);
+        else
+            operators.push_back(&g_abstract_operators[op_index]);
     }
 }
 
-void SuccessorGeneratorGenerate::_dump(string indent) {
-    for (int i = 0; i < op.size(); i++) {
-        cout << indent;
-        op[i]->dump();
-    }
-}
+int SuccessorGenerator::read_node(istream &in, int ops, int depth) {
+    // Returns the index of the new node, or NO_NODE if it has no operators.
+    if (pending.size() < depth)
+        pending.resize(depth);
 
-SuccessorGenerator *read_successor_generator(istream &in, int ops) {
     string type;
     in >> type;
-    if (type == "switch") {
-        return new SuccessorGeneratorSwitch(in, ops);
-    } else if (type == "check") {
-        return new SuccessorGeneratorGenerate(in, ops);
+    int node_id = nodes.size();
+    nodes.push_back(Node());
+    // Careful: nodes may be reallocated by the recursive calls below.
+    nodes[node_id].ops_begin = operators.size();
+    if (type == "check") {
+        read_operators(in, ops);
+        nodes[node_id].var = LEAF;
+        nodes[node_id].ops_end = operators.size();
+        nodes[node_id].children_begin = 0;
+        nodes[node_id].default_child = NO_NODE;
+        if (nodes[node_id].ops_begin == nodes[node_id].ops_end) {
+            nodes.pop_back();
+            return NO_NODE;
+        }
+        return node_id;
+    } else if (type == "switch") {
+        int switch_var;
+        in >> switch_var;
+        // The preprocessor always writes the immediate operators as "check".
+        expect_generator_type(in, "check");
+        read_operators(in, ops);
+        nodes[node_id].var = switch_var;
+        nodes[node_id].ops_end = operators.size();
+        int children_begin = children.size();
+        nodes[node_id].children_begin = children_begin;
+        children.resize(children_begin + g_variable_domain[switch_var]);
+        for (int i = 0; i < g_variable_domain[switch_var]; i++) {
+            int child = read_node(in, ops, depth + 1);
+            children[children_begin + i] = child;
+        }
+        int default_child = read_node(in, ops, depth + 1);
+        nodes[node_id].default_child = default_child;
+        return node_id;
     }
     cout << "Illegal successor generator statement!" << endl;
     cout << "Expected 'switch' or 'check', got '" << type << "'." << endl;
     exit_with(EXIT_INPUT_ERROR);
 }
+
+void SuccessorGenerator::generate_applicable_ops(
+    const State &curr, vector<const Operator *> &ops) {
+    generate_applicable_ops(curr, ops, &pending[0]);
+}
+
+void SuccessorGenerator::generate_applicable_ops(
+    const State &curr, vector<const Operator *> &ops,
+    vector<int> &scratch) const {
+    if (root == NO_NODE)
+        return;
+    if (scratch.size() < pending.size())
+        scratch.resize(pending.size());
+    generate_applicable_ops(curr, ops, &scratch[0]);
+}
+
+void SuccessorGenerator::generate_applicable_ops(
+    const State &curr, vector<const Operator *> &ops,
+    int *pending_nodes) const {
+    if (root == NO_NODE)
+        return;
+    int num_pending = 0;
+    int node_id = root;
+    while (true) {
+        const Node &node = nodes[node_id];
+        ops.insert(ops.end(), operators.begin() + node.ops_begin,
+                   operators.begin() + node.ops_end);
+        int next = NO_NODE;
+        if (node.var != LEAF) {
+            // Visit the value child first, then the default child.
+            if (node.default_child != NO_NODE)
+                pending_nodes[num_pending++] = node.default_child;
+            next = children[node.children_begin + curr[node.var]];
+        }
+        if (next == NO_NODE) {
+            if (num_pending == 0)
+                break;
+            next = pending_nodes[--num_pending];
+        }
+        node_id = next;
+    }
+}
+
+void SuccessorGenerator::dump_node(int node_id, string indent) const {
+    if (node_id == NO_NODE)
+        return;
+    const Node &node = nodes[node_id];
+    if (node.var != LEAF) {
+        cout << indent << "switch on " << g_variable_name[node.var] << endl;
+        cout << indent << "immediately:" << endl;
+    }
+    string op_indent = node.var == LEAF ? indent : indent + "  ";
+    for (int i = node.ops_begin; i < node.ops_end; i++) {
+        cout << op_indent;
+        operators[i]->dump();
+    }
+    if (node.var != LEAF) {
+        for (int i = 0; i < g_variable_domain[node.var]; i++) {
+            cout << indent << "case " << i << ":" << endl;
+            dump_node(children[node.children_begin + i], indent + "  ");
+        }
+        cout << indent << "always:" << endl;
+        dump_node(node.default_child, indent + "  ");
+    }
+}
+
+SuccessorGenerator *read_successor_generator(istream &in, int ops) {
+    return new SuccessorGenerator(in, ops);
+}
@@ -2,18 +2,66 @@
 #define SUCCESSOR_GENERATOR_H
 
 #include <iostream>
+#include <string>
 #include <vector>
 
 class Operator;
 class State;
 
+/*
+  The successor generator is a decision tree over the state variables
+  (see the preprocessor). Instead of a tree of heap-allocated nodes
+  with virtual calls, we compile it into flat arrays when reading it:
+
+  - nodes holds all switch and leaf nodes in preorder. Each node owns
+    the contiguous range [ops_begin, ops_end) of operators, which are
+    its immediate operators (switch nodes) or its operators (leaves).
+  - children holds the value-indexed jump table of each switch node:
+    the child for value v of node n is children[n.children_begin + v].
+    Children that would generate no operators are stored as NO_NODE,
+    so they cost nothing during traversal.
+
+  generate_applicable_ops then is a loop over this structure that
+  appends operators in the same order as the original recursive
+  traversal (immediate operators, value child, default child).
+*/
+
 class SuccessorGenerator {
+    static const int NO_NODE = -1;
+    static const int LEAF = -1;
+
+    struct Node {
+        int var; // LEAF for leaf nodes
+        int ops_begin;
+        int ops_end;
+        int children_begin;
+        int default_child;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> children;
+    std::vector<const Operator *> operators;
+    int root;
+    // Default children still to be visited; sized to the tree depth.
+    std::vector<int> pending;
+
+    int read_node(std::istream &in, int ops, int depth);
+    void generate_applicable_ops(const State &curr,
+                                 std::vector<const Operator *> &ops,
+                                 int *pending_nodes) const;
+    void read_operators(std::istream &in, int ops);
+    void dump_node(int node_id, std::string indent) const;
 public:
-    virtual ~SuccessorGenerator() {}
-    virtual void generate_applicable_ops(const State &curr,
-                                         std::vector<const Operator *> &ops) = 0;
-    void dump() {_dump("  "); }
-    virtual void _dump(string indent) = 0;
+    SuccessorGenerator(std::istream &in, int ops);
+
+    void generate_applicable_ops(const State &curr,
+                                 std::vector<const Operator *> &ops);
+    // Same, but uses the given scratch space instead of the generator's
+    // own, so that several threads can generate successors at once.
+    void generate_applicable_ops(const State &curr,
+                                 std::vector<const Operator *> &ops,
+                                 std::vector<int> &scratch) const;
+    void dump() const {dump_node(root, "  "); }
 };
 
 SuccessorGenerator *read_successor_generator(std::istream &in, int ops);
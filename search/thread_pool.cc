@@ -0,0 +1,88 @@
+#include "thread_pool.h"
+
+#include "utilities.h"
+
+#include <cassert>
+#include <iostream>
+using namespace std;
+
+ThreadPool::ThreadPool(int num_threads)
+    : job(0), job_number(0), num_busy_workers(0), shutting_down(false) {
+    assert(num_threads >= 1);
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&job_available, 0);
+    pthread_cond_init(&job_finished, 0);
+
+    // The workers must not move once their threads are started.
+    workers.resize(num_threads - 1);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].pool = this;
+        workers[i].index = i + 1;
+        if (pthread_create(&workers[i].thread, 0, worker_main, &workers[i])) {
+            cout << "Could not start thread " << i + 1 << endl;
+            exit_with(EXIT_CRITICAL_ERROR);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    pthread_mutex_lock(&mutex);
+    shutting_down = true;
+    pthread_cond_broadcast(&job_available);
+    pthread_mutex_unlock(&mutex);
+    for (size_t i = 0; i < workers.size(); ++i)
+        pthread_join(workers[i].thread, 0);
+    pthread_cond_destroy(&job_finished);
+    pthread_cond_destroy(&job_available);
+    pthread_mutex_destroy(&mutex);
+}
+
+void *ThreadPool::worker_main(void *worker) {
+    Worker *self = static_cast<Worker *>(worker);
+    self->pool->work(self->index);
+    return 0;
+}
+
+void ThreadPool::work(int index) {
+    int last_job_number = 0;
+    pthread_mutex_lock(&mutex);
+    while (true) {
+        while (job_number == last_job_number && !shutting_down)
+            pthread_cond_wait(&job_available, &mutex);
+        if (shutting_down)
+            break;
+        last_job_number = job_number;
+        Job *current_job = job;
+        pthread_mutex_unlock(&mutex);
+
+        current_job->run(index);
+
+        pthread_mutex_lock(&mutex);
+        if (--num_busy_workers == 0)
+            pthread_cond_signal(&job_finished);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ThreadPool::run(Job &the_job) {
+    if (workers.empty()) {
+        the_job.run(0);
+        return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    assert(num_busy_workers == 0);
+    job = &the_job;
+    num_busy_workers = workers.size();
+    ++job_number;
+    pthread_cond_broadcast(&job_available);
+    pthread_mutex_unlock(&mutex);
+
+    the_job.run(0);
+
+    pthread_mutex_lock(&mutex);
+    while (num_busy_workers != 0)
+        pthread_cond_wait(&job_finished, &mutex);
+    job = 0;
+    pthread_mutex_unlock(&mutex);
+}
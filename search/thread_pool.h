@@ -0,0 +1,53 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <vector>
+
+/*
+  A fixed set of threads that run the same job in parallel, each with
+  its own thread index (typically used to work on one part of a batch).
+  The thread calling run() takes part as thread 0, so a pool for n
+  threads starts n - 1 worker threads, which sleep between jobs.
+  run() returns once all threads have finished the job.
+*/
+class ThreadPool {
+public:
+    class Job {
+    public:
+        virtual ~Job() {}
+        virtual void run(int thread_index) = 0;
+    };
+private:
+    struct Worker {
+        ThreadPool *pool;
+        int index;
+        pthread_t thread;
+    };
+
+    std::vector<Worker> workers;
+    pthread_mutex_t mutex;
+    pthread_cond_t job_available;
+    pthread_cond_t job_finished;
+    Job *job;
+    int job_number; // increased for every job to wake up the workers
+    int num_busy_workers;
+    bool shutting_down;
+
+    static void *worker_main(void *worker);
+    void work(int index);
+
+    // not implemented
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+public:
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    int get_num_threads() const {
+        return workers.size() + 1;
+    }
+    void run(Job &job);
+};
+
+#endif